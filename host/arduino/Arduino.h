@@ -0,0 +1,195 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+/*
+ * File: Arduino.h (host)
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Minimal host-side replacement of the Teensy Arduino core, used to compile the PRB firmware
+ *  sources (PRBComputer, PTE7300_I2C) for the native PlatformIO environments. It provides:
+ *    - A virtual clock driving millis()/micros()/delay() (delay() advances virtual time)
+ *    - A pin table for digitalWrite()/digitalRead()/analogRead(), with a hook on pin writes
+ *    - The Teensy 4.1 GPIO port layout behind portSetRegister()/portClearRegister()/
+ *      digitalPinToBitMask(): a set or clear write switches every pin of the mask at the same
+ *      virtual time
+ *    - A Serial object printing to a configurable sink (discarded by default)
+ *    - noInterrupts()/interrupts() bookkeeping of the time spent with interrupts masked
+ *    - An optional interrupt source: a hook run when the virtual clock reaches its due time,
+ *      held back while interrupts are masked, its handlers taking time from the foreground
+ *    - __WFI(): the clock runs to the next SysTick (1 ms) or interrupt source due time
+ *
+ *  Only what the firmware actually uses is implemented. The host tools drive the clock and
+ *  inputs through the functions declared in the host namespace.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+typedef uint8_t byte;
+
+#define HIGH        1
+#define LOW         0
+#define INPUT       0
+#define OUTPUT      1
+
+#define DEC         10
+#define HEX         16
+
+// Teensy 4.1 pin numbers
+#define LED_BUILTIN 13
+#define PIN_A0      14
+#define PIN_A1      15
+#define PIN_A2      16
+#define PIN_A3      17
+#define PIN_A4      18
+#define PIN_A5      19
+#define PIN_A6      20
+#define PIN_A7      21
+#define PIN_A8      22
+#define PIN_A9      23
+#define PIN_A10     24
+#define PIN_A11     25
+#define PIN_A12     26
+#define PIN_A13     27
+
+#define HOST_NUM_PINS 64
+
+// Teensy 4.x memory placement attributes, meaningless on the host
+#define FASTRUN
+#define FLASHMEM
+#define DMAMEM
+inline void arm_dcache_flush(void *, uint32_t) {}
+
+// cycle counter, derived from the virtual clock at the Teensy 4.1 core clock
+#define F_CPU_ACTUAL    600000000
+#define ARM_DWT_CYCCNT  (host::cycle_count())
+
+// sleep until the next interrupt
+#define __WFI()         (host::wait_for_interrupt())
+
+// System Reset Controller reset status: sticky cause bits, write 1 to clear (host::set_reset_cause())
+#define SRC_SRSR                        (host::reset_status)
+#define SRC_SRSR_IPP_RESET_B            ((uint32_t)(1 << 0))    // power-on, brownout or POR_B pin
+#define SRC_SRSR_LOCKUP_SYSRESETREQ     ((uint32_t)(1 << 1))    // SCB_AIRCR SYSRESETREQ or core lockup
+#define SRC_SRSR_CSU_RESET_B            ((uint32_t)(1 << 2))
+#define SRC_SRSR_IPP_USER_RESET_B       ((uint32_t)(1 << 3))
+#define SRC_SRSR_WDOG_RST_B             ((uint32_t)(1 << 4))    // WDOG1 / WDOG2
+#define SRC_SRSR_JTAG_RST_B             ((uint32_t)(1 << 5))
+#define SRC_SRSR_JTAG_SW_RST            ((uint32_t)(1 << 6))
+#define SRC_SRSR_WDOG3_RST_B            ((uint32_t)(1 << 7))
+#define SRC_SRSR_TEMPSENSE_RST_B        ((uint32_t)(1 << 8))
+
+// ================= core functions =================
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int  digitalRead(uint8_t pin);
+int  analogRead(uint8_t pin);
+void analogReadResolution(unsigned int bits);
+
+void tone(uint8_t pin, uint16_t frequency, uint32_t duration = 0);
+void noTone(uint8_t pin);
+
+void noInterrupts();
+void interrupts();
+
+// GPIO port registers: *portSetRegister(pin) = bits drives the pins of bits on that port HIGH,
+// *portClearRegister(pin) = bits drives them LOW
+#define portSetRegister(pin)        (host::port_set_register(pin))
+#define portClearRegister(pin)      (host::port_clear_register(pin))
+#define digitalPinToBitMask(pin)    (host::pin_bit_mask(pin))
+
+// ================= Serial =================
+class HostSerial
+{
+public:
+    void begin(unsigned long baud);
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    int availableForWrite();
+
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(T value, int fmt) { size_t n = print(value, fmt); return n + println(); }
+};
+
+extern HostSerial Serial;
+
+// ================= host control =================
+namespace host
+{
+    typedef void (*pin_write_hook_t)(uint8_t pin, uint8_t level, uint64_t time_us);
+
+    typedef struct gpio_register_t
+    {
+        uint8_t port;
+        uint8_t level;              // level written to the pins of the mask (DR_SET: HIGH, DR_CLEAR: LOW)
+        void operator=(uint32_t bits);
+    }gpio_register_t;
+
+    gpio_register_t *port_set_register(uint8_t pin);
+    gpio_register_t *port_clear_register(uint8_t pin);
+    uint32_t pin_bit_mask(uint8_t pin);
+
+    typedef struct reset_status_register_t
+    {
+        uint32_t bits;
+        operator uint32_t() const { return bits; }
+        void operator=(uint32_t clear) { bits &= ~clear; }
+    }reset_status_register_t;
+
+    // SRC_SRSR, SRC_SRSR_IPP_RESET_B (power-on) after reset()
+    extern reset_status_register_t reset_status;
+    void set_reset_cause(uint32_t bits);
+
+    // virtual clock
+    uint64_t time_us();
+    void set_time_us(uint64_t time_us);
+    void advance_us(uint64_t delta_us);
+    uint32_t cycle_count();
+    void wait_for_interrupt();
+
+    // pins
+    void set_pin_write_hook(pin_write_hook_t hook);
+    int  pin_level(uint8_t pin);
+    uint32_t pin_edge_count(uint8_t pin);     // level changes since reset()
+    void set_analog(uint8_t pin, int value);
+
+    // Serial sink (nullptr discards output)
+    void set_serial_sink(FILE *sink);
+
+    // Interrupt source: hook(now) runs the handlers due at now and returns the next due time
+    // (UINT64_MAX for none). It runs from advance_us() / delay() when the clock reaches the due
+    // time, or from interrupts() if it came due while masked; the virtual time the handlers
+    // take (advance_us() inside the hook) is added to the foreground delay. No nesting.
+    typedef uint64_t (*irq_hook_t)(uint64_t now_us);
+    void set_irq_hook(irq_hook_t hook, uint64_t due_us);
+
+    // virtual time spent between noInterrupts() and interrupts(): longest section and total
+    uint64_t irq_masked_max_us();
+    uint64_t irq_masked_total_us();
+
+    // reset clock, pins, hooks (interrupt source included) and interrupt statistics between runs,
+    // power-on reset cause
+    void reset();
+}
+
+#endif // HOST_ARDUINO_H
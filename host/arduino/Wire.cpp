@@ -0,0 +1,97 @@
+/*
+ * File: Wire.cpp (host)
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the host TwoWire replacement declared in Wire.h (host).
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
+TwoWire Wire1;
+TwoWire Wire2;
+
+TwoWire::TwoWire()
+{
+    bus = nullptr;
+    tx_address = 0;
+    tx_length = 0;
+    rx_length = 0;
+    rx_index = 0;
+    receive_handler = nullptr;
+    request_handler = nullptr;
+}
+
+void TwoWire::begin() {}
+void TwoWire::begin(uint8_t) {}
+void TwoWire::setClock(uint32_t frequency)
+{
+    if (bus) bus->set_clock(frequency);
+}
+
+void TwoWire::beginTransmission(int address)
+{
+    tx_address = (uint8_t)address;
+    tx_length = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (tx_length >= BUFFER_LENGTH) return 0;
+    tx_buffer[tx_length++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+    size_t written = 0;
+    while (written < length && write(data[written])) written++;
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    uint8_t status = bus ? bus->master_write(tx_address, tx_buffer, tx_length, sendStop) : 2;
+    tx_length = 0;
+    return status;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity, int sendStop)
+{
+    if (quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+    if (quantity < 0) quantity = 0;
+    rx_index = 0;
+    rx_length = bus ? bus->master_read((uint8_t)address, rx_buffer, (size_t)quantity, sendStop != 0) : 0;
+    return (uint8_t)rx_length;
+}
+
+int TwoWire::available() { return (int)(rx_length - rx_index); }
+int TwoWire::read() { return rx_index < rx_length ? rx_buffer[rx_index++] : -1; }
+int TwoWire::peek() { return rx_index < rx_length ? rx_buffer[rx_index] : -1; }
+void TwoWire::flush() {}
+
+void TwoWire::onReceive(void (*function)(int)) { receive_handler = function; }
+void TwoWire::onRequest(void (*function)()) { request_handler = function; }
+
+void TwoWire::attach(HostI2CBus *bus_) { bus = bus_; }
+
+void TwoWire::slave_receive(const uint8_t *data, size_t length)
+{
+    if (length > BUFFER_LENGTH) length = BUFFER_LENGTH;
+    memcpy(rx_buffer, data, length);
+    rx_length = length;
+    rx_index = 0;
+    if (receive_handler) receive_handler((int)length);
+}
+
+size_t TwoWire::slave_request(uint8_t *data, size_t length)
+{
+    tx_length = 0;
+    if (request_handler) request_handler();
+    size_t supplied = tx_length < length ? tx_length : length;
+    memcpy(data, tx_buffer, supplied);
+    tx_length = 0;
+    return supplied;
+}
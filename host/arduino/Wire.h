@@ -0,0 +1,89 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+/*
+ * File: Wire.h (host)
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Host-side replacement of the Teensy TwoWire class. Master transactions are forwarded to a
+ *  HostI2CBus attached by the host tool (see host/sim/I2CSim.h); with no bus attached every
+ *  address is NACKed, as on a disconnected bus.
+ *
+ *  As a slave (Wire1), the host tool plays the master: slave_receive() and slave_request() run
+ *  the onReceive / onRequest handlers the way the Teensy slave interrupt does.
+ */
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 136
+
+/**
+ * @brief Interface of a simulated I2C bus, seen from the master.
+ *
+ * Each call is one complete addressed transfer (START, address, payload, optional STOP).
+ */
+class HostI2CBus
+{
+public:
+    virtual ~HostI2CBus() {}
+
+    // returns the Wire status code: 0 ok, 2 address NACK, 3 data NACK, 4 other error
+    virtual uint8_t master_write(uint8_t address, const uint8_t *data, size_t length, bool stop) = 0;
+
+    // returns the number of bytes supplied by the target (0 on address NACK)
+    virtual size_t master_read(uint8_t address, uint8_t *data, size_t length, bool stop) = 0;
+
+    // forwarded from TwoWire::setClock() [Hz]
+    virtual void set_clock(uint32_t) {}
+};
+
+class TwoWire
+{
+public:
+    TwoWire();
+
+    void begin();
+    void begin(uint8_t address);
+    void setClock(uint32_t frequency);
+
+    void beginTransmission(int address);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t length);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(int address, int quantity, int sendStop = 1);
+    int available();
+    int read();
+    int peek();
+    void flush();
+
+    void onReceive(void (*function)(int));
+    void onRequest(void (*function)());
+
+    // host only
+    void attach(HostI2CBus *bus);
+
+    // host only, slave side: master write of length bytes then STOP, runs the onReceive handler
+    void slave_receive(const uint8_t *data, size_t length);
+    // host only, slave side: master read of up to length bytes, runs the onRequest handler and
+    // returns the number of bytes it wrote
+    size_t slave_request(uint8_t *data, size_t length);
+
+private:
+    HostI2CBus *bus;
+    uint8_t tx_address;
+    uint8_t tx_buffer[BUFFER_LENGTH];
+    size_t tx_length;
+    uint8_t rx_buffer[BUFFER_LENGTH];
+    size_t rx_length;
+    size_t rx_index;
+    void (*receive_handler)(int);
+    void (*request_handler)();
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+extern TwoWire Wire2;
+
+#endif // HOST_WIRE_H
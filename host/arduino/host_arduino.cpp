@@ -0,0 +1,230 @@
+/*
+ * File: host_arduino.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the host Arduino core replacement declared in Arduino.h (host).
+ *  All time is virtual: nothing here sleeps, delay() simply moves the clock forward.
+ */
+
+#include "Arduino.h"
+
+HostSerial Serial;
+
+static uint64_t clock_us = 0;
+static uint8_t pin_levels[HOST_NUM_PINS];
+static int analog_values[HOST_NUM_PINS];
+static uint32_t pin_edges[HOST_NUM_PINS];
+static host::pin_write_hook_t pin_write_hook = nullptr;
+static FILE *serial_sink = nullptr;
+static bool irq_masked = false;
+static uint64_t irq_masked_since_us = 0;
+static uint64_t irq_masked_max = 0;
+static uint64_t irq_masked_total = 0;
+static host::irq_hook_t irq_hook = nullptr;
+static uint64_t irq_due_us = UINT64_MAX;
+static bool in_irq = false;
+
+// runs the interrupt source, the clock moves by the time its handlers take
+static void run_irq()
+{
+    in_irq = true;
+    irq_due_us = irq_hook(clock_us);
+    in_irq = false;
+}
+
+// ================= core functions =================
+uint32_t millis() { return (uint32_t)(clock_us / 1000); }
+uint32_t micros() { return (uint32_t)clock_us; }
+void delay(uint32_t ms) { host::advance_us((uint64_t)ms * 1000); }
+void delayMicroseconds(uint32_t us) { host::advance_us(us); }
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    if (pin >= HOST_NUM_PINS) return;
+    level = level ? HIGH : LOW;
+    if (pin_levels[pin] != level) pin_edges[pin]++;
+    pin_levels[pin] = level;
+    if (pin_write_hook) pin_write_hook(pin, level, clock_us);
+}
+
+int digitalRead(uint8_t pin) { return pin < HOST_NUM_PINS ? pin_levels[pin] : LOW; }
+int analogRead(uint8_t pin) { return pin < HOST_NUM_PINS ? analog_values[pin] : 0; }
+void analogReadResolution(unsigned int) {}
+
+void tone(uint8_t, uint16_t, uint32_t) {}
+void noTone(uint8_t) {}
+
+// ================= GPIO ports =================
+// Teensy 4.1 digital pins 0-41 on the fast GPIO ports 6-9 {port, bit}, the remaining host pins
+// get a port of their own
+static const uint8_t gpio_layout[42][2] = {
+    {6, 3},  {6, 2},  {9, 4},  {9, 5},  {9, 6},  {9, 8},  {7, 10}, {7, 17}, {7, 16}, {7, 11},
+    {7, 0},  {7, 2},  {7, 1},  {7, 3},  {6, 18}, {6, 19}, {6, 23}, {6, 22}, {6, 17}, {6, 16},
+    {6, 26}, {6, 27}, {6, 24}, {6, 25}, {6, 12}, {6, 13}, {6, 30}, {6, 31}, {8, 18}, {9, 31},
+    {8, 23}, {8, 22}, {7, 12}, {9, 7},  {7, 29}, {7, 28}, {7, 18}, {7, 19}, {6, 28}, {6, 29},
+    {6, 20}, {6, 21},
+};
+#define GPIO_OTHER_PORT 10
+
+static host::gpio_register_t gpio_set_registers[] = {{6, HIGH}, {7, HIGH}, {8, HIGH}, {9, HIGH}, {GPIO_OTHER_PORT, HIGH}};
+static host::gpio_register_t gpio_clear_registers[] = {{6, LOW}, {7, LOW}, {8, LOW}, {9, LOW}, {GPIO_OTHER_PORT, LOW}};
+
+static uint8_t gpio_port(uint8_t pin) { return pin < 42 ? gpio_layout[pin][0] : GPIO_OTHER_PORT; }
+static uint8_t gpio_bit(uint8_t pin) { return pin < 42 ? gpio_layout[pin][1] : pin - 42; }
+
+namespace host
+{
+    static int gpio_register_index(uint8_t pin)
+    {
+        uint8_t port = gpio_port(pin);
+        return port == GPIO_OTHER_PORT ? 4 : port - 6;
+    }
+
+    gpio_register_t *port_set_register(uint8_t pin) { return &gpio_set_registers[gpio_register_index(pin)]; }
+    gpio_register_t *port_clear_register(uint8_t pin) { return &gpio_clear_registers[gpio_register_index(pin)]; }
+
+    uint32_t pin_bit_mask(uint8_t pin) { return 1u << gpio_bit(pin); }
+
+    void gpio_register_t::operator=(uint32_t bits)
+    {
+        for (int pin = 0; pin < HOST_NUM_PINS; pin++) {
+            if (gpio_port(pin) == port && (bits & pin_bit_mask(pin))) digitalWrite(pin, level);
+        }
+    }
+
+    reset_status_register_t reset_status = {SRC_SRSR_IPP_RESET_B};
+
+    void set_reset_cause(uint32_t bits) { reset_status.bits = bits; }
+}
+
+// masking does not nest on Cortex-M (cpsid / cpsie), the first interrupts() unmasks
+void noInterrupts()
+{
+    if (irq_masked) return;
+    irq_masked = true;
+    irq_masked_since_us = clock_us;
+}
+
+void interrupts()
+{
+    if (!irq_masked) return;
+    irq_masked = false;
+    uint64_t masked = clock_us - irq_masked_since_us;
+    if (masked > irq_masked_max) irq_masked_max = masked;
+    irq_masked_total += masked;
+    if (irq_hook && !in_irq && irq_due_us <= clock_us) run_irq();     // came due while masked
+}
+
+// ================= Serial =================
+void HostSerial::begin(unsigned long) {}
+
+size_t HostSerial::write(uint8_t c)
+{
+    if (serial_sink) fputc(c, serial_sink);
+    return 1;
+}
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (serial_sink) fwrite(buffer, 1, size, serial_sink);
+    return size;
+}
+
+int HostSerial::availableForWrite() { return 4096; }
+
+size_t HostSerial::print(const char *s)
+{
+    if (serial_sink) fputs(s, serial_sink);
+    return strlen(s);
+}
+
+size_t HostSerial::print(char c) { return write((uint8_t)c); }
+
+size_t HostSerial::print(long n, int base)
+{
+    if (!serial_sink) return 0;
+    return (size_t)(base == HEX ? fprintf(serial_sink, "%lX", (unsigned long)n) : fprintf(serial_sink, "%ld", n));
+}
+
+size_t HostSerial::print(unsigned long n, int base)
+{
+    if (!serial_sink) return 0;
+    return (size_t)fprintf(serial_sink, base == HEX ? "%lX" : "%lu", n);
+}
+
+size_t HostSerial::print(int n, int base) { return print((long)n, base); }
+size_t HostSerial::print(unsigned int n, int base) { return print((unsigned long)n, base); }
+
+size_t HostSerial::print(double n, int digits)
+{
+    if (!serial_sink) return 0;
+    return (size_t)fprintf(serial_sink, "%.*f", digits, n);
+}
+
+size_t HostSerial::println() { return print("\r\n"); }
+
+// ================= host control =================
+namespace host
+{
+    uint64_t time_us() { return clock_us; }
+    void set_time_us(uint64_t time_us) { clock_us = time_us; }
+    void advance_us(uint64_t delta_us)
+    {
+        uint64_t target = clock_us + delta_us;
+        while (irq_hook && !irq_masked && !in_irq && irq_due_us <= target) {
+            if (irq_due_us > clock_us) clock_us = irq_due_us;
+            uint64_t start = clock_us;
+            run_irq();
+            target += clock_us - start;     // the handlers take time from the foreground
+        }
+        clock_us = target;
+    }
+
+    // the SysTick interrupt (millis()) fires every millisecond
+    void wait_for_interrupt()
+    {
+        uint64_t wake = (clock_us / 1000 + 1) * 1000;
+        if (irq_hook && !irq_masked && !in_irq && irq_due_us < wake) wake = irq_due_us > clock_us ? irq_due_us : clock_us;
+        advance_us(wake - clock_us);
+    }
+
+    void set_irq_hook(irq_hook_t hook, uint64_t due_us)
+    {
+        irq_hook = hook;
+        irq_due_us = hook ? due_us : UINT64_MAX;
+    }
+    uint32_t cycle_count() { return (uint32_t)(clock_us * (F_CPU_ACTUAL / 1000000)); }
+
+    void set_pin_write_hook(pin_write_hook_t hook) { pin_write_hook = hook; }
+    int pin_level(uint8_t pin) { return digitalRead(pin); }
+    uint32_t pin_edge_count(uint8_t pin) { return pin < HOST_NUM_PINS ? pin_edges[pin] : 0; }
+
+    void set_analog(uint8_t pin, int value)
+    {
+        if (pin < HOST_NUM_PINS) analog_values[pin] = value;
+    }
+
+    void set_serial_sink(FILE *sink) { serial_sink = sink; }
+
+    uint64_t irq_masked_max_us() { return irq_masked_max; }
+    uint64_t irq_masked_total_us() { return irq_masked_total; }
+
+    void reset()
+    {
+        clock_us = 0;
+        memset(pin_levels, 0, sizeof(pin_levels));
+        memset(analog_values, 0, sizeof(analog_values));
+        memset(pin_edges, 0, sizeof(pin_edges));
+        pin_write_hook = nullptr;
+        irq_hook = nullptr;
+        irq_due_us = UINT64_MAX;
+        irq_masked = false;
+        irq_masked_max = 0;
+        irq_masked_total = 0;
+        reset_status.bits = SRC_SRSR_IPP_RESET_B;
+    }
+}
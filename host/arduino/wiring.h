@@ -0,0 +1,14 @@
+#ifndef HOST_WIRING_H
+#define HOST_WIRING_H
+/*
+ * File: wiring.h (host)
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Host counterpart of the Teensy wiring.h included by main.cpp; everything lives in Arduino.h.
+ */
+
+#include "Arduino.h"
+
+#endif // HOST_WIRING_H
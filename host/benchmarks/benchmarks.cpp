@@ -0,0 +1,647 @@
+/*
+ * File: benchmarks.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Micro-benchmarks of the firmware compute kernels, run natively against the host Arduino
+ *  core. The iteration count of each benchmark is grown until one run lasts --min-time seconds,
+ *  then it is run --repetitions times and the fastest time per iteration is kept (the run least
+ *  disturbed by the rest of the machine, so the comparison against the baseline is stable):
+ *    - crc4 / crc8:          PTE7300_I2C CRC of a register read (header, stub + 2 words)
+ *    - sensata_pressure / sensata_temperature / pt1000_temperature / kulite_pressure:
+ *                            the SignalMath calibrations of the sensor table
+ *    - ccc_mean5:            BURN moving average of the CCC pressure
+ *    - impulse_step:         BURN chamber pressure integral step and total impulse
+ *    - estimator:            alpha-beta update + extrapolation (PressureEstimator)
+ *    - codec_encode / codec_decode: one SampleCodec record of the 7 channels (slow random walk)
+ *    - clock_sync:           one master time exchange (ClockSync update) and one time mapping
+ *    - journal_write:        one sequence transition written to the warm-restart journal
+ *    - warm_resume:          PRBComputer::resume() from the journal (read, stage and valve restore)
+ *    - net_select:           one Wire1 command byte alone (net_receive), cycling over the read
+ *                            commands: table lookup and staging of the response
+ *    - net_valves:           one VALVES_STATE write in IDLE through net_receive: lookup, state
+ *                            guard, handler and valve read-back staged
+ *    - update_burn_tick:     one PRBComputer::update() tick in BURN, simulated sensor bus,
+ *                            channels sampled on the BURN row of the sensor schedule
+ *    - update_sweep:         one update() tick that always reads every channel (CLEAR_TO_IGNITE
+ *                            schedule, every SAMPLE_ARMED_MS)
+ *
+ *  Results are written as Google Benchmark compatible JSON (--json FILE, one benchmark per line)
+ *  and compared against a stored run (--baseline FILE): a benchmark slower than the baseline by
+ *  more than --threshold percent is a regression and the exit code is 1. The baseline is only
+ *  meaningful on the machine that recorded it, regenerate it with --json after a toolchain or
+ *  machine change.
+ *
+ *  With traces on the command line, the SampleCodec compression is also reported on each of
+ *  them (one record per trace row): bytes per value against raw floats and against one
+ *  TLM_SAMPLE frame per value, decode throughput, and the worst quantisation error.
+ *
+ *  Usage: benchmarks [--filter TEXT] [--min-time S] [--repetitions N] [--json FILE]
+ *                    [--baseline FILE] [--threshold PCT] [trace...]
+ */
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "PRBComputer.h"
+#include "NetCommands.h"
+#include "sim/I2CSim.h"
+#include "common/prb_log.h"
+
+#define DEFAULT_MIN_TIME_S      0.2
+#define DEFAULT_REPETITIONS     5
+#define DEFAULT_THRESHOLD_PCT   10.0
+#define INPUTS                  1024        // varied inputs, so nothing is constant-folded
+#define BURN_PRESS_BAR          30.0f       // above RAMP_UP_CHECK_PRESSURE
+#define TLM_SAMPLE_FRAME        15          // TLM_SAMPLE: header, channel, float, CRC, COBS, delimiter
+#define TLM_FRAME_OVERHEAD      (TLM_HEADER_SIZE + TLM_CRC_SIZE + 2)
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+// keeps a value alive without a store the compiler can see through (as benchmark::DoNotOptimize)
+template <typename T>
+static inline void do_not_optimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Accumulates the timed part of a benchmark, set-up work is done while stopped.
+ */
+class BenchTimer
+{
+public:
+    void start() { started = bench_clock_t::now(); }
+    void stop() { elapsed += bench_clock_t::now() - started; }
+    double ns() const { return std::chrono::duration<double, std::nano>(elapsed).count(); }
+
+private:
+    bench_clock_t::time_point started;
+    bench_clock_t::duration elapsed = bench_clock_t::duration::zero();
+};
+
+// a benchmark runs iterations of its kernel and returns the timed nanoseconds
+typedef double (*bench_fn_t)(uint64_t iterations);
+
+typedef struct bench_t
+{
+    const char *name;
+    bench_fn_t run;
+}bench_t;
+
+typedef struct bench_result_t
+{
+    std::string name;
+    uint64_t iterations;
+    double ns_per_iteration;        // fastest of the repetitions
+}bench_result_t;
+
+// ================= kernels =================
+static int dsp_inputs[INPUTS];
+static int adc_inputs[INPUTS];
+static float press_inputs[INPUTS];
+static sample_record_t codec_records[INPUTS];
+
+static void make_inputs()
+{
+    uint32_t seed = 12345;
+    // slow random walk of every channel, 1 ms apart: pressures +-50 mbar, temperatures +-0.1 °C
+    float values[CODEC_CHANNELS] = {30.0f, 45.0f, 20.0f, 15.0f, -180.0f, 15.0f, 40.0f};
+    for (int i = 0; i < INPUTS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        dsp_inputs[i] = (int16_t)(seed >> 16) % 16000;
+        adc_inputs[i] = (int)((seed >> 8) % 4095);
+        press_inputs[i] = (float)((seed >> 12) % 4000) / 100.0f;
+
+        codec_records[i].t_us = 1000u * i;
+        codec_records[i].mask = (1 << CODEC_CHANNELS) - 1;
+        for (int c = 0; c < CODEC_CHANNELS; c++) {
+            float step = (c == TLM_CCC_PRESS || c == TLM_EIN_PRESS || c == TLM_OIN_PRESS) ? 0.05f : 0.1f;
+            values[c] += step * ((int)((seed >> (4 + 3 * c)) & 0xFF) - 128) / 128.0f;
+            codec_records[i].values[c] = values[c];
+        }
+    }
+}
+
+static double bench_crc4(uint64_t iterations)
+{
+    BenchTimer timer;
+    unsigned char header[2] = {0x30, 0x10};
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        header[0] = (unsigned char)i;
+        do_not_optimize(PTE7300_I2C::calc_crc4(0x03, 0x0F, header, 2));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_crc8(uint64_t iterations)
+{
+    BenchTimer timer;
+    unsigned char frame[7] = {0xDA, 0x30, 0x1A, 0x34, 0x12, 0x78, 0x56};
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        frame[3] = (unsigned char)i;
+        do_not_optimize(PTE7300_I2C::calc_crc8(0xD5, 0xFF, frame, sizeof(frame)));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+template <float (*convert)(int), const int *inputs>
+static double bench_conversion(uint64_t iterations)
+{
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        do_not_optimize(convert(inputs[i % INPUTS]));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_ccc_mean5(uint64_t iterations)
+{
+    float buffer[5] = {0};
+    int index = 0;
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        do_not_optimize(mean5_push(buffer, &index, press_inputs[i % INPUTS]));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_impulse_step(uint64_t iterations)
+{
+    float integral = 0.0f;
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        integral = chamber_integral_step(integral, press_inputs[i % INPUTS] * 1e5, 1);
+        do_not_optimize(engine_impulse(integral));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_estimator(uint64_t iterations)
+{
+    pressure_estimator_t estimator;
+    estimator_reset(&estimator);
+    uint32_t time_us = 0;
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        time_us += 1000;
+        if (i % (SAMPLE_ARMED_MS + 1) == 0) estimator_update(&estimator, press_inputs[i % INPUTS], time_us);
+        do_not_optimize(estimator_pressure(&estimator, time_us));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_clock_sync(uint64_t iterations)
+{
+    clock_sync_t sync;
+    clock_sync_reset(&sync);
+    uint32_t local_us = 0;
+    uint32_t master_us = 0xFFF00000;
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        // 1 s exchanges, master 40 ppm fast, up to 64 us of delay
+        local_us += 1000000 + ((uint32_t)(i * 2654435761u) >> 26);
+        master_us += 1000040;
+        clock_sync_update(&sync, local_us, master_us);
+        do_not_optimize(clock_sync_time(&sync, local_us + 500));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_journal_write(uint64_t iterations)
+{
+    journal_t journal;
+    journal_clear(&journal);
+    journal_entry_t entry = {IGNITION_SQ, BURN, SLEEP, ABORT_OXYDANT, OUT_ME_b | OUT_MO_bC, 0};
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        entry.ignition = (uint8_t)(i % NOGO);
+        journal_write(&journal, &entry, (uint32_t)i);
+    }
+    timer.stop();
+    do_not_optimize(journal.slots[0].crc);
+    return timer.ns();
+}
+
+static double bench_warm_resume(uint64_t iterations)
+{
+    // reset during the ethanol passivation: ME_b opened again
+    journal_clear(&sequence_journal);
+    journal_entry_t entry = {PASSIVATION_SQ, NOGO, PASSIVATION_INTERLUDE, ABORT_OXYDANT, OUT_ME_b, 0};
+    journal_write(&sequence_journal, &entry, 0);
+    PRBComputer computer(IDLE);
+    outputs_begin();
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        do_not_optimize(computer.resume(SRC_SRSR_WDOG_RST_B));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_net_select(uint64_t iterations)
+{
+    static const uint8_t reads[] = {AV_NET_PRB_FSM_PRB, AV_NET_PRB_P_OIN, AV_NET_PRB_T_FLS_0, AV_NET_PRB_P_EIN,
+                                    AV_NET_PRB_T_EIN, AV_NET_PRB_P_CCC, AV_NET_PRB_T_CCC, AV_NET_PRB_T_FLS_10,
+                                    AV_NET_PRB_VALVES_STATE, AV_NET_PRB_SPECIFIC_IMP, AV_NET_PRB_PRESSURE_CHECK};
+    const size_t count = sizeof(reads) / sizeof(reads[0]);
+    PRBComputer computer(IDLE);
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        net_receive(computer, &reads[i % count], 1);
+        do_not_optimize(net_resp_data);
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_net_valves(uint64_t iterations)
+{
+    PRBComputer computer(IDLE);
+    outputs_begin();
+    uint8_t frame[1 + AV_NET_XFER_SIZE] = {AV_NET_PRB_VALVES_STATE, AV_NET_CMD_OFF, AV_NET_CMD_OFF, 0, 0};
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        // ME toggled, MO closed
+        frame[1] = (i & 1) ? AV_NET_CMD_ON : AV_NET_CMD_OFF;
+        net_receive(computer, frame, sizeof(frame));
+        do_not_optimize(net_resp_data);
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_codec_encode(uint64_t iterations)
+{
+    sample_codec_t codec;
+    codec_reset(&codec);
+    uint8_t output[CODEC_MAX_RECORD];
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        do_not_optimize(codec_encode(&codec, &codec_records[i % INPUTS], output));
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static double bench_codec_decode(uint64_t iterations)
+{
+    // one pass over the inputs encoded as a stream, decoded in a loop (its first record is absolute)
+    sample_codec_t codec;
+    codec_reset(&codec);
+    std::vector<uint8_t> stream(INPUTS * CODEC_MAX_RECORD);
+    size_t length = 0;
+    for (int i = 0; i < INPUTS; i++) length += codec_encode(&codec, &codec_records[i], stream.data() + length);
+
+    codec_reset(&codec);
+    sample_record_t record;
+    size_t offset = 0;
+    BenchTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (offset >= length) offset = 0;
+        offset += codec_decode(&codec, stream.data() + offset, length - offset, &record);
+        do_not_optimize(record.values[TLM_CCC_PRESS]);
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+// ================= update() with simulated I/O =================
+/**
+ * @brief Simulated sensor front-end (as in replay): multiplexer and three PTE7300 on Wire2.
+ */
+class UpdateBench
+{
+public:
+    UpdateBench() : mux(MUX_ADDR, RESET), ein(SENS_ADDR), ccc(SENS_ADDR), oin(SENS_ADDR)
+    {
+        host::reset();
+        bus.attach(&mux);
+        mux.attach(0, &ein);
+        mux.attach(1, &ccc);
+        mux.attach(2, &oin);
+        bus.set_advance_clock(true);
+        Wire2.attach(&bus);
+        for (PTE7300Sim *sensor : {&ein, &ccc, &oin}) {
+            sensor->set_pressure_bar(BURN_PRESS_BAR);
+            sensor->set_temperature_c(21.0f);
+        }
+        host::set_analog(T_OIN, 1500);
+        host::set_analog(T_EIN, 1500);
+        digitalWrite(RESET, HIGH);
+    }
+    ~UpdateBench() { Wire2.attach(nullptr); }
+
+    // fresh PRBComputer, run through the ignition sequence up to BURN
+    void start_burn()
+    {
+        computer = PRBComputer(IDLE);
+        outputs_begin();
+        computer.set_state(CLEAR_TO_IGNITE);
+        computer.ignite(millis());
+        while (computer.get_state() == IGNITION_SQ && computer.get_ignition_stage() != BURN) tick();
+    }
+
+    bool burning() { return computer.get_state() == IGNITION_SQ && computer.get_ignition_stage() == BURN; }
+
+    void tick()
+    {
+        host::advance_us(1000);
+        computer.update(millis());
+    }
+
+    PRBComputer computer{IDLE};
+
+private:
+    I2CSimBus bus;
+    MuxSim mux;
+    PTE7300Sim ein;
+    PTE7300Sim ccc;
+    PTE7300Sim oin;
+};
+
+static double bench_update_burn_tick(uint64_t iterations)
+{
+    UpdateBench bench;
+    BenchTimer timer;
+    bench.start_burn();
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!bench.burning()) bench.start_burn();
+        timer.start();
+        bench.tick();
+        timer.stop();
+    }
+    return timer.ns();
+}
+
+static double bench_update_sweep(uint64_t iterations)
+{
+    UpdateBench bench;
+    BenchTimer timer;
+    outputs_begin();
+    bench.computer.set_state(CLEAR_TO_IGNITE); // same period on every channel
+    timer.start();
+    for (uint64_t i = 0; i < iterations; i++) {
+        host::advance_us(SAMPLE_ARMED_MS * 1000);
+        bench.computer.update(millis());
+    }
+    timer.stop();
+    return timer.ns();
+}
+
+static const bench_t benchmarks[] = {
+    {"crc4", bench_crc4},
+    {"crc8", bench_crc8},
+    {"sensata_pressure", bench_conversion<sensata_pressure_bar, dsp_inputs>},
+    {"sensata_temperature", bench_conversion<sensata_temperature_c, dsp_inputs>},
+    {"pt1000_temperature", bench_conversion<pt1000_temperature_c, adc_inputs>},
+    {"kulite_pressure", bench_conversion<kulite_pressure_bar, adc_inputs>},
+    {"ccc_mean5", bench_ccc_mean5},
+    {"impulse_step", bench_impulse_step},
+    {"estimator", bench_estimator},
+    {"codec_encode", bench_codec_encode},
+    {"codec_decode", bench_codec_decode},
+    {"clock_sync", bench_clock_sync},
+    {"journal_write", bench_journal_write},
+    {"warm_resume", bench_warm_resume},
+    {"net_select", bench_net_select},
+    {"net_valves", bench_net_valves},
+    {"update_burn_tick", bench_update_burn_tick},
+    {"update_sweep", bench_update_sweep},
+};
+
+// ================= runner =================
+static bench_result_t run(const bench_t &bench, double min_time_s, int repetitions)
+{
+    // grow the iteration count until one run lasts min_time_s
+    uint64_t iterations = 1;
+    while (true) {
+        double ns = bench.run(iterations);
+        if (ns >= min_time_s * 1e9 || iterations >= (1ULL << 40)) break;
+        double scale = ns > 0.0 ? min_time_s * 1e9 / ns * 1.2 : 10.0;
+        iterations = (uint64_t)(iterations * std::min(std::max(scale, 2.0), 100.0));
+    }
+
+    double fastest = INFINITY;
+    for (int r = 0; r < repetitions; r++) fastest = std::min(fastest, bench.run(iterations) / iterations);
+    return {bench.name, iterations, fastest};
+}
+
+static bool write_json(const char *path, const std::vector<bench_result_t> &results)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"context\": {\"executable\": \"benchmarks\", \"build_profile\": \"%s\"},\n", PROFILE.name);
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const bench_result_t &r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"iterations\": %llu, \"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\"}%s\n",
+                r.name.c_str(), (unsigned long long)r.iterations, r.ns_per_iteration, r.ns_per_iteration,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+// reads back the benchmark lines written by write_json()
+static bool read_json(const char *path, std::vector<bench_result_t> &results)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        const char *name = strstr(line, "\"name\": \"");
+        const char *time = strstr(line, "\"real_time\": ");
+        if (!name || !time) continue;
+        name += strlen("\"name\": \"");
+        const char *end = strchr(name, '"');
+        if (!end) continue;
+        results.push_back({std::string(name, end - name), 0, atof(time + strlen("\"real_time\": "))});
+    }
+    fclose(file);
+    return true;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: benchmarks [--filter TEXT] [--min-time S] [--repetitions N] [--json FILE] "
+                    "[--baseline FILE] [--threshold PCT] [trace...]\n");
+}
+
+// ================= sample codec compression =================
+/**
+ * @brief Encodes a trace with SampleCodec (one record per row) and reports its size against
+ * raw floats and TLM_SAMPLE frames, the decode throughput and the worst quantisation error.
+ */
+static bool codec_compression(const char *path)
+{
+    std::vector<prb_log_sample_t> trace;
+    if (!load_trace(path, trace) || trace.empty()) {
+        fprintf(stderr, "benchmarks: cannot load trace %s\n", path);
+        return false;
+    }
+
+    sample_codec_t codec;
+    codec_reset(&codec);
+    std::vector<sample_record_t> records(trace.size());
+    std::vector<uint8_t> stream(trace.size() * CODEC_MAX_RECORD);
+    size_t length = 0;
+    uint64_t values = 0;
+    for (size_t i = 0; i < trace.size(); i++) {
+        sample_record_t &record = records[i];
+        record.t_us = (uint32_t)trace[i].t_us;
+        record.mask = 0;
+        for (int c = 0; c < CODEC_CHANNELS; c++) {
+            record.values[c] = trace[i].values[c];
+            if (!isnan(record.values[c])) record.mask |= 1 << c;
+        }
+        values += __builtin_popcount(record.mask);
+        length += codec_encode(&codec, &record, stream.data() + length);
+    }
+
+    // decode once for the errors, then time whole passes
+    float max_error[2] = {0.0f, 0.0f};  // pressures, temperatures
+    codec_reset(&codec);
+    size_t offset = 0;
+    for (const sample_record_t &expected : records) {
+        sample_record_t record;
+        offset += codec_decode(&codec, stream.data() + offset, length - offset, &record);
+        for (int c = 0; c < CODEC_CHANNELS; c++) {
+            if (!(expected.mask & (1 << c))) continue;
+            bool press = c == TLM_CCC_PRESS || c == TLM_EIN_PRESS || c == TLM_OIN_PRESS;
+            float error = (record.mask & (1 << c)) ? fabsf(record.values[c] - expected.values[c]) : INFINITY;
+            max_error[press ? 0 : 1] = std::max(max_error[press ? 0 : 1], error);
+        }
+    }
+
+    int passes = 0;
+    BenchTimer timer;
+    timer.start();
+    auto start = bench_clock_t::now();
+    while (bench_clock_t::now() - start < std::chrono::milliseconds(100) || passes == 0) {
+        codec_reset(&codec);
+        sample_record_t record;
+        for (offset = 0; offset < length;) {
+            offset += codec_decode(&codec, stream.data() + offset, length - offset, &record);
+            do_not_optimize(record.values[TLM_CCC_PRESS]);
+        }
+        passes++;
+    }
+    timer.stop();
+
+    double raw = values * 4.0 + records.size() * 4.0;      // float per value, uint32 time per row
+    double frames = values * (double)TLM_SAMPLE_FRAME;
+    double packed_frames = length + records.size() * (double)TLM_FRAME_OVERHEAD;
+    printf("trace: %s (%zu records, %llu values)\n", path, records.size(), (unsigned long long)values);
+    printf("  packed      %8zu bytes  %5.2f bytes/value  %5.1fx smaller than floats\n", length,
+           length / (double)values, raw / length);
+    printf("  as frames   %8.0f bytes  %5.2f bytes/value  %5.1fx smaller than TLM_SAMPLE frames\n", packed_frames,
+           packed_frames / values, frames / packed_frames);
+    printf("  decode      %8.1f Mrecords/s  %8.1f MB/s\n", passes * records.size() / (timer.ns() / 1e3),
+           passes * length / (timer.ns() / 1e3));
+    printf("  max error   %8.4f bar  %8.4f °C\n", max_error[0], max_error[1]);
+    return max_error[0] <= CODEC_PRESS_LSB && max_error[1] <= CODEC_TEMP_LSB;
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = nullptr;
+    const char *json = nullptr;
+    const char *baseline = nullptr;
+    double min_time_s = DEFAULT_MIN_TIME_S;
+    int repetitions = DEFAULT_REPETITIONS;
+    double threshold = DEFAULT_THRESHOLD_PCT;
+    std::vector<const char *> traces;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && i + 1 < argc) min_time_s = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--repetitions") && i + 1 < argc) repetitions = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc) json = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && i + 1 < argc) baseline = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else traces.push_back(argv[i]);
+    }
+    if (repetitions < 1 || min_time_s <= 0.0) {
+        usage();
+        return 2;
+    }
+
+    std::vector<bench_result_t> reference;
+    if (baseline && !read_json(baseline, reference)) {
+        fprintf(stderr, "benchmarks: cannot read baseline %s\n", baseline);
+        return 2;
+    }
+
+    make_inputs();
+
+    printf("%-22s %14s %12s", "benchmark", "iterations", "ns/iter");
+    if (baseline) printf(" %12s %8s", "baseline", "change");
+    printf("\n");
+
+    std::vector<bench_result_t> results;
+    int regressions = 0;
+    for (const bench_t &bench : benchmarks) {
+        if (filter && !strstr(bench.name, filter)) continue;
+        bench_result_t r = run(bench, min_time_s, repetitions);
+        results.push_back(r);
+        printf("%-22s %14llu %12.2f", r.name.c_str(), (unsigned long long)r.iterations, r.ns_per_iteration);
+
+        if (baseline) {
+            auto match = std::find_if(reference.begin(), reference.end(),
+                                      [&](const bench_result_t &b) { return b.name == r.name; });
+            if (match == reference.end() || match->ns_per_iteration <= 0.0) {
+                printf(" %12s %8s", "-", "new");
+            } else {
+                double change = (r.ns_per_iteration / match->ns_per_iteration - 1.0) * 100.0;
+                bool regression = change > threshold;
+                printf(" %12.2f %+7.1f%%%s", match->ns_per_iteration, change, regression ? "  REGRESSION" : "");
+                if (regression) regressions++;
+            }
+        }
+        printf("\n");
+    }
+
+    int codec_failures = 0;
+    for (const char *path : traces) {
+        if (!codec_compression(path)) codec_failures++;
+    }
+
+    if (json && !write_json(json, results)) {
+        fprintf(stderr, "benchmarks: cannot write %s\n", json);
+        return 2;
+    }
+    if (regressions) {
+        printf("%d benchmark(s) slower than the baseline by more than %.1f%%\n", regressions, threshold);
+        return 1;
+    }
+    return codec_failures ? 1 : 0;
+}
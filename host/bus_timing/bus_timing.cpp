@@ -0,0 +1,216 @@
+/*
+ * File: bus_timing.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Sensor bus cost of the acquisition strategies, measured on the emulated Wire2 bus
+ *  (TCA-style multiplexer + three PTE7300) before flashing hardware. For every strategy and
+ *  bus clock it reports the transfers, bytes and bus time of one acquisition, and the total
+ *  elapsed time including the CPU-side waits (multiplexer reset pulse).
+ *
+ *  Strategies:
+ *    - update_sweep   : PRBComputer::update() with every channel of the schedule due (7 reads,
+ *                       one mux select per Sensata channel)
+ *    - sweep_ccc_bus  : same with the CCC Sensata alone on CCC_WIRE (no mux select for its reads)
+ *    - sweep_stale    : same sweep when no PTE7300 has converted since the previous one (polling
+ *                       faster than the sensors, only the STATUS reads with ACQ_DATA_READY)
+ *    - read_S         : one readDSP_S() on an already selected channel, no CRC
+ *    - read_S_crc     : same with CRC framing
+ *    - read_S_ready   : data-ready acquisition with a new conversion, readSTATUS() + readDSP_S()
+ *    - read_S_stale   : data-ready acquisition without one, readSTATUS() only
+ *    - channel_TS     : select channel, readDSP_T() + readDSP_S(), release mux
+ *    - channel_burst  : select channel, one 3-word read from DSP_T (0x2E..0x30), release mux
+ *
+ *  Usage: bus_timing [clock_hz...]   (default 100000 400000 1000000)
+ */
+
+#include <stdlib.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "PRBComputer.h"
+#include "sim/I2CSim.h"
+
+typedef struct bus_cost_t
+{
+    i2c_bus_stats_t bus;
+    uint64_t elapsed_us;
+    bool values_ok;
+}bus_cost_t;
+
+class TimingBench
+{
+public:
+    TimingBench(bool ccc_own_bus = false) : mux(MUX_ADDR, RESET), ein(SENS_ADDR), ccc(SENS_ADDR), oin(SENS_ADDR)
+    {
+        bus.attach(&mux);
+        mux.attach(0, &ein);
+        if (ccc_own_bus) ccc_bus.attach(&ccc);
+        else mux.attach(1, &ccc);
+        mux.attach(2, &oin);
+        bus.set_advance_clock(true);
+        ccc_bus.set_advance_clock(true);
+        Wire2.attach(&bus);
+        CCC_WIRE.attach(&ccc_bus);
+        for (PTE7300Sim *sensor : {&ein, &ccc, &oin}) {
+            sensor->set_pressure_bar(42.0f);
+            sensor->set_temperature_c(21.0f);
+        }
+    }
+    ~TimingBench()
+    {
+        Wire2.attach(nullptr);
+        CCC_WIRE.attach(nullptr);
+    }
+
+    // start of the measured window, strategies restart it after their set-up
+    void mark()
+    {
+        start_us = host::time_us();
+        bus.reset_stats();
+        ccc_bus.reset_stats();
+    }
+
+    I2CSimBus bus;
+    I2CSimBus ccc_bus;              // CCC_WIRE, CCC sensor alone on it with ccc_own_bus
+    MuxSim mux;
+    PTE7300Sim ein;
+    PTE7300Sim ccc;
+    PTE7300Sim oin;
+    uint64_t start_us;
+};
+
+static float dsp_s_to_bar(int16_t dsp) { return (dsp - (-16000.0f)) * 100.0f / (16000.0f - (-16000.0f)); }
+
+template <typename F>
+static bus_cost_t measure(uint32_t clock_hz, F strategy, bool ccc_own_bus = false)
+{
+    host::reset();
+    digitalWrite(RESET, HIGH);
+    TimingBench bench(ccc_own_bus);
+    Wire2.setClock(clock_hz);
+    CCC_WIRE.setClock(clock_hz);
+
+    bus_cost_t cost;
+    bench.mark();
+    cost.values_ok = strategy(bench);
+    cost.elapsed_us = host::time_us() - bench.start_us;
+    // both buses are blocking masters driven in turn: their times add up
+    cost.bus = bench.bus.stats();
+    const i2c_bus_stats_t &ccc_stats = bench.ccc_bus.stats();
+    cost.bus.transfers += ccc_stats.transfers;
+    cost.bus.bytes += ccc_stats.bytes;
+    cost.bus.bus_time_ns += ccc_stats.bus_time_ns;
+    return cost;
+}
+
+static bool update_sweep(TimingBench &bench, bool ccc_own_bus)
+{
+    PRBComputer computer(IDLE, ccc_own_bus ? CCC_WIRE : SENSOR_WIRE);
+    outputs_begin();
+    bench.mark();
+    computer.update(millis());
+    const prb_memory_t &memory = computer.get_memory();
+    return fabsf(memory.ccc_press - 42.0f) < 0.01f && fabsf(memory.ein_temp_sensata - 21.0f) < 0.01f;
+}
+
+static bool sweep_stale(TimingBench &bench)
+{
+    PRBComputer computer(IDLE);
+    outputs_begin();
+    for (PTE7300Sim *sensor : {&bench.ein, &bench.ccc, &bench.oin}) sensor->set_conversion_period_us(10000000);
+    computer.update(millis());
+    host::advance_us(SAMPLE_IDLE_MS * 1000ULL); // every IDLE channel due again
+    bench.mark();
+    computer.update(millis());
+    const prb_memory_t &memory = computer.get_memory();
+    bool tagged = PROFILE.acquisition == ACQ_POLL || !(memory.fresh_samples & (1 << TLM_CCC_PRESS));
+    return tagged && fabsf(memory.ccc_press - 42.0f) < 0.01f && fabsf(memory.ein_temp_sensata - 21.0f) < 0.01f;
+}
+
+static bool read_s(TimingBench &bench, bool crc)
+{
+    PTE7300_I2C sensor;
+    sensor.CRC(crc);
+    selectI2CChannel(CCC_CH);
+    bench.mark();
+    int16_t dsp = sensor.readDSP_S();
+    return fabsf(dsp_s_to_bar(dsp) - 42.0f) < 0.01f;
+}
+
+// data-ready acquisition (ACQ_DATA_READY): DSP_S is only read when STATUS flags a new result
+static bool read_s_ready(TimingBench &bench, bool stale)
+{
+    PTE7300_I2C sensor;
+    bench.ccc.set_conversion_period_us(stale ? 1000000 : 0);
+    selectI2CChannel(CCC_CH);
+    sensor.readDSP_S(); // takes the pending result, clears DSP_S_UP
+    bench.mark();
+    if (!(sensor.readSTATUS() & PTE7300_STATUS_DSP_S_UP)) return stale;
+    int16_t dsp = sensor.readDSP_S();
+    return !stale && fabsf(dsp_s_to_bar(dsp) - 42.0f) < 0.01f;
+}
+
+static bool channel_ts(TimingBench &)
+{
+    PTE7300_I2C sensor;
+    selectI2CChannel(CCC_CH);
+    sensor.readDSP_T();
+    int16_t dsp = sensor.readDSP_S();
+    endI2CCommunication();
+    return fabsf(dsp_s_to_bar(dsp) - 42.0f) < 0.01f;
+}
+
+static bool channel_burst(TimingBench &)
+{
+    selectI2CChannel(CCC_CH);
+    Wire2.beginTransmission(SENS_ADDR);
+    Wire2.write(0x2E);
+    Wire2.endTransmission();
+    Wire2.requestFrom(SENS_ADDR, 6);
+    uint8_t raw[6];
+    for (int i = 0; i < 6; i++) raw[i] = (uint8_t)Wire2.read();
+    endI2CCommunication();
+    int16_t dsp = (int16_t)(raw[4] | (raw[5] << 8));
+    return fabsf(dsp_s_to_bar(dsp) - 42.0f) < 0.01f;
+}
+
+static void report(const char *name, uint32_t clock_hz, const bus_cost_t &cost)
+{
+    printf("%-14s %8u %9u %6llu %12.1f %12.1f  %s\n", name, clock_hz, cost.bus.transfers,
+           (unsigned long long)cost.bus.bytes, cost.bus.bus_time_ns / 1000.0, (double)cost.elapsed_us,
+           cost.values_ok ? "ok" : "MISMATCH");
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<uint32_t> clocks;
+    for (int i = 1; i < argc; i++) clocks.push_back((uint32_t)atol(argv[i]));
+    if (clocks.empty()) clocks = {100000, 400000, 1000000};
+
+    printf("%-14s %8s %9s %6s %12s %12s  %s\n", "strategy", "clock", "transfers", "bytes", "bus_time_us",
+           "elapsed_us", "values");
+    int mismatches = 0;
+    for (uint32_t clock_hz : clocks) {
+        bus_cost_t costs[9] = {
+            measure(clock_hz, [](TimingBench &b) { return update_sweep(b, false); }),
+            measure(clock_hz, [](TimingBench &b) { return update_sweep(b, true); }, true),
+            measure(clock_hz, sweep_stale),
+            measure(clock_hz, [](TimingBench &b) { return read_s(b, false); }),
+            measure(clock_hz, [](TimingBench &b) { return read_s(b, true); }),
+            measure(clock_hz, [](TimingBench &b) { return read_s_ready(b, false); }),
+            measure(clock_hz, [](TimingBench &b) { return read_s_ready(b, true); }),
+            measure(clock_hz, channel_ts),
+            measure(clock_hz, channel_burst),
+        };
+        const char *names[9] = {"update_sweep", "sweep_ccc_bus", "sweep_stale", "read_S", "read_S_crc", "read_S_ready", "read_S_stale",
+                                "channel_TS", "channel_burst"};
+        for (int i = 0; i < 9; i++) {
+            report(names[i], clock_hz, costs[i]);
+            if (!costs[i].values_ok) mismatches++;
+        }
+    }
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * File: clock_sync.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Simulates AV_NET_PRB_TIMESTAMP exchanges between a master clock and the PRB micros() and
+ *  measures how well the ClockSync estimate maps local times to master times:
+ *    - the master clock runs --drift-ppm faster than the PRB one and starts 30 s before its
+ *      uint32 wrap
+ *    - it sends its time every --period-ms (+-10 %), the command reaches receiveEvent() after
+ *      CLOCK_SYNC_LATENCY_US plus an exponential delay of mean --jitter-us (master scheduling)
+ *    - a fraction --outliers of the exchanges is delayed by 2 to 20 ms more
+ *    - with --step-at S, the master clock jumps by --step-ms at S seconds
+ *
+ *  The estimate is checked against the true master time every TICK_US. The tool reports the
+ *  time to the first error below CONVERGED_US, the RMS and worst error after WARMUP_S (and after
+ *  the step), the mean sync error reported by clock_sync_error() against the actual RMS, and
+ *  the rejected exchanges.
+ *
+ *  Usage: clock_sync [--drift-ppm PPM] [--jitter-us US] [--period-ms MS] [--outliers P]
+ *                    [--step-at S] [--step-ms MS] [--duration S] [--seed N] [--csv]
+ */
+
+#include <random>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "constant.h"
+#include "ClockSync.h"
+
+#define TICK_US             10000
+#define WARMUP_S            30
+#define CONVERGED_US        100
+#define LOCAL_START_US      1000000ULL
+#define MASTER_START_US     (0x100000000ULL - 30000000ULL)  // wraps 30 s in
+
+typedef struct sync_report_t
+{
+    double converged_s;             // first error below CONVERGED_US, -1 if never
+    double rms_us;                  // after the warm-up (and the step)
+    double max_us;
+    double reported_us;             // mean clock_sync_error() over the same ticks
+    uint16_t exchanges;
+    uint16_t rejected;
+}sync_report_t;
+
+typedef struct sync_config_t
+{
+    double drift_ppm;
+    double jitter_us;
+    double period_ms;
+    double outliers;
+    double step_at_s;               // < 0: no step
+    double step_ms;
+    double duration_s;
+    unsigned seed;
+}sync_config_t;
+
+static sync_report_t simulate(const sync_config_t &config)
+{
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::exponential_distribution<double> jitter(config.jitter_us > 0 ? 1.0 / config.jitter_us : 1.0);
+
+    // master time at true time t [us] (true time = local time of the PRB)
+    auto master_at = [&](double t_us) {
+        double master = MASTER_START_US + t_us * (1.0 + config.drift_ppm * 1e-6);
+        if (config.step_at_s >= 0 && t_us >= config.step_at_s * 1e6) master += config.step_ms * 1000.0;
+        return (uint32_t)(uint64_t)llround(master);
+    };
+
+    clock_sync_t sync;
+    clock_sync_reset(&sync);
+    sync_report_t report = {-1.0, 0.0, 0.0, 0.0, 0, 0};
+
+    double end_us = config.duration_s * 1e6;
+    double steady_us = WARMUP_S * 1e6;
+    if (config.step_at_s >= 0) steady_us = fmax(steady_us, config.step_at_s * 1e6 + WARMUP_S * 1e6);
+    double next_exchange_us = 0.0;
+    double sum_sq = 0.0, sum_reported = 0.0;
+    uint64_t ticks = 0;
+
+    for (double t = 0.0; t < end_us; t += TICK_US) {
+        while (next_exchange_us <= t) {
+            // the master stamps its time, the command is received later
+            double sent = next_exchange_us;
+            double delay = CLOCK_SYNC_LATENCY_US + (config.jitter_us > 0 ? jitter(rng) : 0.0);
+            if (unit(rng) < config.outliers) delay += 2000.0 + 18000.0 * unit(rng);
+            uint32_t local = (uint32_t)(LOCAL_START_US + (uint64_t)llround(sent + delay));
+            clock_sync_update(&sync, local, master_at(sent));
+            next_exchange_us += config.period_ms * 1000.0 * (0.9 + 0.2 * unit(rng));
+        }
+
+        uint32_t local = (uint32_t)(LOCAL_START_US + (uint64_t)t);
+        double error = fabs((double)(int32_t)(clock_sync_time(&sync, local) - master_at(t)));
+        if (report.converged_s < 0 && sync.samples == 2 && error < CONVERGED_US) report.converged_s = t / 1e6;
+        if (t < steady_us) continue;
+        sum_sq += error * error;
+        report.max_us = fmax(report.max_us, error);
+        float reported = clock_sync_error(&sync, local);
+        if (!isnan(reported)) sum_reported += reported;
+        ticks++;
+    }
+
+    if (ticks) {
+        report.rms_us = sqrt(sum_sq / ticks);
+        report.reported_us = sum_reported / ticks;
+    }
+    report.exchanges = sync.exchanges;
+    report.rejected = sync.rejected;
+    return report;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: clock_sync [--drift-ppm PPM] [--jitter-us US] [--period-ms MS] [--outliers P] "
+                    "[--step-at S] [--step-ms MS] [--duration S] [--seed N] [--csv]\n");
+}
+
+int main(int argc, char **argv)
+{
+    sync_config_t config = {40.0, 50.0, 1000.0, 0.02, -1.0, 250.0, 600.0, 1234};
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--drift-ppm") && i + 1 < argc) config.drift_ppm = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--jitter-us") && i + 1 < argc) config.jitter_us = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--period-ms") && i + 1 < argc) config.period_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--outliers") && i + 1 < argc) config.outliers = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--step-at") && i + 1 < argc) config.step_at_s = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--step-ms") && i + 1 < argc) config.step_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--duration") && i + 1 < argc) config.duration_s = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) config.seed = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else { usage(); return 2; }
+    }
+    if (config.period_ms <= 0 || config.duration_s <= WARMUP_S) {
+        usage();
+        return 2;
+    }
+
+    sync_report_t r = simulate(config);
+    if (csv) {
+        printf("drift_ppm,jitter_us,period_ms,outliers,converged_s,rms_us,max_us,reported_us,exchanges,rejected\n");
+        printf("%.1f,%.1f,%.1f,%.3f,%.2f,%.1f,%.1f,%.1f,%u,%u\n", config.drift_ppm, config.jitter_us,
+               config.period_ms, config.outliers, r.converged_s, r.rms_us, r.max_us, r.reported_us,
+               r.exchanges, r.rejected);
+    } else {
+        printf("master: %+.1f ppm, jitter %.0f us, every %.0f ms, %.1f %% outliers", config.drift_ppm,
+               config.jitter_us, config.period_ms, config.outliers * 100.0);
+        if (config.step_at_s >= 0) printf(", %+.0f ms step at %.0f s", config.step_ms, config.step_at_s);
+        printf("\n");
+        if (r.converged_s >= 0) printf("  converged   : %.2f s (error < %d us)\n", r.converged_s, CONVERGED_US);
+        else printf("  converged   : never\n");
+        printf("  error       : rms %.1f us, max %.1f us (after warm-up)\n", r.rms_us, r.max_us);
+        printf("  reported    : %.1f us mean sync error\n", r.reported_us);
+        printf("  exchanges   : %u accepted, %u rejected\n", r.exchanges, r.rejected);
+    }
+    return 0;
+}
@@ -0,0 +1,312 @@
+/*
+ * File: prb_log.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Reader, writer and trace loader for the .prbl columnar log format (see prb_log.h).
+ */
+
+#include "prb_log.h"
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char *const prb_log_channel_names[LOG_SAMPLE_CHANNELS] = {
+    "ccc_press",
+    "ein_press",
+    "ccc_temp",
+    "ein_temp_sensata",
+    "oin_temp",
+    "ein_temp_pt1000",
+    "oin_press",
+};
+
+size_t prb_log_column_bytes(size_t rows, size_t element_size)
+{
+    size_t bytes = rows * element_size;
+    return (bytes + PRB_LOG_ALIGN - 1) & ~(size_t)(PRB_LOG_ALIGN - 1);
+}
+
+// ========= reader =========
+PRBLogReader::PRBLogReader()
+{
+    fd = -1;
+    data = nullptr;
+    length = 0;
+    offset = 0;
+}
+
+PRBLogReader::~PRBLogReader() { close(); }
+
+bool PRBLogReader::open(const char *path)
+{
+    close();
+    fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(prb_log_file_header_t)) {
+        close();
+        return false;
+    }
+    length = (size_t)st.st_size;
+    void *map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data = (const uint8_t *)map;
+    madvise(map, length, MADV_SEQUENTIAL);
+
+    const prb_log_file_header_t *header = (const prb_log_file_header_t *)data;
+    if (memcmp(header->magic, PRB_LOG_MAGIC, 4) != 0 || header->version != PRB_LOG_VERSION) {
+        close();
+        return false;
+    }
+    offset = sizeof(prb_log_file_header_t);
+    return true;
+}
+
+void PRBLogReader::close()
+{
+    if (data) munmap((void *)data, length);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    data = nullptr;
+    length = 0;
+    offset = 0;
+}
+
+void PRBLogReader::rewind() { offset = data ? sizeof(prb_log_file_header_t) : 0; }
+
+bool PRBLogReader::next_group(const prb_log_group_header_t **header, const uint8_t **payload)
+{
+    if (!data || offset + sizeof(prb_log_group_header_t) > length) return false;
+    const prb_log_group_header_t *group = (const prb_log_group_header_t *)(data + offset);
+    if (group->bytes > length - offset - sizeof(prb_log_group_header_t)) return false;
+
+    *header = group;
+    *payload = data + offset + sizeof(prb_log_group_header_t);
+    offset += sizeof(prb_log_group_header_t) + group->bytes;
+    return true;
+}
+
+bool PRBLogReader::next_samples(prb_log_samples_view_t *view)
+{
+    const prb_log_group_header_t *header;
+    const uint8_t *payload;
+    while (next_group(&header, &payload)) {
+        if (header->table != PRB_LOG_SAMPLES) continue;
+
+        size_t expected = prb_log_column_bytes(header->rows, sizeof(int64_t)) +
+                          LOG_SAMPLE_CHANNELS * prb_log_column_bytes(header->rows, sizeof(float));
+        if (header->bytes < expected) return false;
+
+        view->rows = header->rows;
+        view->t_us = (const int64_t *)payload;
+        payload += prb_log_column_bytes(header->rows, sizeof(int64_t));
+        for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) {
+            view->columns[c] = (const float *)payload;
+            payload += prb_log_column_bytes(header->rows, sizeof(float));
+        }
+        return true;
+    }
+    return false;
+}
+
+bool PRBLogReader::next_events(prb_log_events_view_t *view)
+{
+    const prb_log_group_header_t *header;
+    const uint8_t *payload;
+    while (next_group(&header, &payload)) {
+        if (header->table != PRB_LOG_EVENTS) continue;
+
+        size_t expected = prb_log_column_bytes(header->rows, sizeof(int64_t)) +
+                          (1 + PRB_LOG_EVENT_ARGS) * prb_log_column_bytes(header->rows, sizeof(uint8_t));
+        if (header->bytes < expected) return false;
+
+        view->rows = header->rows;
+        view->t_us = (const int64_t *)payload;
+        payload += prb_log_column_bytes(header->rows, sizeof(int64_t));
+        view->kind = payload;
+        payload += prb_log_column_bytes(header->rows, sizeof(uint8_t));
+        for (int a = 0; a < PRB_LOG_EVENT_ARGS; a++) {
+            view->args[a] = payload;
+            payload += prb_log_column_bytes(header->rows, sizeof(uint8_t));
+        }
+        return true;
+    }
+    return false;
+}
+
+// ========= writer =========
+PRBLogWriter::PRBLogWriter() { file = nullptr; }
+PRBLogWriter::~PRBLogWriter() { close(); }
+
+bool PRBLogWriter::open(const char *path)
+{
+    close();
+    file = fopen(path, "wb");
+    if (!file) return false;
+
+    prb_log_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PRB_LOG_MAGIC, 4);
+    header.version = PRB_LOG_VERSION;
+    fwrite(&header, sizeof(header), 1, file);
+    return true;
+}
+
+void PRBLogWriter::append(const prb_log_sample_t &sample)
+{
+    t_us.push_back(sample.t_us);
+    for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) columns[c].push_back(sample.values[c]);
+    if (t_us.size() >= PRB_LOG_GROUP_ROWS) flush();
+}
+
+void PRBLogWriter::append(const prb_log_event_t &event)
+{
+    event_t_us.push_back(event.t_us);
+    event_kind.push_back(event.kind);
+    for (int a = 0; a < PRB_LOG_EVENT_ARGS; a++) event_args[a].push_back(event.args[a]);
+    if (event_t_us.size() >= PRB_LOG_GROUP_ROWS) flush();
+}
+
+void PRBLogWriter::write_group_header(prb_log_table_t table, size_t rows, size_t bytes)
+{
+    prb_log_group_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.table = table;
+    header.rows = (uint32_t)rows;
+    header.bytes = bytes;
+    fwrite(&header, sizeof(header), 1, file);
+}
+
+void PRBLogWriter::write_padded(const void *bytes_data, size_t bytes)
+{
+    static const uint8_t zeros[PRB_LOG_ALIGN] = {0};
+    fwrite(bytes_data, 1, bytes, file);
+    size_t padding = (PRB_LOG_ALIGN - bytes % PRB_LOG_ALIGN) % PRB_LOG_ALIGN;
+    fwrite(zeros, 1, padding, file);
+}
+
+void PRBLogWriter::flush()
+{
+    if (!file) return;
+
+    size_t rows = t_us.size();
+    if (rows > 0) {
+        write_group_header(PRB_LOG_SAMPLES, rows,
+                           prb_log_column_bytes(rows, sizeof(int64_t)) +
+                           LOG_SAMPLE_CHANNELS * prb_log_column_bytes(rows, sizeof(float)));
+        write_padded(t_us.data(), rows * sizeof(int64_t));
+        for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) {
+            write_padded(columns[c].data(), rows * sizeof(float));
+            columns[c].clear();
+        }
+        t_us.clear();
+    }
+
+    rows = event_t_us.size();
+    if (rows > 0) {
+        write_group_header(PRB_LOG_EVENTS, rows,
+                           prb_log_column_bytes(rows, sizeof(int64_t)) +
+                           (1 + PRB_LOG_EVENT_ARGS) * prb_log_column_bytes(rows, sizeof(uint8_t)));
+        write_padded(event_t_us.data(), rows * sizeof(int64_t));
+        write_padded(event_kind.data(), rows);
+        for (int a = 0; a < PRB_LOG_EVENT_ARGS; a++) {
+            write_padded(event_args[a].data(), rows);
+            event_args[a].clear();
+        }
+        event_t_us.clear();
+        event_kind.clear();
+    }
+    fflush(file);
+}
+
+void PRBLogWriter::close()
+{
+    if (!file) return;
+    flush();
+    fclose(file);
+    file = nullptr;
+}
+
+// ========= trace loading =========
+static bool load_trace_csv(const char *path, std::vector<prb_log_sample_t> &samples)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[1024];
+    if (!fgets(line, sizeof(line), file)) {
+        fclose(file);
+        return false;
+    }
+
+    // map CSV columns to channels (-1: ignored, -2: time [ms], -3: time [us])
+    int mapping[32];
+    int n_columns = 0;
+    bool has_time = false;
+    for (char *token = strtok(line, ",\r\n"); token && n_columns < 32; token = strtok(nullptr, ",\r\n")) {
+        while (*token == ' ') token++;
+        int target = -1;
+        if (strcmp(token, "time_ms") == 0) target = -2;
+        else if (strcmp(token, "t_us") == 0) target = -3;
+        for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) {
+            if (strcmp(token, prb_log_channel_names[c]) == 0) target = c;
+        }
+        if (target <= -2) has_time = true;
+        mapping[n_columns++] = target;
+    }
+    if (!has_time) {
+        fclose(file);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        prb_log_sample_t sample;
+        sample.t_us = 0;
+        for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) sample.values[c] = NAN;
+
+        char *cursor = line;
+        for (int i = 0; i < n_columns && *cursor && *cursor != '\n'; i++) {
+            char *end;
+            double value = strtod(cursor, &end);
+            bool empty = (end == cursor);
+            if (mapping[i] == -2 && !empty) sample.t_us = (int64_t)llround(value * 1000.0);
+            else if (mapping[i] == -3 && !empty) sample.t_us = (int64_t)llround(value);
+            else if (mapping[i] >= 0 && !empty) sample.values[mapping[i]] = (float)value;
+            cursor = strchr(end, ',');
+            if (!cursor) break;
+            cursor++;
+        }
+        samples.push_back(sample);
+    }
+    fclose(file);
+    return true;
+}
+
+bool load_trace(const char *path, std::vector<prb_log_sample_t> &samples)
+{
+    samples.clear();
+    PRBLogReader reader;
+    if (!reader.open(path)) return load_trace_csv(path, samples);
+
+    prb_log_samples_view_t view;
+    while (reader.next_samples(&view)) {
+        for (uint32_t r = 0; r < view.rows; r++) {
+            prb_log_sample_t sample;
+            sample.t_us = view.t_us[r];
+            for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) sample.values[c] = view.columns[c][r];
+            samples.push_back(sample);
+        }
+    }
+    return true;
+}
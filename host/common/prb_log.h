@@ -0,0 +1,174 @@
+#ifndef PRB_LOG_H
+#define PRB_LOG_H
+/*
+ * File: prb_log.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Columnar binary log format shared by the host tools (".prbl" files).
+ *
+ *  Layout:
+ *    - prb_log_file_header_t (16 bytes, magic "PRBL")
+ *    - any number of row groups, each a prb_log_group_header_t followed by its columns stored
+ *      one after the other. Every column starts on an 8-byte boundary so a memory-mapped file
+ *      can be read in place without copies.
+ *
+ *  Samples table columns: t_us (int64), then one float per prb_log_channel_t.
+ *  Events table columns: t_us (int64), kind (uint8), then PRB_LOG_EVENT_ARGS uint8 arguments.
+ *  Writers append row groups as they go, so a log stays readable while it is being recorded.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#define PRB_LOG_MAGIC       "PRBL"
+#define PRB_LOG_VERSION     1
+#define PRB_LOG_ALIGN       8
+#define PRB_LOG_GROUP_ROWS  4096
+
+#define PRB_LOG_EVENT_ARGS  4
+
+enum prb_log_table_t
+{
+    PRB_LOG_SAMPLES = 1,
+    PRB_LOG_EVENTS  = 2,
+};
+
+enum prb_log_event_kind_t
+{
+    LOG_EVENT_STATE = 1,            // args: PRB_FSM, ignition, passivation, abort stage
+    LOG_EVENT_VALVE = 2,            // args: pin, level
+};
+
+enum prb_log_channel_t
+{
+    LOG_CCC_PRESS,
+    LOG_EIN_PRESS,
+    LOG_CCC_TEMP,
+    LOG_EIN_TEMP_SENSATA,
+    LOG_OIN_TEMP,
+    LOG_EIN_TEMP_PT1000,
+    LOG_OIN_PRESS,
+    LOG_SAMPLE_CHANNELS
+};
+
+// column names, same as the prb_memory_t fields
+extern const char *const prb_log_channel_names[LOG_SAMPLE_CHANNELS];
+
+typedef struct prb_log_file_header_t
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t reserved2;
+}prb_log_file_header_t;
+
+typedef struct prb_log_group_header_t
+{
+    uint16_t table;                 // prb_log_table_t
+    uint16_t reserved;
+    uint32_t rows;                  // number of rows in the group
+    uint64_t bytes;                 // size of the columns following this header
+}prb_log_group_header_t;
+
+typedef struct prb_log_sample_t
+{
+    int64_t t_us;                           // sample time [us]
+    float values[LOG_SAMPLE_CHANNELS];      // NAN when the channel was not acquired
+}prb_log_sample_t;
+
+typedef struct prb_log_event_t
+{
+    int64_t t_us;                           // event time [us]
+    uint8_t kind;                           // prb_log_event_kind_t
+    uint8_t args[PRB_LOG_EVENT_ARGS];
+}prb_log_event_t;
+
+// zero-copy view of one row group of the samples table
+typedef struct prb_log_samples_view_t
+{
+    uint32_t rows;
+    const int64_t *t_us;
+    const float *columns[LOG_SAMPLE_CHANNELS];
+}prb_log_samples_view_t;
+
+// zero-copy view of one row group of the events table
+typedef struct prb_log_events_view_t
+{
+    uint32_t rows;
+    const int64_t *t_us;
+    const uint8_t *kind;
+    const uint8_t *args[PRB_LOG_EVENT_ARGS];
+}prb_log_events_view_t;
+
+size_t prb_log_column_bytes(size_t rows, size_t element_size);
+
+
+/**
+ * @brief Memory-maps a .prbl file and walks its row groups in place.
+ */
+class PRBLogReader
+{
+public:
+    PRBLogReader();
+    ~PRBLogReader();
+
+    bool open(const char *path);
+    void close();
+
+    // iterate row groups; returns false at end of file or on a truncated group
+    bool next_group(const prb_log_group_header_t **header, const uint8_t **payload);
+    bool next_samples(prb_log_samples_view_t *view);
+    bool next_events(prb_log_events_view_t *view);
+    void rewind();
+
+    size_t size() const { return length; }
+
+private:
+    int fd;
+    const uint8_t *data;
+    size_t length;
+    size_t offset;
+};
+
+
+/**
+ * @brief Appends samples and events to a .prbl file, one row group every PRB_LOG_GROUP_ROWS rows.
+ */
+class PRBLogWriter
+{
+public:
+    PRBLogWriter();
+    ~PRBLogWriter();
+
+    bool open(const char *path);
+    void append(const prb_log_sample_t &sample);
+    void append(const prb_log_event_t &event);
+    void flush();
+    void close();
+
+private:
+    FILE *file;
+    std::vector<int64_t> t_us;
+    std::vector<float> columns[LOG_SAMPLE_CHANNELS];
+    std::vector<int64_t> event_t_us;
+    std::vector<uint8_t> event_kind;
+    std::vector<uint8_t> event_args[PRB_LOG_EVENT_ARGS];
+
+    void write_group_header(prb_log_table_t table, size_t rows, size_t bytes);
+    void write_padded(const void *data, size_t bytes);
+};
+
+
+/**
+ * @brief Loads a recorded trace, either a .prbl log or a CSV file.
+ *
+ * CSV files have a header line; "time_ms" (or "t_us") is required, the other columns are
+ * matched by name against prb_log_channel_names and missing ones are left to NAN.
+ */
+bool load_trace(const char *path, std::vector<prb_log_sample_t> &samples);
+
+#endif // PRB_LOG_H
@@ -0,0 +1,241 @@
+/*
+ * File: estimator.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Compares the chamber pressure seen by the BURN decisions on recorded traces:
+ *    - hold:      latest sensor sweep value (what the integral uses without the estimator)
+ *    - mean5:     mean of the last 5 sweep values (ccc_press_buffer ramp-up check)
+ *    - estimator: alpha-beta estimate extrapolated to each tick (PressureEstimator)
+ *
+ *  The trace CCC pressure is the reference. It is sampled like the firmware does, one sample
+ *  every --sweep-ms (default: SAMPLE_ARMED_MS period, one loop late), with optional added
+ *  measurement noise, and every signal is evaluated on a 1 ms control tick. The BURN schedule
+ *  samples the CCC on every loop: ~11 ms behind the multiplexer, 1 ms on its own bus. For each signal the tool reports:
+ *    - delay: the time shift minimising the RMS error against the reference on the ramps
+ *      (reference slope above RAMP_RATE), and that RMS error
+ *    - plateau noise: RMS error off the ramps
+ *    - crossing: delay to cross --level after the reference did (ramp-up check)
+ *
+ *  Usage: estimator [--level BAR] [--noise BAR] [--sweep-ms MS] [--csv] trace...
+ */
+
+#include <vector>
+#include <random>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "constant.h"
+#include "PressureEstimator.h"
+#include "common/prb_log.h"
+
+#define DEFAULT_LEVEL_BAR   27.5f       // RAMP_UP_CHECK_PRESSURE of the hot_fire profile
+#define TICK_US             1000
+#define MAX_DELAY_MS        500
+#define RAMP_RATE           20.0f       //[bar/s] reference slope above which a tick counts as a ramp
+#define RAMP_SPAN_MS        50          // slope measured over this span, above the trace noise
+#define NOISE_SEED          1234
+#define DEFAULT_SWEEP_MS    (SAMPLE_ARMED_MS + 1)
+
+enum estimator_signal_t
+{
+    SIGNAL_HOLD,
+    SIGNAL_MEAN5,
+    SIGNAL_ESTIMATOR,
+    SIGNALS
+};
+
+static const char *const signal_names[SIGNALS] = {"hold", "mean5", "estimator"};
+
+typedef struct signal_report_t
+{
+    int delay_ms;                   // on the ramps
+    double error;                   // RMS on the ramps at delay_ms [bar]
+    double plateau_noise;           // RMS off the ramps at delay_ms [bar]
+    double crossing_ms;             // -1 if the level is never crossed
+}signal_report_t;
+
+// reference pressure at t, linear between the valid trace samples
+class Reference
+{
+public:
+    explicit Reference(const std::vector<prb_log_sample_t> &trace)
+    {
+        for (const prb_log_sample_t &sample : trace) {
+            float p = sample.values[LOG_CCC_PRESS];
+            if (!isnan(p)) points.push_back({sample.t_us, p});
+        }
+    }
+
+    bool empty() const { return points.size() < 2; }
+    int64_t begin_us() const { return points.front().t_us; }
+    int64_t end_us() const { return points.back().t_us; }
+
+    float at(int64_t t_us)
+    {
+        if (t_us <= points.front().t_us) return points.front().press;
+        if (t_us >= points.back().t_us) return points.back().press;
+        while (cursor > 0 && points[cursor].t_us > t_us) cursor--;
+        while (points[cursor + 1].t_us < t_us) cursor++;
+        const point_t &a = points[cursor];
+        const point_t &b = points[cursor + 1];
+        return a.press + (b.press - a.press) * (float)(t_us - a.t_us) / (float)(b.t_us - a.t_us);
+    }
+
+private:
+    typedef struct point_t
+    {
+        int64_t t_us;
+        float press;
+    }point_t;
+
+    std::vector<point_t> points;
+    size_t cursor = 0;
+};
+
+static void compare(Reference &reference, float level, float noise, int sweep_ms, signal_report_t reports[SIGNALS],
+                    pressure_estimator_t &estimator)
+{
+    std::mt19937 generator(NOISE_SEED);
+    std::normal_distribution<float> gaussian(0.0f, noise > 0.0f ? noise : 1.0f);
+
+    // signals on the 1 ms tick
+    std::vector<float> reference_ticks;
+    std::vector<float> signals[SIGNALS];
+    float sweeps[5] = {0};
+    int sweep_index = 0;
+    float held = 0.0f;
+    int64_t last_sweep_us = -1000000000LL;
+
+    estimator_reset(&estimator);
+    for (int64_t t = reference.begin_us(); t <= reference.end_us(); t += TICK_US) {
+        float truth = reference.at(t);
+        if (t - last_sweep_us >= sweep_ms * 1000LL) {
+            held = truth + (noise > 0.0f ? gaussian(generator) : 0.0f);
+            sweeps[sweep_index] = held;
+            sweep_index = (sweep_index + 1) % 5;
+            estimator_update(&estimator, held, (uint32_t)t);
+            last_sweep_us = t;
+        }
+        reference_ticks.push_back(truth);
+        signals[SIGNAL_HOLD].push_back(held);
+        signals[SIGNAL_MEAN5].push_back((sweeps[0] + sweeps[1] + sweeps[2] + sweeps[3] + sweeps[4]) / 5.0f);
+        signals[SIGNAL_ESTIMATOR].push_back(estimator_pressure(&estimator, (uint32_t)t));
+    }
+
+    size_t n = reference_ticks.size();
+    std::vector<bool> ramp(n, false);
+    size_t span = RAMP_SPAN_MS * 1000 / TICK_US;
+    for (size_t i = span; i + span < n; i++) {
+        ramp[i] = fabsf(reference_ticks[i + span] - reference_ticks[i - span]) / (2 * RAMP_SPAN_MS / 1000.0f) > RAMP_RATE;
+    }
+    size_t reference_crossing = n;
+    for (size_t i = 0; i < n && reference_crossing == n; i++) {
+        if (reference_ticks[i] >= level) reference_crossing = i;
+    }
+
+    for (int s = 0; s < SIGNALS; s++) {
+        const std::vector<float> &signal = signals[s];
+        reports[s].delay_ms = 0;
+        reports[s].error = INFINITY;
+        for (int delay = 0; delay <= MAX_DELAY_MS && (size_t)delay < n; delay++) {
+            double sum = 0.0;
+            size_t count = 0;
+            for (size_t i = delay; i < n; i++) {
+                if (!ramp[i - delay]) continue;
+                double e = signal[i] - reference_ticks[i - delay];
+                sum += e * e;
+                count++;
+            }
+            double rms = count ? sqrt(sum / count) : 0.0;
+            if (rms < reports[s].error) {
+                reports[s].error = rms;
+                reports[s].delay_ms = delay;
+            }
+        }
+
+        double sum = 0.0;
+        size_t count = 0;
+        for (size_t i = reports[s].delay_ms; i < n; i++) {
+            if (ramp[i - reports[s].delay_ms]) continue;
+            double e = signal[i] - reference_ticks[i - reports[s].delay_ms];
+            sum += e * e;
+            count++;
+        }
+        reports[s].plateau_noise = count ? sqrt(sum / count) : 0.0;
+
+        reports[s].crossing_ms = -1;
+        for (size_t i = reference_crossing; i < n; i++) {
+            if (signal[i] >= level) {
+                reports[s].crossing_ms = (double)(i - reference_crossing) * TICK_US / 1000.0;
+                break;
+            }
+        }
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: estimator [--level BAR] [--noise BAR] [--sweep-ms MS] [--csv] trace...\n");
+}
+
+int main(int argc, char **argv)
+{
+    float level = DEFAULT_LEVEL_BAR;
+    float noise = 0.0f;
+    int sweep_ms = DEFAULT_SWEEP_MS;
+    bool csv = false;
+    std::vector<const char *> traces;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--level") && i + 1 < argc) level = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--noise") && i + 1 < argc) noise = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--sweep-ms") && i + 1 < argc) sweep_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else traces.push_back(argv[i]);
+    }
+    if (traces.empty() || sweep_ms <= 0) {
+        usage();
+        return 2;
+    }
+
+    if (csv) printf("trace,signal,delay_ms,ramp_rms_error,plateau_noise,crossing_delay_ms\n");
+
+    int failures = 0;
+    for (const char *path : traces) {
+        std::vector<prb_log_sample_t> trace;
+        if (!load_trace(path, trace)) {
+            fprintf(stderr, "estimator: cannot load trace %s\n", path);
+            failures++;
+            continue;
+        }
+        Reference reference(trace);
+        if (reference.empty()) {
+            fprintf(stderr, "estimator: no ccc_press in %s\n", path);
+            failures++;
+            continue;
+        }
+
+        signal_report_t reports[SIGNALS];
+        pressure_estimator_t estimator;
+        compare(reference, level, noise, sweep_ms, reports, estimator);
+
+        if (!csv) printf("trace: %s (sweep %d ms, noise %.3f bar, level %.1f bar)\n", path,
+                         sweep_ms, noise, level);
+        for (int s = 0; s < SIGNALS; s++) {
+            const signal_report_t &r = reports[s];
+            if (csv) {
+                printf("%s,%s,%d,%.4f,%.4f,%.1f\n", path, signal_names[s], r.delay_ms, r.error, r.plateau_noise, r.crossing_ms);
+            } else {
+                printf("  %-10s delay %4d ms   ramp error %7.4f bar   plateau noise %7.4f bar   crossing ", signal_names[s],
+                       r.delay_ms, r.error, r.plateau_noise);
+                if (r.crossing_ms >= 0) printf("+%.0f ms\n", r.crossing_ms);
+                else printf("never\n");
+            }
+        }
+        if (!csv) printf("  estimator reports noise %.4f bar at end of trace\n", estimator.noise);
+    }
+    return failures ? 1 : 0;
+}
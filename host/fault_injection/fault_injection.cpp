@@ -0,0 +1,461 @@
+/*
+ * File: fault_injection.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Fault injection on the simulated sensor bus and ADC while a recorded trace is replayed
+ *  through PRBComputer (as in replay). For every fault it reports how long the firmware takes
+ *  to notice it:
+ *    - flag:  first time the target sensor is set in memory.sensor_flags (any I2C sensor for
+ *             the multiplexer faults)
+ *    - abort: first time the FSM enters ABORT
+ *  both in ms after the fault started, "-" when it never happens.
+ *
+ *  A fault is written TYPE:TARGET@MS[+MS], start (trace time, ms after the IGNITER command)
+ *  and optional duration (default: until the end of the run):
+ *    - nak, corrupt, stuck, saturate   on ein, ccc, oin     (PTE7300Sim faults)
+ *    - lockup (cleared by RESET), dead  on mux
+ *    - open, short, stuck               on t_oin, t_ein     (ADC input)
+ *    - reset, power                     on prb              (watchdog reset, power cycle; no duration)
+ *  e.g. nak:ccc@5600, lockup:mux@5400+50, open:t_oin@1000, reset:prb@3000
+ *
+ *  Every run starts from a power-on reset. A PRB reset releases the outputs, the PRB is out for
+ *  WARM_BOOT_MS (Teensy start-up before setup()) while the sequence journal is kept in RAM2, then
+ *  a new PRBComputer is set up with the reset cause in SRC_SRSR as in setup(): resumed from the
+ *  journal after a watchdog reset, journal cleared after a power cycle. The resumed state is
+ *  reported after the impulse; a watchdog reset that leaves the run neither passivated nor
+ *  aborted fails it, so does a power cycle that resumes anything.
+ *
+ *  Scenario files hold one fault per line, optionally followed by the maximum accepted
+ *  detection latency in ms ("nak:ccc@5400 300", "-" for none) and the minimum accepted total
+ *  impulse in N.s ("nak:ccc@1000 200 0"), '#' starts a comment. A scenario whose fault is not
+ *  flagged or aborted within its maximum, or that ends below its minimum impulse, fails the run
+ *  (exit code 1), so the detection latencies and the impulse integration of a failed sensor are
+ *  regression-tested like the burn results of replay.
+ *
+ *  Usage: fault_injection [options] trace...
+ *    --fault SPEC        inject this fault (repeatable, one run per fault)
+ *    --scenarios FILE    faults and maximum latencies from FILE
+ *    --random N          N faults of random type, target and start within the sequence
+ *    --seed S            seed of --random (default 1)
+ *    --ignite-at MS      trace time at which the IGNITER command is sent (default 0)
+ *    --csv               one machine-readable line per run
+ *    --ccc-bus           CCC Sensata on its own bus (CCC_WIRE), out of reach of the mux faults
+ */
+
+#include <vector>
+#include <string>
+#include <random>
+#include <memory>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "PRBComputer.h"
+#include "sim/ReplayBench.h"
+#include "common/prb_log.h"
+
+#define STEP_US             1000
+#define SEQUENCE_MAX_MS     120000      // longer than a full ignition + passivation sequence
+#define RANDOM_WINDOW_MS    12000       // random faults start within ignition .. end of burn
+#define SENSOR_NOISE_LSB    1
+#define WARM_BOOT_MS        300         // Teensy 4 start-up before setup() (TEENSY_INIT_USB_DELAY_*)
+
+enum fault_type_t
+{
+    FAULT_NAK,
+    FAULT_CORRUPT,
+    FAULT_STUCK,
+    FAULT_SATURATE,
+    FAULT_LOCKUP,
+    FAULT_DEAD,
+    FAULT_OPEN,
+    FAULT_SHORT,
+    FAULT_RESET,
+    FAULT_POWER,
+    FAULT_TYPES
+};
+
+enum fault_target_t
+{
+    TARGET_EIN,
+    TARGET_CCC,
+    TARGET_OIN,
+    TARGET_MUX,
+    TARGET_T_OIN,
+    TARGET_T_EIN,
+    TARGET_PRB,
+    TARGETS
+};
+
+static const char *const type_names[FAULT_TYPES] = {"nak", "corrupt", "stuck", "saturate", "lockup", "dead", "open", "short", "reset", "power"};
+static const char *const target_names[TARGETS] = {"ein", "ccc", "oin", "mux", "t_oin", "t_ein", "prb"};
+
+typedef struct fault_t
+{
+    fault_type_t type;
+    fault_target_t target;
+    int64_t start_ms;               // after the IGNITER command
+    int64_t duration_ms;            // -1: until the end of the run
+    int64_t max_latency_ms;         // -1: not checked
+    float min_impulse;              // NAN: not checked
+    std::string spec;
+}fault_t;
+
+typedef struct fault_result_t
+{
+    int64_t flag_latency_ms;        // -1: never flagged
+    int64_t abort_latency_ms;       // -1: never aborted
+    bool passivated;
+    PRB_FSM final_state;
+    float engine_total_impulse;
+    bool resumed;                   // reset / power faults: resume() restored a sequence
+    PRB_FSM resumed_state;
+}fault_result_t;
+
+static const char *const fsm_names[] = {"IDLE", "CLEAR_TO_IGNITE", "IGNITION_SQ", "PASSIVATION_SQ", "ABORT", "ERROR"};
+
+static bool valid_pair(fault_type_t type, fault_target_t target)
+{
+    switch (type) {
+    case FAULT_NAK:
+    case FAULT_CORRUPT:
+    case FAULT_SATURATE:
+        return target <= TARGET_OIN;
+    case FAULT_STUCK:
+        return target != TARGET_MUX && target != TARGET_PRB;
+    case FAULT_LOCKUP:
+    case FAULT_DEAD:
+        return target == TARGET_MUX;
+    case FAULT_OPEN:
+    case FAULT_SHORT:
+        return target == TARGET_T_OIN || target == TARGET_T_EIN;
+    case FAULT_RESET:
+    case FAULT_POWER:
+        return target == TARGET_PRB;
+    default:
+        return false;
+    }
+}
+
+static bool parse_fault(const char *spec, fault_t &fault)
+{
+    char type[16], target[16];
+    long long start = 0, duration = -1;
+    int n = sscanf(spec, "%15[a-z]:%15[a-z_]@%lld+%lld", type, target, &start, &duration);
+    if (n < 3) return false;
+
+    int t = 0, g = 0;
+    while (t < FAULT_TYPES && strcmp(type_names[t], type)) t++;
+    while (g < TARGETS && strcmp(target_names[g], target)) g++;
+    if (t == FAULT_TYPES || g == TARGETS || !valid_pair((fault_type_t)t, (fault_target_t)g)) return false;
+
+    fault.type = (fault_type_t)t;
+    fault.target = (fault_target_t)g;
+    fault.start_ms = start;
+    fault.duration_ms = n == 4 ? duration : -1;
+    fault.max_latency_ms = -1;
+    fault.min_impulse = NAN;
+    fault.spec = spec;
+    return true;
+}
+
+static bool load_scenarios(const char *path, std::vector<fault_t> &faults)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    char line[256];
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char spec[128], max_latency[32];
+        float min_impulse = NAN;
+        int n = sscanf(line, "%127s %31s %f", spec, max_latency, &min_impulse);
+        if (n < 1) continue;
+        fault_t fault;
+        if (!parse_fault(spec, fault)) {
+            fprintf(stderr, "fault_injection: bad fault '%s' in %s\n", spec, path);
+            ok = false;
+            continue;
+        }
+        fault.max_latency_ms = n >= 2 && strcmp(max_latency, "-") ? atoll(max_latency) : -1;
+        fault.min_impulse = n == 3 ? min_impulse : NAN;
+        faults.push_back(fault);
+    }
+    fclose(file);
+    return ok;
+}
+
+static uint8_t target_flags(fault_target_t target)
+{
+    switch (target) {
+    case TARGET_EIN: return 1 << SENSOR_EIN;
+    case TARGET_CCC: return 1 << SENSOR_CCC;
+    case TARGET_OIN: return 1 << SENSOR_OIN;
+    case TARGET_MUX: return (1 << SENSOR_EIN) | (1 << SENSOR_CCC) | (1 << SENSOR_OIN);
+    case TARGET_T_OIN: return 1 << SENSOR_T_OIN;
+    case TARGET_T_EIN: return 1 << SENSOR_T_EIN;
+    default: return 0;
+    }
+}
+
+/**
+ * @brief Applies (active) or removes a fault on the simulated front-end.
+ *
+ * The ADC faults are re-applied after every trace row, the stuck ADC value is the one read
+ * when the fault started.
+ */
+class FaultInjector
+{
+public:
+    FaultInjector(ReplayBench &bench_, const fault_t &fault_) : bench(bench_), fault(fault_) {}
+
+    void set(bool active)
+    {
+        if (active == applied) return;
+        applied = active;
+
+        PTE7300Sim *sensor = fault.target == TARGET_EIN ? &bench.ein :
+                             fault.target == TARGET_CCC ? &bench.ccc :
+                             fault.target == TARGET_OIN ? &bench.oin : nullptr;
+        uint8_t pin = fault.target == TARGET_T_OIN ? T_OIN : T_EIN;
+
+        switch (fault.type) {
+        case FAULT_NAK: sensor->set_fault(active ? PTE7300_NAK : PTE7300_HEALTHY); break;
+        case FAULT_CORRUPT: sensor->set_fault(active ? PTE7300_CORRUPT : PTE7300_HEALTHY); break;
+        case FAULT_SATURATE: sensor->set_fault(active ? PTE7300_SATURATED : PTE7300_HEALTHY); break;
+        case FAULT_STUCK:
+            if (sensor) sensor->set_fault(active ? PTE7300_FROZEN : PTE7300_HEALTHY);
+            else stuck_adc = analogRead(pin);
+            break;
+        case FAULT_LOCKUP: bench.mux.set_lockup(active, true); break;
+        case FAULT_DEAD: bench.mux.set_lockup(active, false); break;
+        default: break;
+        }
+    }
+
+    // after the trace rows of this step
+    void hold_inputs()
+    {
+        if (!applied) return;
+        uint8_t pin = fault.target == TARGET_T_OIN ? T_OIN : T_EIN;
+        if (fault.type == FAULT_OPEN) host::set_analog(pin, 4095);
+        else if (fault.type == FAULT_SHORT) host::set_analog(pin, 0);
+        else if (fault.type == FAULT_STUCK && fault.target >= TARGET_T_OIN) host::set_analog(pin, stuck_adc);
+    }
+
+private:
+    ReplayBench &bench;
+    const fault_t &fault;
+    bool applied = false;
+    int stuck_adc = 0;
+};
+
+// the PRB part of setup(), with the reset cause in SRC_SRSR: returns whether a sequence was resumed
+static bool setup_prb(std::unique_ptr<PRBComputer> &computer, TwoWire &ccc_wire)
+{
+    computer.reset(new PRBComputer(IDLE, ccc_wire));
+    outputs_begin();
+    uint32_t reset_cause = SRC_SRSR;
+    SRC_SRSR = reset_cause;
+    bool resumed = computer->resume(reset_cause);
+    digitalWrite(RESET, HIGH); // Activate MUX
+    return resumed;
+}
+
+static fault_result_t run(const std::vector<prb_log_sample_t> &trace, int64_t ignite_at_us, const fault_t &fault,
+                          bool ccc_own_bus)
+{
+    fault_result_t result = {-1, -1, false, IDLE, 0.0f, false, IDLE};
+
+    host::reset();
+    int64_t time_origin_us = trace.front().t_us;
+    int64_t end_us = trace.back().t_us;
+    if (end_us < ignite_at_us + SEQUENCE_MAX_MS * 1000LL) end_us = ignite_at_us + SEQUENCE_MAX_MS * 1000LL;
+    int64_t fault_start_us = ignite_at_us + fault.start_ms * 1000;
+    int64_t fault_end_us = fault.duration_ms < 0 ? INT64_MAX : fault_start_us + fault.duration_ms * 1000;
+
+    ReplayBench bench(ccc_own_bus);
+    // the traces hold the inputs between rows, without dither the stuck check flags a healthy sensor
+    bench.ein.set_noise_lsb(SENSOR_NOISE_LSB);
+    bench.ccc.set_noise_lsb(SENSOR_NOISE_LSB);
+    bench.oin.set_noise_lsb(SENSOR_NOISE_LSB);
+    FaultInjector injector(bench, fault);
+    TwoWire &ccc_wire = ccc_own_bus ? CCC_WIRE : SENSOR_WIRE;
+    std::unique_ptr<PRBComputer> computer;
+    setup_prb(computer, ccc_wire); // power-on (host::reset()): the journal of the previous run is cleared
+    bool prb_reset = fault.type == FAULT_RESET || fault.type == FAULT_POWER;
+
+    size_t cursor = 0;
+    bool ignited = false;
+    uint8_t flags = target_flags(fault.target);
+    int64_t boot_end_us = -1;       // warm reset: time at which setup() runs
+    bool rebooted = false;
+
+    while ((int64_t)host::time_us() + time_origin_us < end_us) {
+        int64_t now = (int64_t)host::time_us() + time_origin_us;
+
+        while (cursor < trace.size() && trace[cursor].t_us <= now) bench.apply(trace[cursor++]);
+        if (prb_reset) {
+            if (boot_end_us < 0 && now >= fault_start_us) {
+                outputs_begin(); // the reset releases the valves
+                host::set_reset_cause(fault.type == FAULT_POWER ? SRC_SRSR_IPP_RESET_B : SRC_SRSR_WDOG_RST_B);
+                boot_end_us = now + WARM_BOOT_MS * 1000LL;
+            }
+            if (boot_end_us >= 0 && now < boot_end_us) {
+                host::advance_us(STEP_US);
+                continue;
+            }
+            if (boot_end_us >= 0 && !rebooted) {
+                result.resumed = setup_prb(computer, ccc_wire);
+                result.resumed_state = computer->get_state();
+                rebooted = true;
+            }
+        } else {
+            injector.set(now >= fault_start_us && now < fault_end_us);
+            injector.hold_inputs();
+        }
+
+        if (!ignited && now >= ignite_at_us) {
+            computer->set_state(CLEAR_TO_IGNITE);
+            computer->ignite(millis());
+            ignited = true;
+        }
+
+        computer->update(millis());
+
+        if (now >= fault_start_us) {
+            int64_t latency_ms = (now - fault_start_us) / 1000;
+            if (result.flag_latency_ms < 0 && (computer->get_memory().sensor_flags & flags)) result.flag_latency_ms = latency_ms;
+            if (result.abort_latency_ms < 0 && computer->get_state() == ABORT) result.abort_latency_ms = latency_ms;
+        }
+        if (ignited && computer->get_state() == PASSIVATION_SQ && computer->get_shutdown_stage() == SLEEP) {
+            result.passivated = true;
+            break;
+        }
+        host::advance_us(STEP_US);
+    }
+
+    result.final_state = computer->get_state();
+    result.engine_total_impulse = computer->get_memory().engine_total_impulse;
+    return result;
+}
+
+static void print_latency(int64_t latency_ms)
+{
+    if (latency_ms < 0) printf(" %9s", "-");
+    else printf(" %9lld", (long long)latency_ms);
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: fault_injection [--fault SPEC]... [--scenarios FILE] [--random N] [--seed S] "
+                    "[--ignite-at MS] [--csv] [--ccc-bus] trace...\n"
+                    "  SPEC = TYPE:TARGET@MS[+MS], e.g. nak:ccc@5600, lockup:mux@5400+50, open:t_oin@1000\n");
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<fault_t> faults;
+    std::vector<const char *> traces;
+    int random_faults = 0;
+    unsigned seed = 1;
+    int64_t ignite_at_us = 0;
+    bool csv = false;
+    bool ccc_own_bus = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--fault") && i + 1 < argc) {
+            fault_t fault;
+            if (!parse_fault(argv[++i], fault)) {
+                fprintf(stderr, "fault_injection: bad fault '%s'\n", argv[i]);
+                return 2;
+            }
+            faults.push_back(fault);
+        }
+        else if (!strcmp(argv[i], "--scenarios") && i + 1 < argc) {
+            if (!load_scenarios(argv[++i], faults)) {
+                fprintf(stderr, "fault_injection: cannot load scenarios %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (!strcmp(argv[i], "--random") && i + 1 < argc) random_faults = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) seed = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--ignite-at") && i + 1 < argc) ignite_at_us = atoll(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (!strcmp(argv[i], "--ccc-bus")) ccc_own_bus = true;
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else traces.push_back(argv[i]);
+    }
+
+    std::mt19937 generator(seed);
+    for (int i = 0; i < random_faults; i++) {
+        fault_t fault;
+        do {
+            fault.type = (fault_type_t)(generator() % FAULT_TYPES);
+            fault.target = (fault_target_t)(generator() % TARGETS);
+        } while (!valid_pair(fault.type, fault.target));
+        fault.start_ms = generator() % RANDOM_WINDOW_MS;
+        fault.duration_ms = -1;
+        fault.max_latency_ms = -1;
+        fault.min_impulse = NAN;
+        fault.spec = std::string(type_names[fault.type]) + ":" + target_names[fault.target] + "@" + std::to_string(fault.start_ms);
+        faults.push_back(fault);
+    }
+
+    if (traces.empty() || faults.empty()) {
+        usage();
+        return 2;
+    }
+
+    if (csv) printf("trace,fault,flag_latency_ms,abort_latency_ms,max_latency_ms,result,final_state,engine_total_impulse\n");
+
+    int failures = 0;
+    for (const char *path : traces) {
+        std::vector<prb_log_sample_t> trace;
+        if (!load_trace(path, trace) || trace.empty()) {
+            fprintf(stderr, "fault_injection: cannot load trace %s\n", path);
+            failures++;
+            continue;
+        }
+        if (!csv) {
+            printf("trace: %s\n", path);
+            printf("  %-26s %9s %9s %9s  %-11s %s\n", "fault", "flag_ms", "abort_ms", "max_ms", "result", "impulse");
+        }
+
+        for (const fault_t &fault : faults) {
+            fault_result_t r = run(trace, ignite_at_us, fault, ccc_own_bus);
+            const char *outcome = r.abort_latency_ms >= 0 ? "ABORTED" : (r.passivated ? "PASSIVATED" : "INCOMPLETE");
+
+            int64_t detected_ms = r.flag_latency_ms;
+            if (r.abort_latency_ms >= 0 && (detected_ms < 0 || r.abort_latency_ms < detected_ms)) detected_ms = r.abort_latency_ms;
+            bool late = fault.max_latency_ms >= 0 && (detected_ms < 0 || detected_ms > fault.max_latency_ms);
+            if (late) failures++;
+            // a power cycle must not resume the journal of before (valves re-driven on stale state)
+            bool unsafe = (fault.type == FAULT_RESET && r.abort_latency_ms < 0 && !r.passivated) ||
+                          (fault.type == FAULT_POWER && r.resumed);
+            if (unsafe) failures++;
+            bool low = r.engine_total_impulse < fault.min_impulse; // false for NAN
+            if (low) failures++;
+
+            if (csv) {
+                printf("%s,%s,%lld,%lld,%lld,%s,%s,%.3f\n", path, fault.spec.c_str(), (long long)r.flag_latency_ms,
+                       (long long)r.abort_latency_ms, (long long)fault.max_latency_ms, outcome,
+                       fsm_names[r.final_state], r.engine_total_impulse);
+            } else {
+                printf("  %-26s", fault.spec.c_str());
+                print_latency(r.flag_latency_ms);
+                print_latency(r.abort_latency_ms);
+                print_latency(fault.max_latency_ms);
+                printf("  %-11s %.1f%s%s", outcome, r.engine_total_impulse, late ? "  LATE" : "", low ? "  LOW IMPULSE" : "");
+                if (fault.type == FAULT_RESET || fault.type == FAULT_POWER) {
+                    printf("  resumed %s%s", r.resumed ? fsm_names[r.resumed_state] : "nothing", unsafe ? "  UNSAFE" : "");
+                }
+                printf("\n");
+            }
+        }
+    }
+    return failures ? 1 : 0;
+}
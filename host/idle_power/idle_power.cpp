@@ -0,0 +1,255 @@
+/*
+ * File: idle_power.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Idle power mode of the flight firmware (idle_sleep in the build profile). Runs main.cpp
+ *  (setup(), loop() and the Wire1 handlers) built with the hot_fire profile on the simulated
+ *  sensors, and plays countdown holds against it: --hold-s in IDLE with the master polling a
+ *  telemetry value at --poll-hz, CLEAR_TO_IGNITE for --armed-s, then ABORT and RESET back to
+ *  IDLE, --cycles times. The master commands run as interrupts of the virtual clock
+ *  (host::set_irq_hook), so they wake the core from WFI as on the Teensy.
+ *
+ *  For every cycle the tool reports:
+ *    - the awake duty cycle in IDLE and in CLEAR_TO_IGNITE, mean of the loop-time reports of
+ *      the PRB (awake_duty, sent in TLM_POWER) over the phase, its first report left out
+ *    - loop() calls per second in IDLE
+ *    - the share of the hold the Sensatas spent in sleep mode, and the sensor bus transfers
+ *      per second in IDLE
+ *    - the Sensata wake-up latency, from the CLEAR_TO_IGNITE command to a new sample on every
+ *      Sensata channel, as measured by the PRB (wake_latency_us) and as seen on fresh_samples
+ *
+ *  Usage: idle_power [--hold-s S] [--armed-s S] [--cycles N] [--poll-hz HZ]
+ *                    [--conversion-us US] [--startup-us US] [--csv]
+ */
+
+#include <deque>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "PRBComputer.h"
+#include "sim/ReplayBench.h"
+
+#define WARMUP_MS           4000        // past the start-up schedule and show before the first hold
+#define STEP_US             10          // foreground time of one loop() call
+#define ISR_US              5           // Wire1 handler of one transfer
+#define RESET_DELAY_MS      100         // ABORT to RESET of the master
+
+// main.cpp
+void setup();
+void loop();
+extern PRBComputer computer;
+
+typedef struct power_config_t
+{
+    double hold_s;
+    double armed_s;
+    int cycles;
+    double poll_hz;
+    uint32_t conversion_us;         // PTE7300 continuous conversion period
+    uint32_t startup_us;            // PTE7300 start-up after RESET
+}power_config_t;
+
+// one master write, at its time on the virtual clock
+typedef struct command_t
+{
+    uint64_t t_us;
+    uint8_t data[1 + AV_NET_XFER_SIZE];
+    uint8_t length;
+}command_t;
+
+static struct master_t
+{
+    uint64_t poll_period_us;        // 0: no polls
+    uint64_t next_poll_us;
+    std::deque<command_t> commands; // in time order
+}master;
+
+static uint64_t next_master_event()
+{
+    uint64_t next = master.poll_period_us ? master.next_poll_us : UINT64_MAX;
+    if (!master.commands.empty() && master.commands.front().t_us < next) next = master.commands.front().t_us;
+    return next;
+}
+
+// interrupt source of the host clock: the master polls and commands as they come due
+static uint64_t master_irq(uint64_t now_us)
+{
+    while (next_master_event() <= host::time_us()) {
+        if (!master.commands.empty() && master.commands.front().t_us <= host::time_us()) {
+            command_t command = master.commands.front();
+            master.commands.pop_front();
+            Wire1.slave_receive(command.data, command.length);
+        } else {
+            uint8_t cmd = AV_NET_PRB_P_CCC;
+            uint8_t response[AV_NET_XFER_SIZE];
+            Wire1.slave_receive(&cmd, 1);
+            Wire1.slave_request(response, sizeof(response));
+            master.next_poll_us += master.poll_period_us;
+        }
+        host::advance_us(ISR_US);
+    }
+    return next_master_event();
+}
+
+static void send(uint64_t t_us, uint8_t cmd, uint8_t d0 = 0)
+{
+    master.commands.push_back({t_us, {cmd, d0, 0, 0, 0}, 1 + AV_NET_XFER_SIZE});
+    host::set_irq_hook(master_irq, next_master_event());
+}
+
+typedef struct phase_report_t
+{
+    uint64_t loops;
+    uint32_t duty_sum;              // awake_duty of the reports [0.1 %]
+    uint32_t reports;
+    uint64_t sensata_sleep_us;      // summed over the three sensors
+    uint64_t transfers;             // PTE7300 register reads and writes
+}phase_report_t;
+
+typedef struct cycle_report_t
+{
+    phase_report_t idle;
+    phase_report_t armed;
+    int32_t wake_prb_us;            // wake_latency_us of the PRB, -1 not woken
+    int64_t wake_seen_us;           // arm command to a new sample on every Sensata channel, -1 never
+}cycle_report_t;
+
+static uint64_t bus_transfers(ReplayBench &bench)
+{
+    uint64_t total = 0;
+    for (PTE7300Sim *sensor : {&bench.ein, &bench.ccc, &bench.oin}) total += sensor->stats().reads + sensor->stats().writes;
+    return total;
+}
+
+// runs loop() up to end_us; wake_pending: Sensata channels without a new sample since the arm command
+static void run_until(uint64_t end_us, ReplayBench &bench, phase_report_t *report, uint8_t *wake_pending, uint64_t arm_us,
+                      int64_t *wake_seen_us)
+{
+    uint64_t transfers = bus_transfers(bench);
+    int last_print = computer.get_status().time_print;
+    bool first_report = true;
+
+    while (host::time_us() < end_us) {
+        uint64_t start = host::time_us();
+        bool asleep[3];
+        int i = 0;
+        for (PTE7300Sim *sensor : {&bench.ein, &bench.ccc, &bench.oin}) asleep[i++] = sensor->mode() == PTE7300_SLEEP;
+
+        loop();
+        host::advance_us(STEP_US);
+        report->loops++;
+
+        for (i = 0; i < 3; i++) {
+            if (asleep[i]) report->sensata_sleep_us += host::time_us() - start;
+        }
+        const prb_status_t &status = computer.get_status();
+        if (status.time_print != last_print) {
+            last_print = status.time_print;
+            if (!first_report) {
+                report->duty_sum += status.awake_duty;
+                report->reports++;
+            }
+            first_report = false;
+        }
+        if (*wake_pending) {
+            *wake_pending &= ~computer.get_memory().fresh_samples;
+            if (!*wake_pending) *wake_seen_us = (int64_t)(host::time_us() - arm_us);
+        }
+    }
+    report->transfers += bus_transfers(bench) - transfers;
+}
+
+static cycle_report_t run_cycle(const power_config_t &config, ReplayBench &bench)
+{
+    cycle_report_t report = {};
+    report.wake_prb_us = -1;
+    report.wake_seen_us = -1;
+    uint8_t none = 0;
+
+    uint64_t arm_us = host::time_us() + (uint64_t)(config.hold_s * 1e6);
+    send(arm_us, AV_NET_PRB_CLEAR_TO_IGNITE, AV_NET_CMD_ON);
+    run_until(arm_us, bench, &report.idle, &none, 0, nullptr);
+
+    uint8_t wake_pending = (1 << TLM_CCC_PRESS) | (1 << TLM_EIN_PRESS) | (1 << TLM_CCC_TEMP) |
+                           (1 << TLM_EIN_TEMP_SENSATA) | (1 << TLM_OIN_PRESS);
+    uint64_t abort_us = arm_us + (uint64_t)(config.armed_s * 1e6);
+    send(abort_us, AV_NET_PRB_ABORT, AV_NET_CMD_OFF);
+    send(abort_us + RESET_DELAY_MS * 1000, AV_NET_PRB_RESET);
+    run_until(abort_us, bench, &report.armed, &wake_pending, arm_us, &report.wake_seen_us);
+    if (computer.get_status().sensata_waking == 0) report.wake_prb_us = computer.get_status().wake_latency_us;
+
+    // back in IDLE for the next hold
+    phase_report_t reset = {};
+    run_until(abort_us + 2 * RESET_DELAY_MS * 1000, bench, &reset, &none, 0, nullptr);
+    return report;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: idle_power [--hold-s S] [--armed-s S] [--cycles N] [--poll-hz HZ] [--conversion-us US] "
+                    "[--startup-us US] [--csv]\n");
+}
+
+int main(int argc, char **argv)
+{
+    power_config_t config = {30.0, 5.0, 3, 10.0, 1000, 2000};
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--hold-s") && i + 1 < argc) config.hold_s = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--armed-s") && i + 1 < argc) config.armed_s = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--cycles") && i + 1 < argc) config.cycles = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--poll-hz") && i + 1 < argc) config.poll_hz = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--conversion-us") && i + 1 < argc) config.conversion_us = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--startup-us") && i + 1 < argc) config.startup_us = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else { usage(); return 2; }
+    }
+    if (config.hold_s <= 0 || config.armed_s <= 0 || config.cycles <= 0 || config.poll_hz < 0) {
+        usage();
+        return 2;
+    }
+
+    // the firmware as flashed, sensors at rest
+    host::reset();
+    ReplayBench bench;
+    prb_log_sample_t rest = {0, {0.0f, 45.0f, 20.0f, 15.0f, -180.0f, 15.0f, 40.0f}};
+    bench.apply(rest);
+    for (PTE7300Sim *sensor : {&bench.ein, &bench.ccc, &bench.oin}) {
+        sensor->set_conversion_period_us(config.conversion_us);
+        sensor->set_startup_us(config.startup_us);
+    }
+    setup();
+
+    master.poll_period_us = config.poll_hz > 0 ? (uint64_t)(1e6 / config.poll_hz) : 0;
+    master.next_poll_us = host::time_us() + master.poll_period_us;
+    host::set_irq_hook(master_irq, next_master_event());
+    phase_report_t warmup = {};
+    uint8_t none = 0;
+    run_until(WARMUP_MS * 1000, bench, &warmup, &none, 0, nullptr);
+
+    if (csv) printf("cycle,idle_awake_pct,armed_awake_pct,idle_loops_per_s,sensata_asleep_pct,idle_transfers_per_s,"
+                    "wake_prb_us,wake_seen_us\n");
+    else printf("  cycle  awake idle / armed [%%]  loops/s idle  Sensatas asleep [%%]  bus transfers/s idle  wake-up PRB / seen [us]\n");
+
+    for (int cycle = 0; cycle < config.cycles; cycle++) {
+        cycle_report_t r = run_cycle(config, bench);
+        double idle_duty = r.idle.reports ? r.idle.duty_sum / 10.0 / r.idle.reports : NAN;
+        double armed_duty = r.armed.reports ? r.armed.duty_sum / 10.0 / r.armed.reports : NAN;
+        double asleep = 100.0 * r.idle.sensata_sleep_us / (3 * config.hold_s * 1e6);
+
+        if (csv) {
+            printf("%d,%.2f,%.2f,%.1f,%.2f,%.1f,%d,%lld\n", cycle, idle_duty, armed_duty, r.idle.loops / config.hold_s, asleep,
+                   r.idle.transfers / config.hold_s, r.wake_prb_us, (long long)r.wake_seen_us);
+        } else {
+            printf("  %5d  %10.2f / %-9.2f  %12.1f  %19.2f  %20.1f  %10d / %lld\n", cycle, idle_duty, armed_duty,
+                   r.idle.loops / config.hold_s, asleep, r.idle.transfers / config.hold_s, r.wake_prb_us,
+                   (long long)r.wake_seen_us);
+        }
+    }
+    host::set_irq_hook(nullptr, 0);
+    return 0;
+}
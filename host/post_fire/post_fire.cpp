@@ -0,0 +1,415 @@
+/*
+ * File: post_fire.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Offline post-fire analysis of .prbl logs. The logs are memory-mapped and the columns are
+ *  scanned in place (no copy, no parsing), so multi-gigabyte bench-campaign logs are processed
+ *  at disk speed. Every fire found in a log is reported with:
+ *    - rise time (10% to 90% of the peak) and peak chamber pressure
+ *    - the ramp-up check as done in BURN: CCC pressure (estimated, or 5-sample mean, as in the
+ *      build profile) RAMPUP_DURATION after ME_b opening against RAMP_UP_CHECK_PRESSURE
+ *    - the chamber pressure integral and impulse, recomputed with the constant.h engine
+ *      parameters (I_SP, G, AREA_THROAT, C_STAR) and the same rectangle rule as the firmware
+ *    - the cutoff the firmware would command (I_TARGET reached, within MIN/MAX_BURN_TIME),
+ *      and the actual cutoff (MO_bC closing) when the log has valve events
+ *
+ *  Fires are delimited by the ME_b / MO_bC valve events when the log has them (telemetry logs),
+ *  otherwise by the CCC pressure crossing --threshold. Idle row groups are discarded with a
+ *  vectorised max scan of the ccc_press column before any per-row work.
+ *
+ *  Usage: post_fire [options] log.prbl...
+ *    --threshold BAR     CCC pressure delimiting a fire without valve events (default 2)
+ *    --ramp-up-bar BAR   ramp-up check pressure (default RAMP_UP_CHECK_PRESSURE)
+ *    --csv               one machine-readable line per fire
+ */
+
+#include <vector>
+#include <chrono>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "constant.h"
+#include "PressureEstimator.h"
+#include "common/prb_log.h"
+
+#define DEFAULT_THRESHOLD_BAR   2.0f
+#define END_HYSTERESIS          0.5f        // a pressure-delimited fire ends below threshold * 0.5
+#define SCAN_BLOCK              256         // rows per block of the vectorised scans
+#define RAMP_UP_MEAN_SAMPLES    5           // same window as ccc_press_buffer
+
+// integral of the chamber pressure at which BURN commands the cutoff [Pa.s]
+static const double integral_target = (I_TARGET * C_STAR) / (I_SP * G * AREA_THROAT);
+
+typedef struct fire_window_t
+{
+    int64_t start_us;               // ME_b opening, or pressure rising above the threshold
+    int64_t cutoff_us;              // MO_bC closing, -1 when unknown
+    int64_t end_us;                 // end of the samples belonging to the fire
+}fire_window_t;
+
+typedef struct fire_sample_t
+{
+    int64_t t_us;
+    float ccc_press;
+}fire_sample_t;
+
+typedef struct fire_report_t
+{
+    int64_t start_us;
+    double rise_time_ms;            // 10% to 90% of the peak, -1 if not reached
+    float peak_press;
+    double peak_time_ms;            // from start
+    float ramp_up_mean;             // NAN when no sample before the check
+    bool ramp_up_ok;
+    double predicted_cutoff_ms;     // firmware cutoff from the log, -1 if never reached
+    bool target_reached;            // false when the cutoff comes from MAX_BURN_TIME
+    double actual_cutoff_ms;        // from the valve events, -1 if unknown
+    double impulse_at_cutoff;       // [N.s] up to the actual (else predicted) cutoff
+    double impulse_total;           // [N.s] whole fire, tail-off included
+}fire_report_t;
+
+// ========= vectorised column scans =========
+// Written as plain reductions without early exit so the compiler turns them into SIMD loops.
+// NAN rows (channel not acquired) compare false and are ignored.
+
+static float column_max(const float *column, size_t rows)
+{
+    float max = -INFINITY;
+    for (size_t i = 0; i < rows; i++) max = column[i] > max ? column[i] : max;
+    return max;
+}
+
+static float column_min(const float *column, size_t rows)
+{
+    float min = INFINITY;
+    for (size_t i = 0; i < rows; i++) min = column[i] < min ? column[i] : min;
+    return min;
+}
+
+// first row at or above the level, rows if none; whole blocks are skipped on their max
+static size_t first_above(const float *column, size_t begin, size_t rows, float level)
+{
+    size_t i = begin;
+    while (i < rows) {
+        size_t block = rows - i < SCAN_BLOCK ? rows - i : SCAN_BLOCK;
+        if (column_max(column + i, block) >= level) {
+            for (size_t j = i; j < i + block; j++) {
+                if (column[j] >= level) return j;
+            }
+        }
+        i += block;
+    }
+    return rows;
+}
+
+// first row strictly below the level, rows if none; whole blocks are skipped on their min
+static size_t first_below(const float *column, size_t begin, size_t rows, float level)
+{
+    size_t i = begin;
+    while (i < rows) {
+        size_t block = rows - i < SCAN_BLOCK ? rows - i : SCAN_BLOCK;
+        if (column_min(column + i, block) < level) {
+            for (size_t j = i; j < i + block; j++) {
+                if (column[j] < level) return j;
+            }
+        }
+        i += block;
+    }
+    return rows;
+}
+
+// ========= fire delimitation =========
+/**
+ * @brief Builds the fire windows from the valve events: ME_b opening to ME_b closing.
+ */
+static std::vector<fire_window_t> windows_from_events(PRBLogReader &reader)
+{
+    std::vector<fire_window_t> windows;
+    fire_window_t current = {-1, -1, -1};
+    bool mo_open = false;
+    prb_log_events_view_t view;
+
+    // a fire opens ME_b with MO_bC already open (BURN_START_MO then BURN_START_ME);
+    // the passivation opens ME_b alone
+    reader.rewind();
+    while (reader.next_events(&view)) {
+        for (uint32_t r = 0; r < view.rows; r++) {
+            if (view.kind[r] != LOG_EVENT_VALVE) continue;
+            uint8_t pin = view.args[0][r];
+            uint8_t level = view.args[1][r];
+            if (pin == MO_bC) {
+                if (level == LOW && mo_open && current.start_us >= 0 && current.cutoff_us < 0) current.cutoff_us = view.t_us[r];
+                mo_open = (level == HIGH);
+            } else if (pin == ME_b && level == HIGH && mo_open && current.start_us < 0) {
+                current.start_us = view.t_us[r];
+            } else if (pin == ME_b && level == LOW && current.start_us >= 0) {
+                current.end_us = view.t_us[r];
+                windows.push_back(current);
+                current = {-1, -1, -1};
+            }
+        }
+    }
+    if (current.start_us >= 0) {
+        current.end_us = INT64_MAX;     // log ends during the fire
+        windows.push_back(current);
+    }
+    return windows;
+}
+
+/**
+ * @brief Collects the valid CCC pressure samples of every window, skipping the groups outside.
+ *
+ * Each fire starts with the pressure held by the firmware at the window start (latest sample
+ * before it), as integrate_chamber_pressure() uses it from the first BURN tick.
+ */
+static void collect_windows(PRBLogReader &reader, const std::vector<fire_window_t> &windows,
+                            std::vector<std::vector<fire_sample_t>> &fires)
+{
+    fires.assign(windows.size(), std::vector<fire_sample_t>());
+    if (windows.empty()) return;
+
+    size_t w = 0;
+    float held = NAN;
+    prb_log_samples_view_t view;
+    reader.rewind();
+    while (w < windows.size() && reader.next_samples(&view)) {
+        const float *press = view.columns[LOG_CCC_PRESS];
+        if (view.rows == 0) continue;
+        if (view.t_us[view.rows - 1] < windows[w].start_us) {
+            // idle group: only the latest valid value matters
+            for (uint32_t r = view.rows; r-- > 0;) {
+                if (press[r] == press[r]) {
+                    held = press[r];
+                    break;
+                }
+            }
+            continue;
+        }
+
+        for (uint32_t r = 0; r < view.rows && w < windows.size(); r++) {
+            int64_t t = view.t_us[r];
+            while (w < windows.size() && t > windows[w].end_us) w++;
+            if (w >= windows.size()) break;
+            if (press[r] != press[r]) continue;
+            if (t >= windows[w].start_us) {
+                if (fires[w].empty() && t > windows[w].start_us && held == held) fires[w].push_back({windows[w].start_us, held});
+                fires[w].push_back({t, press[r]});
+            }
+            held = press[r];
+        }
+    }
+}
+
+/**
+ * @brief Delimits the fires on the CCC pressure alone and collects their samples.
+ *
+ * A fire starts on the first sample at or above the threshold and ends on the first sample
+ * below threshold * END_HYSTERESIS. Both searches are block scans, so idle groups cost one
+ * SIMD max reduction.
+ */
+static void collect_by_pressure(PRBLogReader &reader, float threshold, std::vector<fire_window_t> &windows,
+                                std::vector<std::vector<fire_sample_t>> &fires)
+{
+    bool in_fire = false;
+    prb_log_samples_view_t view;
+
+    reader.rewind();
+    while (reader.next_samples(&view)) {
+        const float *press = view.columns[LOG_CCC_PRESS];
+        size_t r = 0;
+        while (r < view.rows) {
+            if (!in_fire) {
+                r = first_above(press, r, view.rows, threshold);
+                if (r >= view.rows) break;
+                windows.push_back({view.t_us[r], -1, INT64_MAX});
+                fires.push_back(std::vector<fire_sample_t>());
+                in_fire = true;
+            }
+            size_t end = first_below(press, r, view.rows, threshold * END_HYSTERESIS);
+            std::vector<fire_sample_t> &samples = fires.back();
+            for (size_t i = r; i < end; i++) {
+                if (press[i] == press[i]) samples.push_back({view.t_us[i], press[i]});
+            }
+            if (end < view.rows) {
+                windows.back().end_us = view.t_us[end];
+                in_fire = false;
+            }
+            r = end;
+        }
+    }
+}
+
+// ========= analysis =========
+static double impulse_of(double integral) { return I_SP * G * (AREA_THROAT / C_STAR) * integral; }
+
+/**
+ * @brief Reproduces the BURN phase on the samples of one fire.
+ */
+static fire_report_t analyse(const fire_window_t &window, const std::vector<fire_sample_t> &samples,
+                             float ramp_up_bar)
+{
+    fire_report_t report;
+    report.start_us = window.start_us;
+    report.rise_time_ms = -1;
+    report.peak_press = NAN;
+    report.peak_time_ms = -1;
+    report.ramp_up_mean = NAN;
+    report.ramp_up_ok = false;
+    report.predicted_cutoff_ms = -1;
+    report.target_reached = false;
+    report.actual_cutoff_ms = window.cutoff_us >= 0 ? (window.cutoff_us - window.start_us) / 1000.0 : -1;
+    report.impulse_at_cutoff = 0;
+    report.impulse_total = 0;
+    if (samples.empty()) return report;
+
+    size_t peak = 0;
+    for (size_t i = 1; i < samples.size(); i++) {
+        if (samples[i].ccc_press > samples[peak].ccc_press) peak = i;
+    }
+    report.peak_press = samples[peak].ccc_press;
+    report.peak_time_ms = (samples[peak].t_us - window.start_us) / 1000.0;
+
+    int64_t t10 = -1;
+    for (size_t i = 0; i <= peak; i++) {
+        if (t10 < 0 && samples[i].ccc_press >= 0.1f * report.peak_press) t10 = samples[i].t_us;
+        if (samples[i].ccc_press >= 0.9f * report.peak_press) {
+            report.rise_time_ms = (samples[i].t_us - t10) / 1000.0;
+            break;
+        }
+    }
+
+    // ramp-up check when RAMPUP_DURATION has elapsed, on the same pressure as the firmware of
+    // this build profile: the estimate at the check, or the mean of the last samples
+    int64_t check_us = window.start_us + RAMPUP_DURATION * 1000LL;
+    size_t check = 0;
+    while (check < samples.size() && samples[check].t_us <= check_us) check++;
+    if (check > 0) {
+        if constexpr (PROFILE.pressure_estimator) {
+            pressure_estimator_t estimator;
+            estimator_reset(&estimator);
+            for (size_t i = 0; i < check; i++) estimator_update(&estimator, samples[i].ccc_press, (uint32_t)samples[i].t_us);
+            report.ramp_up_mean = estimator_pressure(&estimator, (uint32_t)check_us);
+        } else {
+            size_t n = check < RAMP_UP_MEAN_SAMPLES ? check : RAMP_UP_MEAN_SAMPLES;
+            float sum = 0.0f;
+            for (size_t i = check - n; i < check; i++) sum += samples[i].ccc_press;
+            report.ramp_up_mean = sum / n;
+        }
+        report.ramp_up_ok = report.ramp_up_mean >= ramp_up_bar;
+    }
+
+    // integral in Pa.s: integrate_chamber_pressure() holds the latest sample over each tick,
+    // so between two samples the integral grows linearly and the cutoff tick is interpolated
+    int64_t min_us = window.start_us + MIN_BURN_TIME * 1000LL;
+    int64_t max_us = window.start_us + MAX_BURN_TIME * 1000LL;
+    int64_t target_us = -1;
+    double integral = 0.0;
+    for (size_t i = 0; i + 1 < samples.size(); i++) {
+        double rate = samples[i].ccc_press * 1e5;       // Pa.s per s
+        double step = rate * (samples[i + 1].t_us - samples[i].t_us) / 1e6;
+        if (target_us < 0 && integral + step >= integral_target && rate > 0) {
+            target_us = samples[i].t_us + (int64_t)((integral_target - integral) / rate * 1e6);
+        }
+        integral += step;
+    }
+    report.impulse_total = impulse_of(integral);
+
+    if (target_us >= 0 || samples.back().t_us >= max_us) {
+        int64_t predicted_us = target_us > min_us ? target_us : min_us;
+        report.target_reached = (target_us >= 0 && predicted_us < max_us);
+        if (predicted_us > max_us) predicted_us = max_us;
+        report.predicted_cutoff_ms = (predicted_us - window.start_us) / 1000.0;
+    }
+
+    int64_t cutoff_us = window.cutoff_us >= 0 ? window.cutoff_us :
+                        (report.predicted_cutoff_ms >= 0 ? window.start_us + (int64_t)(report.predicted_cutoff_ms * 1000) : INT64_MAX);
+    integral = 0.0;
+    for (size_t i = 0; i + 1 < samples.size() && samples[i].t_us < cutoff_us; i++) {
+        int64_t next_us = samples[i + 1].t_us < cutoff_us ? samples[i + 1].t_us : cutoff_us;
+        integral += samples[i].ccc_press * 1e5 * (next_us - samples[i].t_us) / 1e6;
+    }
+    report.impulse_at_cutoff = impulse_of(integral);
+    return report;
+}
+
+// ========= report =========
+static void print_report(const char *path, int index, const fire_report_t &r, bool csv)
+{
+    if (csv) {
+        printf("%s,%d,%.3f,%.1f,%.3f,%.1f,%.3f,%s,%.1f,%s,%.1f,%.3f,%.3f\n", path, index, r.start_us / 1e6,
+               r.rise_time_ms, r.peak_press, r.peak_time_ms, r.ramp_up_mean, r.ramp_up_ok ? "GO" : "NOGO",
+               r.predicted_cutoff_ms, r.target_reached ? "I_TARGET" : "MAX_BURN_TIME", r.actual_cutoff_ms,
+               r.impulse_at_cutoff, r.impulse_total);
+        return;
+    }
+    printf("%s  fire %d at %.3f s\n", path, index, r.start_us / 1e6);
+    if (r.rise_time_ms >= 0) printf("  rise time       : %.1f ms (10-90%% of peak)\n", r.rise_time_ms);
+    else printf("  rise time       : -\n");
+    printf("  peak pressure   : %.3f bar at %.1f ms\n", r.peak_press, r.peak_time_ms);
+    printf("  ramp-up check   : %.3f bar at %d ms -> %s\n", r.ramp_up_mean, RAMPUP_DURATION, r.ramp_up_ok ? "GO" : "NOGO");
+    if (r.predicted_cutoff_ms >= 0) {
+        printf("  cutoff (model)  : %.1f ms (%s)\n", r.predicted_cutoff_ms, r.target_reached ? "I_TARGET" : "MAX_BURN_TIME");
+    } else {
+        printf("  cutoff (model)  : not reached\n");
+    }
+    if (r.actual_cutoff_ms >= 0) printf("  cutoff (MO_bC)  : %.1f ms\n", r.actual_cutoff_ms);
+    printf("  impulse         : %.3f N.s at cutoff, %.3f N.s total (target %.3f)\n", r.impulse_at_cutoff,
+           r.impulse_total, (double)I_TARGET);
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: post_fire [--threshold BAR] [--ramp-up-bar BAR] [--csv] log.prbl...\n");
+}
+
+int main(int argc, char **argv)
+{
+    float threshold = DEFAULT_THRESHOLD_BAR;
+    float ramp_up_bar = RAMP_UP_CHECK_PRESSURE;
+    bool csv = false;
+    std::vector<const char *> logs;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--threshold") && i + 1 < argc) threshold = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--ramp-up-bar") && i + 1 < argc) ramp_up_bar = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else logs.push_back(argv[i]);
+    }
+    if (logs.empty() || threshold <= 0.0f) {
+        usage();
+        return 2;
+    }
+
+    if (csv) {
+        printf("log,fire,start_s,rise_time_ms,peak_press,peak_time_ms,ramp_up_mean,ramp_up,"
+               "predicted_cutoff_ms,cutoff_reason,actual_cutoff_ms,impulse_at_cutoff,impulse_total\n");
+    }
+
+    int failures = 0;
+    for (const char *path : logs) {
+        PRBLogReader reader;
+        if (!reader.open(path)) {
+            fprintf(stderr, "post_fire: cannot open %s (not a .prbl log?)\n", path);
+            failures++;
+            continue;
+        }
+        auto wall_start = std::chrono::steady_clock::now();
+
+        std::vector<fire_window_t> windows = windows_from_events(reader);
+        std::vector<std::vector<fire_sample_t>> fires;
+        if (!windows.empty()) collect_windows(reader, windows, fires);
+        else collect_by_pressure(reader, threshold, windows, fires);
+
+        for (size_t f = 0; f < windows.size(); f++) {
+            print_report(path, (int)f + 1, analyse(windows[f], fires[f], ramp_up_bar), csv);
+        }
+
+        double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+        fprintf(stderr, "%s: %zu fire(s), %.1f MB in %.3f s (%.0f MB/s)\n", path, windows.size(),
+                reader.size() / 1e6, wall_s, wall_s > 0 ? reader.size() / 1e6 / wall_s : 0.0);
+    }
+    return failures ? 1 : 0;
+}
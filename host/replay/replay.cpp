@@ -0,0 +1,443 @@
+/*
+ * File: replay.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Sensor recording replay harness. Streams recorded hot-fire traces (CSV or .prbl) into the
+ *  PRBComputer sensor inputs through the simulated sensor bus and analog pins, drives update()
+ *  in virtual time and reports, for every trace:
+ *    - the valve / igniter edge timeline
+ *    - the burn time (ME_b opening to MO_bC cutoff)
+ *    - the final engine_total_impulse
+ *    - the longest and total time spent with interrupts masked (I2C slave blocked)
+ *    - the number of writes to the valve, igniter and LED pins, and how many were edges
+ *    - with --rates, the achieved sample rate of every channel in each phase of the sensor
+ *      schedule (new samples only), and the time of the first new sample of each channel after
+ *      the reset (PRBComputer constructed at virtual time 0)
+ *    - with --drain-ms, the trace the master rebuilds by draining the sample FIFO
+ *      (PRB_NET_SAMPLES) every MS: samples recovered, lost to overflows and wrong values
+ *    - with --timestamp-ms, the error of the master clock estimate (ClockSync) at the end of
+ *      the run, the master sending AV_NET_PRB_TIMESTAMP every MS from a clock MASTER_DRIFT_PPM
+ *      fast
+ *
+ *  With --plant the sensors are not read from a trace but computed by the engine plant model
+ *  (sim/EnginePlant.h) from the valve and igniter pins, closed loop: the plant is stepped up to
+ *  the virtual time before every update(). The report adds the plant steps, the peak chamber
+ *  pressure and the propellant used.
+ *
+ *  Time is virtual, so a full fire (ignition to end of passivation) replays in milliseconds
+ *  and every change of the BURN logic can be checked against all recorded fires.
+ *
+ *  Usage: replay [options] trace...
+ *    --ignite-at MS   trace time at which the IGNITER command is sent (default 0)
+ *    --step-us US     virtual loop period (default 1000)
+ *    --max-ms MS      stop after this much trace time (default: end of passivation)
+ *    --timeline       print the valve edge timeline
+ *    --csv            one machine-readable summary line per trace
+ *    --serial         forward the firmware Serial output to stderr
+ *    --ccc-bus        CCC Sensata on its own bus (CCC_WIRE) instead of behind the multiplexer
+ *    --rates          print the achieved sample rates per schedule phase
+ *    --drain-ms MS    poll the sample FIFO of every channel each MS of trace time
+ *    --timestamp-ms MS send the master time every MS of trace time
+ *    --plant          closed loop on the engine plant model instead of traces
+ */
+
+#include <vector>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "PRBComputer.h"
+#include "sim/ReplayBench.h"
+#include "sim/EnginePlant.h"
+#include "common/prb_log.h"
+
+#define DEFAULT_STEP_US     1000
+#define SEQUENCE_MAX_MS     120000      // longer than a full ignition + passivation sequence
+#define DRAIN_MAX_BLOCKS    64          // PRB_NET_SAMPLES requests per channel and poll
+#define MASTER_DRIFT_PPM    40.0
+#define MASTER_OFFSET_US    3600000000ULL   // master clock one hour ahead
+#define DRAIN_XFER_BYTES    (1 + 1 + 4 + 1 + SAMPLE_FIFO_BLOCK + 1) // addresses, command, data, response
+
+typedef struct valve_edge_t
+{
+    int64_t t_us;
+    uint8_t pin;
+    uint8_t level;
+}valve_edge_t;
+
+typedef struct replay_result_t
+{
+    std::vector<valve_edge_t> edges;
+    int64_t burn_time_us;
+    float engine_total_impulse;
+    PRB_FSM final_state;
+    bool aborted;
+    bool passivated;
+    double wall_ms;
+    double virtual_ms;
+    uint64_t irq_masked_max_us;
+    uint64_t irq_masked_total_us;
+    uint64_t output_writes;
+    uint64_t output_edges;
+    uint64_t phase_us[SAMPLE_PHASES];                   // virtual time spent in each schedule phase
+    uint64_t phase_samples[SAMPLE_PHASES][TLM_CHANNELS]; // new samples of each channel per phase
+    int64_t first_sample_us[TLM_CHANNELS];              // virtual time of the first new sample, -1 if none
+    uint64_t drain_recovered[TLM_CHANNELS];             // samples rebuilt from PRB_NET_SAMPLES blocks
+    uint64_t drain_lost[TLM_CHANNELS];                  // samples overwritten before they were drained
+    uint64_t drain_wrong;                               // samples rebuilt with a wrong value or sequence
+    uint64_t drain_overflows;
+    uint64_t drain_blocks;
+    uint64_t drain_polls;
+    double sync_error_us;                               // clock_sync_time() - master time at the end
+    float sync_reported_us;                             // clock_sync_error() at the end
+    uint16_t sync_exchanges;
+    uint64_t plant_steps;                               // --plant only
+    float plant_peak_bar;                               // peak chamber pressure of the plant
+    float plant_fuel_kg;                                // propellant used
+    float plant_ox_kg;
+}replay_result_t;
+
+// Master side of PRB_NET_SAMPLES: next sequence number of every channel, and the fresh
+// samples of the run (sequence number = index) to check the rebuilt trace against
+typedef struct drain_master_t
+{
+    uint32_t next_seq[TLM_CHANNELS];
+    std::vector<float> fresh[TLM_CHANNELS];
+}drain_master_t;
+
+static const char *const fsm_names[] = {"IDLE", "CLEAR_TO_IGNITE", "IGNITION_SQ", "PASSIVATION_SQ", "ABORT", "ERROR"};
+static const char *const phase_names[SAMPLE_PHASES] = {"STARTUP", "IDLE", "ARMED", "SEQUENCE", "BURN"};
+
+static std::vector<valve_edge_t> *edge_log = nullptr;
+static replay_result_t *current_result = nullptr;
+static int64_t time_origin_us = 0;
+static uint8_t last_level[HOST_NUM_PINS];
+
+static const char *pin_name(uint8_t pin)
+{
+    switch (pin) {
+    case ME_b: return "ME_b";
+    case MO_bC: return "MO_bC";
+    case IGNITER: return "IGNITER";
+    default: return "?";
+    }
+}
+
+static void record_edge(uint8_t pin, uint8_t level, uint64_t time_us)
+{
+    bool valve = pin == ME_b || pin == MO_bC || pin == IGNITER;
+    if (!current_result || !(valve || pin == RGB_RED || pin == RGB_GREEN || pin == RGB_BLUE)) return;
+    current_result->output_writes++;
+    if (last_level[pin] == level) return;       // not an edge
+    last_level[pin] = level;
+    current_result->output_edges++;
+    if (valve) edge_log->push_back({(int64_t)time_us + time_origin_us, pin, level});
+}
+
+static uint32_t master_time_us(uint64_t local_us)
+{
+    return (uint32_t)(MASTER_OFFSET_US + (uint64_t)llround(local_us * (1.0 + MASTER_DRIFT_PPM * 1e-6)));
+}
+
+static bool same_sample(int channel, float decoded, float expected)
+{
+    if (isnan(decoded) || isnan(expected)) return isnan(decoded) && isnan(expected);
+    bool pressure = channel == TLM_CCC_PRESS || channel == TLM_EIN_PRESS || channel == TLM_OIN_PRESS;
+    float lsb = pressure ? CODEC_PRESS_LSB : CODEC_TEMP_LSB;
+    return fabsf(decoded - expected) <= 0.51f * lsb + 1e-6f * fabsf(expected);
+}
+
+// one poll of the master: every channel drained until no more samples (or max_blocks)
+static void drain_poll(PRBComputer &computer, drain_master_t &master, replay_result_t &result, int max_blocks)
+{
+    result.drain_polls++;
+    for (int c = 0; c < TLM_CHANNELS; c++) {
+        for (int b = 0; b < max_blocks; b++) {
+            uint8_t block[SAMPLE_FIFO_BLOCK] = {};
+            computer.drain_samples(c, master.next_seq[c] & SAMPLE_FIFO_SEQ_MASK, block);
+            result.drain_blocks++;
+
+            sample_block_t decoded;
+            if (!fifo_block_decode(block, sizeof(block), &decoded) || decoded.channel != c) {
+                result.drain_wrong++;
+                break;
+            }
+            if (decoded.flags & SAMPLE_FIFO_OVERFLOW) {
+                result.drain_overflows++;
+                result.drain_lost[c] += decoded.first_seq - master.next_seq[c];
+            } else if (decoded.first_seq != master.next_seq[c]) {
+                result.drain_wrong++;
+            }
+            for (int i = 0; i < decoded.count; i++) {
+                uint32_t seq = decoded.first_seq + i;
+                bool known = seq < master.fresh[c].size();
+                if (known && same_sample(c, decoded.values[i], master.fresh[c][seq])) result.drain_recovered[c]++;
+                else result.drain_wrong++;
+            }
+            master.next_seq[c] = decoded.first_seq + decoded.count;
+            if (!(decoded.flags & SAMPLE_FIFO_MORE)) break;
+        }
+    }
+}
+
+static replay_result_t replay(const std::vector<prb_log_sample_t> &trace, int64_t ignite_at_us,
+                              uint32_t step_us, int64_t max_us, bool ccc_own_bus, int64_t drain_us,
+                              int64_t timestamp_us, EnginePlant *plant)
+{
+    replay_result_t result = {};
+    result.burn_time_us = -1;
+    result.aborted = false;
+    result.passivated = false;
+    result.output_writes = 0;
+    result.output_edges = 0;
+    memset(result.phase_us, 0, sizeof(result.phase_us));
+    memset(result.phase_samples, 0, sizeof(result.phase_samples));
+    for (int c = 0; c < TLM_CHANNELS; c++) result.first_sample_us[c] = -1;
+
+    host::reset();
+    memset(last_level, LOW, sizeof(last_level));
+    edge_log = &result.edges;
+    current_result = &result;
+    host::set_pin_write_hook(record_edge);
+
+    // virtual clock starts at 0 on the first trace sample
+    time_origin_us = trace.front().t_us;
+    int64_t end_us = trace.back().t_us;
+    if (end_us < ignite_at_us + SEQUENCE_MAX_MS * 1000LL) end_us = ignite_at_us + SEQUENCE_MAX_MS * 1000LL;
+    if (max_us >= 0 && time_origin_us + max_us < end_us) end_us = time_origin_us + max_us;
+
+    ReplayBench bench(ccc_own_bus);
+    PRBComputer computer(IDLE, ccc_own_bus ? CCC_WIRE : SENSOR_WIRE);
+    outputs_begin();
+    digitalWrite(RESET, HIGH); // Activate MUX, as in setup()
+    if (plant) plant->reset(host::time_us());
+
+    size_t cursor = 0;
+    bool ignited = false;
+    drain_master_t master = {};
+    uint64_t next_drain_us = drain_us;
+    uint64_t next_timestamp_us = 0;
+    auto wall_start = std::chrono::steady_clock::now();
+
+    while ((int64_t)host::time_us() + time_origin_us < end_us) {
+        int64_t now = (int64_t)host::time_us() + time_origin_us;
+
+        if (plant) {
+            plant->advance_to(host::time_us());
+            bench.apply(plant->sample());
+            result.plant_peak_bar = fmaxf(result.plant_peak_bar, plant->state().chamber_bar);
+        } else {
+            // sample-and-hold the latest trace row
+            while (cursor < trace.size() && trace[cursor].t_us <= now) bench.apply(trace[cursor++]);
+        }
+
+        if (!ignited && now >= ignite_at_us) {
+            computer.set_state(CLEAR_TO_IGNITE);
+            computer.ignite(millis());
+            ignited = true;
+        }
+
+        // the master time is stamped CLOCK_SYNC_LATENCY_US before the receive handler runs
+        if (timestamp_us > 0 && host::time_us() >= next_timestamp_us) {
+            post_master_time(master_time_us(host::time_us() - CLOCK_SYNC_LATENCY_US));
+            next_timestamp_us += timestamp_us;
+        }
+
+        uint64_t loop_start_us = host::time_us();
+        sample_phase_t phase = computer.get_sample_phase();
+        computer.update(millis());
+
+        const prb_memory_t &memory = computer.get_memory();
+        uint8_t fresh = memory.fresh_samples;
+        for (int c = 0; c < TLM_CHANNELS; c++) {
+            if (fresh & (1 << c)) result.phase_samples[phase][c]++;
+            if ((fresh & (1 << c)) && result.first_sample_us[c] < 0) result.first_sample_us[c] = host::time_us();
+        }
+        if (drain_us > 0) {
+            const float values[TLM_CHANNELS] = {memory.ccc_press, memory.ein_press, memory.ccc_temp,
+                memory.ein_temp_sensata, memory.oin_temp, memory.ein_temp_pt1000, memory.oin_press};
+            for (int c = 0; c < TLM_CHANNELS; c++) {
+                if (fresh & (1 << c)) master.fresh[c].push_back(values[c]);
+            }
+            // the request handler runs between two loop iterations
+            if (host::time_us() >= next_drain_us) {
+                drain_poll(computer, master, result, DRAIN_MAX_BLOCKS);
+                next_drain_us += drain_us;
+            }
+        }
+
+        if (ignited && computer.get_state() == ABORT) result.aborted = true;
+        if (ignited && computer.get_state() == PASSIVATION_SQ && computer.get_shutdown_stage() == SLEEP) {
+            result.passivated = true;
+            result.phase_us[phase] += host::time_us() - loop_start_us;
+            break;
+        }
+        host::advance_us(step_us);
+        result.phase_us[phase] += host::time_us() - loop_start_us;
+    }
+
+    if (drain_us > 0) drain_poll(computer, master, result, SAMPLE_FIFO_DEPTH); // samples still queued at the end
+
+    result.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    result.virtual_ms = host::time_us() / 1000.0;
+    result.final_state = computer.get_state();
+    const clock_sync_t &clock = computer.get_memory().clock;
+    result.sync_error_us = (int32_t)(clock_sync_time(&clock, micros()) - master_time_us(host::time_us()));
+    result.sync_reported_us = clock_sync_error(&clock, micros());
+    result.sync_exchanges = clock.exchanges;
+    result.engine_total_impulse = computer.get_memory().engine_total_impulse;
+    result.irq_masked_max_us = host::irq_masked_max_us();
+    result.irq_masked_total_us = host::irq_masked_total_us();
+    if (plant) {
+        result.plant_steps = plant->state().steps;
+        result.plant_fuel_kg = plant_default_config.fuel_mass_kg - plant->state().fuel_mass;
+        result.plant_ox_kg = plant_default_config.ox_mass_kg - plant->state().ox_mass;
+    }
+
+    int64_t me_open = -1;
+    for (const valve_edge_t &edge : result.edges) {
+        if (edge.pin == ME_b && edge.level == HIGH && me_open < 0) me_open = edge.t_us;
+        if (edge.pin == MO_bC && edge.level == LOW && me_open >= 0) {
+            result.burn_time_us = edge.t_us - me_open;
+            break;
+        }
+    }
+
+    host::set_pin_write_hook(nullptr);
+    edge_log = nullptr;
+    current_result = nullptr;
+    return result;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: replay [--ignite-at MS] [--step-us US] [--max-ms MS] [--timeline] [--csv] [--serial] [--ccc-bus] [--rates] [--drain-ms MS] [--timestamp-ms MS] [--plant] trace...\n");
+}
+
+int main(int argc, char **argv)
+{
+    int64_t ignite_at_us = 0;
+    uint32_t step_us = DEFAULT_STEP_US;
+    int64_t max_us = -1;
+    bool timeline = false;
+    bool csv = false;
+    bool ccc_own_bus = false;
+    bool rates = false;
+    int64_t drain_us = 0;
+    int64_t timestamp_us = 0;
+    bool closed_loop = false;
+    std::vector<const char *> traces;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--ignite-at") && i + 1 < argc) ignite_at_us = atoll(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "--step-us") && i + 1 < argc) step_us = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max-ms") && i + 1 < argc) max_us = atoll(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "--timeline")) timeline = true;
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (!strcmp(argv[i], "--serial")) host::set_serial_sink(stderr);
+        else if (!strcmp(argv[i], "--ccc-bus")) ccc_own_bus = true;
+        else if (!strcmp(argv[i], "--rates")) rates = true;
+        else if (!strcmp(argv[i], "--drain-ms") && i + 1 < argc) drain_us = atoll(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "--timestamp-ms") && i + 1 < argc) timestamp_us = atoll(argv[++i]) * 1000;
+        else if (!strcmp(argv[i], "--plant")) closed_loop = true;
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else traces.push_back(argv[i]);
+    }
+    if (closed_loop) traces.push_back("plant");
+    if (traces.empty() || step_us == 0) {
+        usage();
+        return 2;
+    }
+
+    if (csv) printf("trace,result,burn_time_ms,engine_total_impulse,final_state,virtual_ms,wall_ms,irq_masked_max_us,output_writes\n");
+
+    int failures = 0;
+    for (const char *path : traces) {
+        std::vector<prb_log_sample_t> trace;
+        EnginePlant engine;
+        bool on_plant = closed_loop && path == traces.back();
+        if (on_plant) {
+            // no recording: one empty row sets the time origin
+            prb_log_sample_t origin = {0, {}};
+            for (float &v : origin.values) v = NAN;
+            trace.push_back(origin);
+        } else if (!load_trace(path, trace) || trace.empty()) {
+            fprintf(stderr, "replay: cannot load trace %s\n", path);
+            failures++;
+            continue;
+        }
+
+        replay_result_t r = replay(trace, ignite_at_us, step_us, max_us, ccc_own_bus, drain_us, timestamp_us,
+                                  on_plant ? &engine : nullptr);
+        const char *outcome = r.aborted ? "ABORTED" : (r.passivated ? "PASSIVATED" : "INCOMPLETE");
+
+        if (csv) {
+            printf("%s,%s,%.1f,%.3f,%s,%.1f,%.3f,%llu,%llu\n", path, outcome, r.burn_time_us / 1000.0,
+                   r.engine_total_impulse, fsm_names[r.final_state], r.virtual_ms, r.wall_ms,
+                   (unsigned long long)r.irq_masked_max_us, (unsigned long long)r.output_writes);
+        } else {
+            printf("trace: %s\n", path);
+            printf("  result      : %s\n", outcome);
+            if (r.burn_time_us >= 0) printf("  burn time   : %.1f ms\n", r.burn_time_us / 1000.0);
+            else printf("  burn time   : -\n");
+            printf("  impulse     : %.3f N.s\n", r.engine_total_impulse);
+            printf("  final state : %s\n", fsm_names[r.final_state]);
+            printf("  irq masked  : max %llu us, total %.1f ms\n", (unsigned long long)r.irq_masked_max_us,
+                   r.irq_masked_total_us / 1000.0);
+            printf("  pin writes  : %llu (%llu edges)\n", (unsigned long long)r.output_writes,
+                   (unsigned long long)r.output_edges);
+            printf("  replay      : %.1f ms virtual in %.3f ms\n", r.virtual_ms, r.wall_ms);
+            if (on_plant) {
+                printf("  plant       : %llu steps, peak chamber %.2f bar, %.2f kg ethanol, %.2f kg LOX\n",
+                       (unsigned long long)r.plant_steps, r.plant_peak_bar, r.plant_fuel_kg, r.plant_ox_kg);
+            }
+        }
+        if (rates) {
+            printf("  sample rate [Hz]:");
+            for (int c = 0; c < TLM_CHANNELS; c++) printf(" %s", prb_log_channel_names[c]);
+            printf("\n");
+            for (int p = 0; p < SAMPLE_PHASES; p++) {
+                if (r.phase_us[p] == 0) continue;
+                printf("    %-8s %7.1f s", phase_names[p], r.phase_us[p] / 1e6);
+                for (int c = 0; c < TLM_CHANNELS; c++) printf(" %7.1f", r.phase_samples[p][c] * 1e6 / r.phase_us[p]);
+                printf("\n");
+            }
+            printf("    first [ms]");
+            for (int c = 0; c < TLM_CHANNELS; c++) printf(" %7.1f", r.first_sample_us[c] / 1000.0);
+            printf("\n");
+        }
+        if (drain_us > 0) {
+            uint64_t fresh = 0, recovered = 0, lost = 0;
+            for (int c = 0; c < TLM_CHANNELS; c++) {
+                for (int p = 0; p < SAMPLE_PHASES; p++) fresh += r.phase_samples[p][c];
+                recovered += r.drain_recovered[c];
+                lost += r.drain_lost[c];
+            }
+            printf("  sample fifo : drained every %lld ms, %llu / %llu samples recovered, %llu lost (%llu overflows), %llu wrong\n",
+                   (long long)(drain_us / 1000), (unsigned long long)recovered, (unsigned long long)fresh,
+                   (unsigned long long)lost, (unsigned long long)r.drain_overflows, (unsigned long long)r.drain_wrong);
+            printf("                %llu blocks in %llu polls, %.1f blocks / poll, %.0f bus bytes/s\n",
+                   (unsigned long long)r.drain_blocks, (unsigned long long)r.drain_polls,
+                   r.drain_polls ? (double)r.drain_blocks / r.drain_polls : 0.0,
+                   r.drain_blocks * (double)DRAIN_XFER_BYTES * 1000.0 / r.virtual_ms);
+            printf("                lost per channel:");
+            for (int c = 0; c < TLM_CHANNELS; c++) printf(" %s %llu", prb_log_channel_names[c], (unsigned long long)r.drain_lost[c]);
+            printf("\n");
+        }
+        if (timestamp_us > 0) {
+            printf("  clock sync  : error %.0f us at the end (reported %.1f us), %u exchanges\n",
+                   r.sync_error_us, r.sync_reported_us, r.sync_exchanges);
+        }
+        if (timeline) {
+            for (const valve_edge_t &edge : r.edges) {
+                printf("  %10.3f ms  %-8s %s\n", (edge.t_us - ignite_at_us) / 1000.0, pin_name(edge.pin),
+                       edge.level ? "OPEN" : "CLOSE");
+            }
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * File: EnginePlant.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the engine plant model declared in EnginePlant.h.
+ */
+
+#include "EnginePlant.h"
+#include "constant.h"
+
+#define PLANT_STEP_S        (PLANT_STEP_US * 1e-6f)
+#define BAR                 1e5f
+#define VALVE_SHUT          1e-4f       // opening under which a valve passes no flow
+#define LAG_SNAP            1e-6f       // lags settle on their target, no denormal tails
+
+const plant_config_t plant_default_config = {
+    45.0f,              // fuel_tank_bar
+    40.0f,              // ox_tank_bar
+    0.5f,               // regulator_droop
+    12.0f,              // fuel_mass_kg
+    16.0f,              // ox_mass_kg
+    789.0f,             // fuel_density (ethanol)
+    1141.0f,            // ox_density (LOX)
+    1.689e-4f,          // fuel_line_cda
+    1.835e-4f,          // ox_line_cda
+    4.684e-5f,          // fuel_valve_cda
+    6.487e-5f,          // ox_valve_cda
+    4.222e-5f,          // fuel_injector_cda
+    5.532e-5f,          // ox_injector_cda
+    30.0f,              // valve_open_ms
+    20.0f,              // valve_close_ms
+    1.0f,               // l_star
+    0.6485f,            // gamma_factor (gamma = 1.2)
+    0.1f,               // cold_cstar_fraction
+    500.0f,             // igniter_hold_ms
+    0.2f,               // min_flow
+    20.0f,              // ambient_c
+    15.0f,              // fuel_c
+    -180.0f,            // ox_c
+    600.0f,             // ox_line_warm_s
+    5.0f,               // ox_line_chill_s
+    2.0f,               // pt1000_tau_s
+    2.0f,               // sensata_tau_s
+    0.1f,               // chamber_heating
+};
+
+static inline float lag_factor(float tau_s)
+{
+    return 1.0f - expf(-PLANT_STEP_S / tau_s);
+}
+
+// one step of a first-order lag of factor k towards target
+static inline void lag(float &value, float target, float k)
+{
+    value += (target - value) * k;
+    if (fabsf(target - value) < LAG_SNAP) value = target;
+}
+
+EnginePlant::EnginePlant(const plant_config_t &config) : config(config)
+{
+    float cstar_hot = C_STAR;
+    float cstar_cold = C_STAR * config.cold_cstar_fraction;
+    float gamma2 = config.gamma_factor * config.gamma_factor;
+
+    k_valve_open = lag_factor(config.valve_open_ms * 1e-3f);
+    k_valve_close = lag_factor(config.valve_close_ms * 1e-3f);
+    k_chamber_hot = lag_factor(config.l_star / (gamma2 * cstar_hot));
+    k_chamber_cold = lag_factor(config.l_star / (gamma2 * cstar_cold));
+    k_line_warm = lag_factor(config.ox_line_warm_s);
+    k_line_chill = lag_factor(config.ox_line_chill_s);
+    k_pt1000 = lag_factor(config.pt1000_tau_s);
+    k_sensata = lag_factor(config.sensata_tau_s);
+
+    fuel_fixed = 1.0f / (config.fuel_line_cda * config.fuel_line_cda) +
+                 1.0f / (config.fuel_injector_cda * config.fuel_injector_cda);
+    ox_fixed = 1.0f / (config.ox_line_cda * config.ox_line_cda) +
+               1.0f / (config.ox_injector_cda * config.ox_injector_cda);
+    fuel_line_loss = 1.0f / (2.0f * config.fuel_density * config.fuel_line_cda * config.fuel_line_cda * BAR);
+    ox_line_loss = 1.0f / (2.0f * config.ox_density * config.ox_line_cda * config.ox_line_cda * BAR);
+    reset();
+}
+
+void EnginePlant::reset(uint64_t time_us)
+{
+    plant.time_us = time_us;
+    plant.steps = 0;
+    plant.fuel_valve = 0.0f;
+    plant.ox_valve = 0.0f;
+    plant.fuel_flow = 0.0f;
+    plant.ox_flow = 0.0f;
+    plant.fuel_mass = config.fuel_mass_kg;
+    plant.ox_mass = config.ox_mass_kg;
+    plant.fuel_feed_bar = config.fuel_tank_bar;
+    plant.ox_feed_bar = config.ox_tank_bar;
+    plant.chamber_bar = 0.0f;
+    plant.burning = false;
+    plant.igniter = false;
+    plant.igniter_off_us = INT64_MIN / 2;
+    plant.ox_line_c = config.ox_c;
+    plant.oin_pt1000_c = config.ox_c;
+    plant.ein_pt1000_c = config.fuel_c;
+    plant.ccc_sensata_c = config.ambient_c;
+    plant.ein_sensata_c = config.fuel_c;
+}
+
+/**
+ * @brief Flow through the line, the valve and the injector in series [kg/s].
+ *
+ * @param dp_bar  Tank pressure minus chamber pressure.
+ * @param valve   Valve CdA at its current opening, 0 when shut.
+ * @param fixed   1 / line CdA^2 + 1 / injector CdA^2.
+ */
+static inline float orifice_flow(float dp_bar, float density, float valve, float fixed)
+{
+    if (dp_bar <= 0.0f || valve <= 0.0f) return 0.0f;
+    return valve * sqrtf(2.0f * density * dp_bar * BAR / (1.0f + valve * valve * fixed));
+}
+
+void EnginePlant::step()
+{
+    plant.time_us += PLANT_STEP_US;
+    plant.steps++;
+
+    // valves follow the pins
+    float fuel_target = digitalRead(ME_b) ? 1.0f : 0.0f;
+    float ox_target = digitalRead(MO_bC) ? 1.0f : 0.0f;
+    lag(plant.fuel_valve, fuel_target, fuel_target > plant.fuel_valve ? k_valve_open : k_valve_close);
+    lag(plant.ox_valve, ox_target, ox_target > plant.ox_valve ? k_valve_open : k_valve_close);
+
+    // feed: regulator droop with the flow of the previous step
+    float fuel_valve_cda = plant.fuel_valve >= VALVE_SHUT ? plant.fuel_valve * config.fuel_valve_cda : 0.0f;
+    float ox_valve_cda = plant.ox_valve >= VALVE_SHUT ? plant.ox_valve * config.ox_valve_cda : 0.0f;
+    float fuel_tank = config.fuel_tank_bar - config.regulator_droop * plant.fuel_flow;
+    float ox_tank = config.ox_tank_bar - config.regulator_droop * plant.ox_flow;
+    plant.fuel_flow = plant.fuel_mass > 0.0f ?
+        orifice_flow(fuel_tank - plant.chamber_bar, config.fuel_density, fuel_valve_cda, fuel_fixed) : 0.0f;
+    plant.ox_flow = plant.ox_mass > 0.0f ?
+        orifice_flow(ox_tank - plant.chamber_bar, config.ox_density, ox_valve_cda, ox_fixed) : 0.0f;
+    plant.fuel_mass = fmaxf(plant.fuel_mass - plant.fuel_flow * PLANT_STEP_S, 0.0f);
+    plant.ox_mass = fmaxf(plant.ox_mass - plant.ox_flow * PLANT_STEP_S, 0.0f);
+
+    // feed sensors downstream of the line loss
+    plant.fuel_feed_bar = fuel_tank - plant.fuel_flow * plant.fuel_flow * fuel_line_loss;
+    plant.ox_feed_bar = ox_tank - plant.ox_flow * plant.ox_flow * ox_line_loss;
+
+    // ignition source: igniter on, or released less than igniter_hold_ms ago
+    bool igniter = digitalRead(IGNITER);
+    if (plant.igniter && !igniter) plant.igniter_off_us = (int64_t)plant.time_us;
+    plant.igniter = igniter;
+    bool source = igniter || (int64_t)plant.time_us - plant.igniter_off_us < (int64_t)(config.igniter_hold_ms * 1000.0f);
+    bool flowing = plant.fuel_flow >= config.min_flow && plant.ox_flow >= config.min_flow;
+    if (!flowing) plant.burning = false;
+    else if (source) plant.burning = true;
+
+    // chamber
+    float cstar = plant.burning ? C_STAR : C_STAR * config.cold_cstar_fraction;
+    float steady = (plant.fuel_flow + plant.ox_flow) * cstar / AREA_THROAT / BAR;
+    lag(plant.chamber_bar, steady, plant.burning ? k_chamber_hot : k_chamber_cold);
+
+    // temperatures
+    if (plant.ox_flow >= config.min_flow) lag(plant.ox_line_c, config.ox_c, k_line_chill);
+    else lag(plant.ox_line_c, config.ambient_c, k_line_warm);
+    lag(plant.oin_pt1000_c, plant.ox_line_c, k_pt1000);
+    lag(plant.ein_pt1000_c, config.fuel_c, k_pt1000);
+    lag(plant.ein_sensata_c, config.fuel_c, k_sensata);
+    lag(plant.ccc_sensata_c, config.ambient_c + config.chamber_heating * plant.chamber_bar, k_sensata);
+}
+
+void EnginePlant::advance_to(uint64_t time_us)
+{
+    while (plant.time_us + PLANT_STEP_US <= time_us) step();
+}
+
+prb_log_sample_t EnginePlant::sample() const
+{
+    prb_log_sample_t sample;
+    sample.t_us = (int64_t)plant.time_us;
+    sample.values[LOG_CCC_PRESS] = plant.chamber_bar;
+    sample.values[LOG_EIN_PRESS] = plant.fuel_feed_bar;
+    sample.values[LOG_CCC_TEMP] = plant.ccc_sensata_c;
+    sample.values[LOG_EIN_TEMP_SENSATA] = plant.ein_sensata_c;
+    sample.values[LOG_OIN_TEMP] = plant.oin_pt1000_c;
+    sample.values[LOG_EIN_TEMP_PT1000] = plant.ein_pt1000_c;
+    sample.values[LOG_OIN_PRESS] = plant.ox_feed_bar;
+    return sample;
+}
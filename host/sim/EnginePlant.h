@@ -0,0 +1,135 @@
+#ifndef ENGINE_PLANT_H
+#define ENGINE_PLANT_H
+/*
+ * File: EnginePlant.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Lumped-parameter model of the engine and its feed system, for closed-loop host runs of
+ *  PRBComputer: the valves and igniter are read from the simulated ME_b, MO_bC and IGNITER
+ *  pins, the model produces the sensor readings as a trace row (prb_log_sample_t) that
+ *  ReplayBench::apply() puts on the simulated Sensata and PT1000 inputs.
+ *
+ *  Model, per propellant (ethanol through ME_b, LOX through MO_bC):
+ *    - regulated tank: set pressure minus a regulator droop proportional to the outflow, the
+ *      flow stops when the loaded mass is spent
+ *    - feed line, main valve and injector as three orifices in series (incompressible liquid),
+ *      the feed sensors (EIN, OIN) sit between the line and the valve
+ *    - valve opening: first-order lag towards the pin level, separate opening / closing times
+ *  Chamber:
+ *    - filling / emptying lag of the chamber gas, time constant L* / (Gamma^2 c*), towards the
+ *      steady pressure mdot c* / AREA_THROAT (C_STAR when burning, a fraction of it cold)
+ *    - ignition when both propellants flow while the igniter is on or was released less than
+ *      igniter_hold_ms ago, flame-out when either flow drops under min_flow
+ *  Temperatures: first-order lags (PT1000 elements, Sensata sensing elements, LOX line chilled
+ *  by the LOX flow and warming up slowly without it, CCC sensor heated by the chamber).
+ *
+ *  The model steps at PLANT_STEP_US (10 kHz) with the lag and orifice factors precomputed, a
+ *  full ignition and passivation sequence (~740k steps) closes the loop in about 40 ms of host time.
+ */
+
+#include "Arduino.h"
+#include "common/prb_log.h"
+
+#define PLANT_STEP_US       100         // 10 kHz
+
+typedef struct plant_config_t
+{
+    float fuel_tank_bar;            // ethanol tank set pressure [bar]
+    float ox_tank_bar;              // LOX tank set pressure [bar]
+    float regulator_droop;          // tank pressure drop with the outflow [bar / (kg/s)]
+    float fuel_mass_kg;             // loaded ethanol
+    float ox_mass_kg;               // loaded LOX
+    float fuel_density;             // [kg/m^3]
+    float ox_density;               // [kg/m^3]
+    float fuel_line_cda;            // tank to EIN sensor [m^2]
+    float ox_line_cda;              // tank to OIN sensor [m^2]
+    float fuel_valve_cda;           // ME_b fully open [m^2]
+    float ox_valve_cda;             // MO_bC fully open [m^2]
+    float fuel_injector_cda;        // [m^2]
+    float ox_injector_cda;          // [m^2]
+    float valve_open_ms;            // time constant of a valve opening
+    float valve_close_ms;           // time constant of a valve closing
+    float l_star;                   // chamber volume / throat area [m]
+    float gamma_factor;             // Vandenkerckhove function of the gas gamma
+    float cold_cstar_fraction;      // c* of the propellants flowing without combustion
+    float igniter_hold_ms;          // ignition source kept after the igniter is released
+    float min_flow;                 // flame-out below this flow of either propellant [kg/s]
+    float ambient_c;                // [°C]
+    float fuel_c;                   // ethanol temperature [°C]
+    float ox_c;                     // LOX temperature [°C]
+    float ox_line_warm_s;           // LOX line warm-up time constant without flow
+    float ox_line_chill_s;          // LOX line chill-down time constant with flow
+    float pt1000_tau_s;             // PT1000 thermal lag
+    float sensata_tau_s;            // Sensata temperature element lag
+    float chamber_heating;          // CCC sensor temperature rise with the chamber pressure [°C / bar]
+}plant_config_t;
+
+// Sized for the design point: ~30 bar chamber pressure, 1.5 kg/s ethanol and 1.96 kg/s LOX
+// (5.38 kN), feed pressures of the reference fires (EIN 45 bar, OIN 40 bar)
+extern const plant_config_t plant_default_config;
+
+typedef struct plant_state_t
+{
+    uint64_t time_us;               // plant time, follows the host virtual clock
+    uint64_t steps;
+    float fuel_valve;               // ME_b opening [0..1]
+    float ox_valve;                 // MO_bC opening [0..1]
+    float fuel_flow;                // [kg/s]
+    float ox_flow;                  // [kg/s]
+    float fuel_mass;                // left in the tank [kg]
+    float ox_mass;                  // left in the tank [kg]
+    float fuel_feed_bar;            // EIN
+    float ox_feed_bar;              // OIN
+    float chamber_bar;              // CCC
+    bool burning;
+    bool igniter;                   // IGNITER pin level
+    int64_t igniter_off_us;         // last release of the igniter, far in the past if never fired
+    float ox_line_c;                // LOX line wall temperature
+    float oin_pt1000_c;
+    float ein_pt1000_c;
+    float ccc_sensata_c;
+    float ein_sensata_c;
+}plant_state_t;
+
+class EnginePlant
+{
+public:
+    EnginePlant(const plant_config_t &config = plant_default_config);
+
+    // full tanks, valves closed, cold chamber, LOX line chilled (tanks filled), at time time_us
+    void reset(uint64_t time_us = 0);
+
+    // steps the model up to time_us (host::time_us()), valves and igniter read from the pins
+    void advance_to(uint64_t time_us);
+
+    // sensor readings at the plant time, in trace units
+    prb_log_sample_t sample() const;
+
+    const plant_state_t &state() const { return plant; }
+
+private:
+    void step();
+
+    plant_config_t config;
+    plant_state_t plant;
+
+    // lag factors of one step, 1 - exp(-step / tau)
+    float k_valve_open;
+    float k_valve_close;
+    float k_chamber_hot;
+    float k_chamber_cold;
+    float k_line_warm;
+    float k_line_chill;
+    float k_pt1000;
+    float k_sensata;
+
+    // orifice constants: 1 / line CdA^2 + 1 / injector CdA^2, line loss per (kg/s)^2 [bar]
+    float fuel_fixed;
+    float ox_fixed;
+    float fuel_line_loss;
+    float ox_line_loss;
+};
+
+#endif // ENGINE_PLANT_H
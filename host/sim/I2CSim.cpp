@@ -0,0 +1,420 @@
+/*
+ * File: I2CSim.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the simulated I2C bus, multiplexer and PTE7300 declared in I2CSim.h.
+ *
+ *  The PTE7300 framing follows the Sensata application note used by PTE7300_I2C:
+ *    - non-CRC (address 0x6C): [reg, lo, hi, ...] to write, [reg] then read 2 bytes per word
+ *    - CRC (address 0x6D): [reg, (n_bytes-1)<<4 | crc4, data..., crc8] to write,
+ *      [reg, (n_bytes-1)<<4 | crc4] then read n_bytes + crc8
+ */
+
+#include "I2CSim.h"
+
+// PTE7300 register map (word addresses)
+#define RAM_ADDR_CMD       0x22
+#define RAM_ADDR_ADC_TC    0x26
+#define RAM_ADDR_DSP_T     0x2E
+#define RAM_ADDR_DSP_S     0x30
+#define RAM_ADDR_STATUS    0x36
+#define RAM_ADDR_SERIAL    0x50
+
+// CMD register commands
+#define CMD_START          0x8B93
+#define CMD_SLEEP          0x6C32
+#define CMD_IDLE           0x7BBA
+#define CMD_RESET          0xB169
+
+// STATUS register
+#define STATUS_IDLE        0x0001
+#define STATUS_DSP_S_UP    0x0008
+#define STATUS_DSP_T_UP    0x0010
+
+// ========= bus =========
+I2CSimBus::I2CSimBus()
+{
+    clock_hz = I2C_SIM_DEFAULT_CLOCK;
+    advance_clock = false;
+    repeated_start = false;
+    pending_ns = 0;
+    reset_stats();
+}
+
+void I2CSimBus::attach(I2CSimDevice *device) { devices.push_back(device); }
+
+void I2CSimBus::set_clock(uint32_t frequency)
+{
+    if (frequency > 0) clock_hz = frequency;
+}
+
+void I2CSimBus::reset_stats() { memset(&bus_stats, 0, sizeof(bus_stats)); }
+
+I2CSimDevice *I2CSimBus::find(uint8_t address)
+{
+    for (I2CSimDevice *device : devices) {
+        if (device->responds_to(address)) return device;
+    }
+    for (I2CSimDevice *device : devices) {
+        I2CSimDevice *target = device->downstream(address);
+        if (target) return target;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Accounts for one addressed transfer on the wire.
+ *
+ * (Repeated) START = 1 bit, every byte (address included) = 8 bits + ACK, STOP = 1 bit.
+ * A NACKed address ends the transfer after the address byte.
+ */
+void I2CSimBus::account(size_t bytes, bool stop, bool nack)
+{
+    uint64_t bits = 1 + 9 * (1 + bytes) + (stop ? 1 : 0);
+    uint64_t ns = bits * 1000000000ULL / clock_hz;
+
+    bus_stats.transfers++;
+    if (nack) bus_stats.nacks++;
+    bus_stats.bytes += 1 + bytes;
+    bus_stats.bits += bits;
+    bus_stats.bus_time_ns += ns;
+    repeated_start = !stop;
+
+    if (advance_clock) {
+        pending_ns += ns;
+        host::advance_us(pending_ns / 1000);
+        pending_ns %= 1000;
+    }
+}
+
+uint8_t I2CSimBus::master_write(uint8_t address, const uint8_t *data, size_t length, bool stop)
+{
+    I2CSimDevice *target = find(address);
+    if (!target) {
+        account(0, true, true);
+        return 2;
+    }
+    bool ack = target->write(address, data, length);
+    account(length, stop, !ack);
+    return ack ? 0 : 3;
+}
+
+size_t I2CSimBus::master_read(uint8_t address, uint8_t *data, size_t length, bool stop)
+{
+    I2CSimDevice *target = find(address);
+    if (!target) {
+        account(0, true, true);
+        return 0;
+    }
+    size_t supplied = target->read(address, data, length);
+    account(length, stop, false);
+    return supplied;
+}
+
+// ========= multiplexer =========
+MuxSim::MuxSim(uint8_t address, int reset_pin_)
+{
+    own_address = address;
+    reset_pin = reset_pin_;
+    control_reg = 0;
+    for (int i = 0; i < 8; i++) channels[i] = nullptr;
+    lockup = false;
+    lockup_cleared_by_reset = true;
+    lockup_reset_edges = 0;
+}
+
+void MuxSim::set_lockup(bool locked, bool cleared_by_reset)
+{
+    lockup = locked;
+    lockup_cleared_by_reset = cleared_by_reset;
+    lockup_reset_edges = reset_pin >= 0 ? host::pin_edge_count(reset_pin) : 0;
+}
+
+bool MuxSim::locked_up() const
+{
+    // a full LOW-HIGH pulse on RESET since the lock-up started clears it
+    if (lockup && lockup_cleared_by_reset && reset_pin >= 0 &&
+        host::pin_edge_count(reset_pin) >= lockup_reset_edges + 2) {
+        lockup = false;
+    }
+    return lockup;
+}
+
+void MuxSim::attach(int channel, I2CSimDevice *device)
+{
+    if (channel >= 0 && channel < 8) channels[channel] = device;
+}
+
+bool MuxSim::in_reset()
+{
+    if (reset_pin >= 0 && digitalRead(reset_pin) == LOW) {
+        control_reg = 0;
+        return true;
+    }
+    return false;
+}
+
+bool MuxSim::responds_to(uint8_t address) const { return address == own_address && !locked_up(); }
+
+bool MuxSim::write(uint8_t, const uint8_t *data, size_t length)
+{
+    if (in_reset()) return false;
+    if (length > 0) control_reg = data[length - 1];
+    return true;
+}
+
+size_t MuxSim::read(uint8_t, uint8_t *data, size_t length)
+{
+    if (in_reset()) return 0;
+    for (size_t i = 0; i < length; i++) data[i] = control_reg;
+    return length;
+}
+
+I2CSimDevice *MuxSim::downstream(uint8_t address)
+{
+    if (in_reset() || locked_up()) return nullptr;
+    for (int i = 0; i < 8; i++) {
+        if (!(control_reg & (1 << i)) || !channels[i]) continue;
+        if (channels[i]->responds_to(address)) return channels[i];
+    }
+    return nullptr;
+}
+
+// ========= PTE7300 =========
+PTE7300Sim::PTE7300Sim(uint8_t address, uint32_t serial)
+{
+    node_address = address;
+    serial_number = serial;
+    conversion_period_us = 0;
+    startup_us = 0;
+    input_dsp_s = 0;
+    input_dsp_t = 0;
+    noise_lsb = 0;
+    noise_state = serial;
+    device_fault = PTE7300_HEALTHY;
+    memset(&device_stats, 0, sizeof(device_stats));
+    power_on_reset();
+}
+
+void PTE7300Sim::power_on_reset()
+{
+    memset(regs, 0, sizeof(regs));
+    regs[RAM_ADDR_SERIAL] = serial_number & 0xFFFF;
+    regs[RAM_ADDR_SERIAL + 1] = serial_number >> 16;
+    pointer = 0;
+    crc_read_words = 0;
+    crc_read_hold = 0;
+    device_mode = PTE7300_CONTINUOUS;
+    ready_us = host::time_us();
+    next_conversion_us = ready_us;
+    single_pending = false;
+}
+
+static int16_t saturate_dsp(float dsp)
+{
+    if (dsp > 32767.0f) return 32767;
+    if (dsp < -32768.0f) return -32768;
+    return (int16_t)lroundf(dsp);
+}
+
+void PTE7300Sim::set_pressure_bar(float press)
+{
+    // inverse of sensata_pressure_bar() (SignalMath.h)
+    input_dsp_s = saturate_dsp(press * (16000.0f - (-16000.0f)) / 100.0f + (-16000.0f));
+}
+
+void PTE7300Sim::set_temperature_c(float temp)
+{
+    // inverse of sensata_temperature_c() (SignalMath.h)
+    input_dsp_t = saturate_dsp((temp - 42.5f) * 16000.0f / 82.5f);
+}
+
+void PTE7300Sim::convert()
+{
+    int16_t dither = 0;
+    if (noise_lsb) {
+        noise_state = noise_state * 1103515245u + 12345u;      // LCG, deterministic runs
+        dither = (int16_t)((noise_state >> 16) % (2 * noise_lsb + 1)) - noise_lsb;
+    }
+    regs[RAM_ADDR_DSP_S] = device_fault == PTE7300_SATURATED ? 0x7FFF : (uint16_t)(input_dsp_s + dither);
+    regs[RAM_ADDR_DSP_T] = (uint16_t)input_dsp_t;
+    regs[RAM_ADDR_ADC_TC] = (uint16_t)(input_dsp_t / 2);
+    regs[RAM_ADDR_STATUS] |= STATUS_DSP_S_UP | STATUS_DSP_T_UP;
+    device_stats.conversions++;
+}
+
+void PTE7300Sim::update_conversions()
+{
+    uint64_t now = host::time_us();
+    if (device_fault == PTE7300_FROZEN || now < ready_us) return;
+
+    if (single_pending && now >= next_conversion_us) {
+        convert();
+        single_pending = false;
+        update_status();
+    }
+    if (device_mode != PTE7300_CONTINUOUS) return;
+
+    if (conversion_period_us == 0) {
+        convert();
+    } else if (now >= next_conversion_us) {
+        convert();
+        next_conversion_us = now - (now - next_conversion_us) % conversion_period_us + conversion_period_us;
+    }
+}
+
+void PTE7300Sim::execute(uint16_t command)
+{
+    device_stats.commands++;
+    switch (command) {
+    case CMD_START:
+        // single conversion, available after one conversion period
+        single_pending = true;
+        next_conversion_us = host::time_us() + conversion_period_us;
+        break;
+    case CMD_SLEEP:
+        device_mode = PTE7300_SLEEP;
+        break;
+    case CMD_IDLE:
+        device_mode = PTE7300_IDLE;
+        break;
+    case CMD_RESET:
+        power_on_reset();
+        ready_us += startup_us;
+        next_conversion_us = ready_us;
+        break;
+    default:
+        break;
+    }
+    update_status();
+}
+
+void PTE7300Sim::update_status()
+{
+    bool idle = device_mode != PTE7300_CONTINUOUS && !single_pending;
+    regs[RAM_ADDR_STATUS] = (regs[RAM_ADDR_STATUS] & ~STATUS_IDLE) | (idle ? STATUS_IDLE : 0);
+}
+
+void PTE7300Sim::write_words(uint8_t address, const uint8_t *bytes, size_t n_words)
+{
+    for (size_t i = 0; i < n_words; i++) {
+        uint8_t reg = (address + i) & 0x7F;
+        uint16_t value = (uint16_t)(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+        if (reg == RAM_ADDR_CMD) execute(value);
+        else regs[reg] = value;
+    }
+    device_stats.writes++;
+}
+
+bool PTE7300Sim::responds_to(uint8_t address) const
+{
+    if (device_fault == PTE7300_NAK) return false;
+    return address == node_address || address == (node_address | 1);
+}
+
+bool PTE7300Sim::write(uint8_t address, const uint8_t *data, size_t length)
+{
+    if (length == 0) return true;
+
+    if (address == node_address) {
+        pointer = data[0] & 0x7F;
+        if (length > 1) write_words(pointer, data + 1, (length - 1) / 2);
+        return true;
+    }
+
+    // CRC framing: header = register, (n_bytes - 1) << 4 | crc4
+    if (length < 2) {
+        device_stats.crc_errors++;
+        return false;
+    }
+    uint8_t header[2] = {data[0], (uint8_t)(data[1] & 0xF0)};
+    if ((data[1] & 0x0F) != crc4(0x03, 0x0F, header, 2)) {
+        device_stats.crc_errors++;
+        return false;
+    }
+    size_t n_bytes = (data[1] >> 4) + 1;
+    uint8_t stub[3] = {(uint8_t)(((node_address << 1) & 0xFC) | 0x02), data[0], data[1]};
+
+    if (length == 2) {
+        // read request, answered by the next read transfer
+        pointer = data[0] & 0x7F;
+        crc_read_words = n_bytes / 2;
+        crc_read_hold = crc8(0xD5, 0xFF, stub, 3);
+        return true;
+    }
+
+    if (length != 2 + n_bytes + 1) {
+        device_stats.crc_errors++;
+        return false;
+    }
+    uint8_t crc = crc8(0xD5, 0xFF, stub, 3);
+    crc = crc8(0xD5, crc, data + 2, n_bytes);
+    if (crc != data[length - 1]) {
+        device_stats.crc_errors++;
+        return false;
+    }
+    write_words(data[0] & 0x7F, data + 2, n_bytes / 2);
+    return true;
+}
+
+size_t PTE7300Sim::read(uint8_t address, uint8_t *data, size_t length)
+{
+    update_conversions();
+    device_stats.reads++;
+
+    size_t n_words = length / 2;
+    if (address != node_address) n_words = crc_read_words < n_words ? crc_read_words : n_words;
+
+    uint8_t reg = pointer;
+    for (size_t i = 0; i < n_words; i++) {
+        data[2 * i] = regs[reg] & 0xFF;
+        data[2 * i + 1] = regs[reg] >> 8;
+        // reading a result register clears its "updated" bit
+        if (reg == RAM_ADDR_DSP_S) regs[RAM_ADDR_STATUS] &= ~STATUS_DSP_S_UP;
+        if (reg == RAM_ADDR_DSP_T) regs[RAM_ADDR_STATUS] &= ~STATUS_DSP_T_UP;
+        reg = (reg + 1) & 0x7F;
+    }
+    if (address == node_address) {
+        pointer = reg;
+        if (device_fault == PTE7300_CORRUPT && n_words > 0) data[1] ^= 0x20;
+        return n_words * 2;
+    }
+
+    uint8_t node = ((node_address << 1) & 0xFC) | 0x03;
+    uint8_t crc = crc8(0xD5, crc_read_hold, &node, 1);
+    crc = crc8(0xD5, crc, data, n_words * 2);
+    if (device_fault == PTE7300_CORRUPT && n_words > 0) data[1] ^= 0x20;   // on the wire, after the CRC
+    if (length > n_words * 2) {
+        data[n_words * 2] = crc;
+        return n_words * 2 + 1;
+    }
+    return n_words * 2;
+}
+
+uint8_t PTE7300Sim::crc4(uint8_t polynom, uint8_t init, const uint8_t *data, size_t len)
+{
+    uint8_t shifter = init;
+    for (size_t i = 0; i < len; i++) {
+        for (int j = 7; j >= 0; j--) {
+            if (i + 1 >= len && j < 4) break;
+            if (((shifter >> 3) & 0x01) != ((data[i] >> j) & 0x01)) shifter = (shifter << 1) ^ polynom;
+            else shifter = shifter << 1;
+            shifter &= 0x0F;
+        }
+    }
+    return shifter & 0x0F;
+}
+
+uint8_t PTE7300Sim::crc8(uint8_t polynom, uint8_t init, const uint8_t *data, size_t len)
+{
+    uint8_t shifter = init;
+    for (size_t i = 0; i < len; i++) {
+        for (int j = 7; j >= 0; j--) {
+            if (((shifter >> 7) & 0x01) != ((data[i] >> j) & 0x01)) shifter = (shifter << 1) ^ polynom;
+            else shifter = shifter << 1;
+        }
+    }
+    return shifter;
+}
@@ -0,0 +1,209 @@
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+/*
+ * File: I2CSim.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Simulated I2C bus for the host builds, attached to a host TwoWire (e.g. Wire2). It provides:
+ *    - I2CSimBus: routes master transfers to the attached devices and accounts for the bus time
+ *      of every transfer (START, address, data and ACK bits, STOP) at a configurable clock
+ *    - MuxSim: TCA9548A-style multiplexer, control register selects the downstream channels
+ *    - PTE7300Sim: emulated Sensata PTE7300 (register file, CRC and non-CRC framing,
+ *      START/SLEEP/IDLE/RESET commands, conversion and start-up timing, STATUS idle and
+ *      "updated" bits)
+ *
+ *  The sensor inputs are set in engineering units by the host tool and converted back to raw
+ *  DSP counts with the inverse of the conversions in PRBComputer.
+ *
+ *  Faults can be injected on the multiplexer (lock-up of the whole downstream bus) and on each
+ *  PTE7300 (NAK, corrupted frames, frozen or saturated output), see host/fault_injection.
+ */
+
+#include <vector>
+#include "Wire.h"
+
+#define I2C_SIM_DEFAULT_CLOCK   100000      // Teensy Wire default [Hz]
+
+class I2CSimDevice
+{
+public:
+    virtual ~I2CSimDevice() {}
+
+    virtual bool responds_to(uint8_t address) const = 0;
+
+    // returns false to NACK the transfer
+    virtual bool write(uint8_t address, const uint8_t *data, size_t length) = 0;
+
+    // returns the number of bytes supplied
+    virtual size_t read(uint8_t address, uint8_t *data, size_t length) = 0;
+
+    // device reachable through this one (multiplexers only)
+    virtual I2CSimDevice *downstream(uint8_t) { return nullptr; }
+};
+
+
+typedef struct i2c_bus_stats_t
+{
+    uint32_t transfers;             // addressed transfers (START ... STOP / repeated START)
+    uint32_t nacks;                 // transfers NACKed on address or data
+    uint64_t bytes;                 // bytes on the wire, address bytes included
+    uint64_t bits;                  // bit times, ACK / START / STOP included
+    uint64_t bus_time_ns;           // bits at the configured clock [ns]
+}i2c_bus_stats_t;
+
+
+class I2CSimBus : public HostI2CBus
+{
+public:
+    I2CSimBus();
+
+    void attach(I2CSimDevice *device);
+
+    // bus clock used for the timing model [Hz]
+    void set_clock(uint32_t frequency) override;
+    uint32_t get_clock() const { return clock_hz; }
+
+    // when enabled, each transfer advances the virtual clock by its bus time (blocking master)
+    void set_advance_clock(bool advance) { advance_clock = advance; }
+
+    const i2c_bus_stats_t &stats() const { return bus_stats; }
+    void reset_stats();
+
+    uint8_t master_write(uint8_t address, const uint8_t *data, size_t length, bool stop) override;
+    size_t master_read(uint8_t address, uint8_t *data, size_t length, bool stop) override;
+
+private:
+    std::vector<I2CSimDevice *> devices;
+    uint32_t clock_hz;
+    bool advance_clock;
+    bool repeated_start;
+    uint64_t pending_ns;
+    i2c_bus_stats_t bus_stats;
+
+    I2CSimDevice *find(uint8_t address);
+    void account(size_t bytes, bool stop, bool nack);
+};
+
+
+class MuxSim : public I2CSimDevice
+{
+public:
+    MuxSim(uint8_t address, int reset_pin);
+
+    void attach(int channel, I2CSimDevice *device);
+    uint8_t control() const { return control_reg; }
+
+    // lock-up: the mux and its channels NACK everything, until a RESET pulse if cleared_by_reset
+    void set_lockup(bool locked, bool cleared_by_reset = true);
+    bool locked_up() const;
+
+    bool responds_to(uint8_t address) const override;
+    bool write(uint8_t address, const uint8_t *data, size_t length) override;
+    size_t read(uint8_t address, uint8_t *data, size_t length) override;
+    I2CSimDevice *downstream(uint8_t address) override;
+
+private:
+    uint8_t own_address;
+    int reset_pin;
+    uint8_t control_reg;
+    I2CSimDevice *channels[8];
+    mutable bool lockup;
+    bool lockup_cleared_by_reset;
+    uint32_t lockup_reset_edges;    // RESET pin edges when the lock-up started
+
+    bool in_reset();
+};
+
+
+enum pte7300_mode_t
+{
+    PTE7300_CONTINUOUS,
+    PTE7300_IDLE,
+    PTE7300_SLEEP,
+};
+
+enum pte7300_fault_t
+{
+    PTE7300_HEALTHY,
+    PTE7300_NAK,                    // no ACK on its address (disconnected, dead)
+    PTE7300_CORRUPT,                // one data bit flipped in every read frame, after the CRC
+    PTE7300_FROZEN,                 // conversions stop, the DSP registers keep their last value
+    PTE7300_SATURATED,              // DSP_S reads full scale (open bridge)
+};
+
+typedef struct pte7300_stats_t
+{
+    uint32_t reads;                 // register read transfers
+    uint32_t writes;                // register write transfers
+    uint32_t crc_errors;            // rejected CRC frames
+    uint32_t commands;              // CMD register writes
+    uint32_t conversions;           // DSP register updates
+}pte7300_stats_t;
+
+class PTE7300Sim : public I2CSimDevice
+{
+public:
+    PTE7300Sim(uint8_t address = 0x6C, uint32_t serial = 0x7300CAFE);
+
+    // sensor inputs
+    void set_pressure_bar(float press);
+    void set_temperature_c(float temp);
+
+    // conversion period in continuous mode [us]; 0 tracks the inputs on every access
+    void set_conversion_period_us(uint32_t period) { conversion_period_us = period; }
+
+    // start-up after a RESET command, no conversion before [us]
+    void set_startup_us(uint32_t startup) { startup_us = startup; }
+
+    // uniform DSP_S noise of +-noise LSB on each conversion (a live bridge is never perfectly still)
+    void set_noise_lsb(int16_t noise) { noise_lsb = noise; }
+
+    void set_fault(pte7300_fault_t fault) { device_fault = fault; }
+    pte7300_fault_t fault() const { return device_fault; }
+
+    pte7300_mode_t mode() const { return device_mode; }
+    const pte7300_stats_t &stats() const { return device_stats; }
+    uint16_t get_register(uint8_t address) const { return regs[address & 0x7F]; }
+    void set_register(uint8_t address, uint16_t value) { regs[address & 0x7F] = value; }
+
+    bool responds_to(uint8_t address) const override;
+    bool write(uint8_t address, const uint8_t *data, size_t length) override;
+    size_t read(uint8_t address, uint8_t *data, size_t length) override;
+
+    static uint8_t crc4(uint8_t polynom, uint8_t init, const uint8_t *data, size_t len);
+    static uint8_t crc8(uint8_t polynom, uint8_t init, const uint8_t *data, size_t len);
+
+private:
+    uint8_t node_address;
+    uint32_t serial_number;
+    uint16_t regs[0x80];
+    uint8_t pointer;
+
+    // CRC read set-up (register pointer, word count, CRC8 of the request stub)
+    unsigned int crc_read_words;
+    uint8_t crc_read_hold;
+
+    pte7300_mode_t device_mode;
+    uint32_t conversion_period_us;
+    uint32_t startup_us;
+    uint64_t ready_us;              // end of the start-up
+    uint64_t next_conversion_us;
+    bool single_pending;
+    int16_t input_dsp_s;
+    int16_t input_dsp_t;
+    int16_t noise_lsb;
+    uint32_t noise_state;
+    pte7300_fault_t device_fault;
+    pte7300_stats_t device_stats;
+
+    void power_on_reset();
+    void convert();
+    void update_conversions();
+    void update_status();
+    void write_words(uint8_t address, const uint8_t *bytes, size_t n_words);
+    void execute(uint16_t command);
+};
+
+#endif // I2C_SIM_H
@@ -0,0 +1,61 @@
+/*
+ * File: ReplayBench.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the trace-fed sensor front-end declared in ReplayBench.h.
+ */
+
+#include "ReplayBench.h"
+#include "Wire.h"
+#include "constant.h"
+
+int pt1000_adc_code(float temp)
+{
+    float resistance = temp * 3.85f + 1000.0f;
+    float voltage = 3.3f * resistance / (1100.0f + resistance);
+    int code = (int)lroundf(voltage * 4095.0f / 3.3f);
+    return code < 0 ? 0 : (code > 4095 ? 4095 : code);
+}
+
+ReplayBench::ReplayBench(bool ccc_own_bus) : mux(MUX_ADDR, RESET), ein(SENS_ADDR), ccc(SENS_ADDR), oin(SENS_ADDR)
+{
+    bus.attach(&mux);
+    mux.attach(0, &ein);    // EIN_CH = 0x01
+    if (ccc_own_bus) {
+        ccc_bus.attach(&ccc);
+    } else {
+        mux.attach(1, &ccc);    // CCC_CH = 0x02
+    }
+    mux.attach(2, &oin);    // P_OIN  = 0x04 (Sensata variant)
+    bus.set_advance_clock(true);
+    ccc_bus.set_advance_clock(true);
+    SENSOR_WIRE.attach(&bus);
+    CCC_WIRE.attach(&ccc_bus);
+}
+
+ReplayBench::~ReplayBench()
+{
+    SENSOR_WIRE.attach(nullptr);
+    CCC_WIRE.attach(nullptr);
+}
+
+void ReplayBench::apply(const prb_log_sample_t &sample)
+{
+    const float *v = sample.values;
+    if (!isnan(v[LOG_CCC_PRESS])) ccc.set_pressure_bar(v[LOG_CCC_PRESS]);
+    if (!isnan(v[LOG_CCC_TEMP])) ccc.set_temperature_c(v[LOG_CCC_TEMP]);
+    if (!isnan(v[LOG_EIN_PRESS])) ein.set_pressure_bar(v[LOG_EIN_PRESS]);
+    if (!isnan(v[LOG_EIN_TEMP_SENSATA])) ein.set_temperature_c(v[LOG_EIN_TEMP_SENSATA]);
+    if (!isnan(v[LOG_OIN_TEMP])) host::set_analog(T_OIN, pt1000_adc_code(v[LOG_OIN_TEMP]));
+    if (!isnan(v[LOG_EIN_TEMP_PT1000])) host::set_analog(T_EIN, pt1000_adc_code(v[LOG_EIN_TEMP_PT1000]));
+    if (!isnan(v[LOG_OIN_PRESS])) {
+        if constexpr (PROFILE.kulite) {
+            // inverse of kulite_pressure_bar() (SignalMath.h)
+            host::set_analog(P_OIN, (int)lroundf(v[LOG_OIN_PRESS] / 1000.0f * 33.0f * 4095.0f / 3.3f));
+        } else {
+            oin.set_pressure_bar(v[LOG_OIN_PRESS]);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef REPLAY_BENCH_H
+#define REPLAY_BENCH_H
+/*
+ * File: ReplayBench.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Simulated sensor front-end of the PRB, fed from recorded traces: TCA multiplexer and the
+ *  three Sensata PTE7300 on Wire2 (EIN_CH, CCC_CH, P_OIN channels), PT1000 and Kulite on the
+ *  ADC pins. Shared by the host tools that run PRBComputer on traces (replay, fault_injection).
+ *
+ *  With ccc_own_bus the CCC sensor is alone on CCC_WIRE instead of behind the multiplexer, to
+ *  match a PRBComputer constructed with CCC_WIRE.
+ */
+
+#include "Arduino.h"
+#include "I2CSim.h"
+#include "common/prb_log.h"
+
+class ReplayBench
+{
+public:
+    ReplayBench(bool ccc_own_bus = false);
+    ~ReplayBench();
+
+    // sample-and-hold of one trace row on the sensor inputs (NAN columns are left unchanged)
+    void apply(const prb_log_sample_t &sample);
+
+    I2CSimBus bus;
+    I2CSimBus ccc_bus;              // CCC_WIRE, only with ccc_own_bus
+    MuxSim mux;
+    PTE7300Sim ein;
+    PTE7300Sim ccc;
+    PTE7300Sim oin;
+};
+
+// inverse of the PT1000 divider of pt1000_temperature_c() (SignalMath.h)
+int pt1000_adc_code(float temp);
+
+#endif // REPLAY_BENCH_H
@@ -0,0 +1,500 @@
+/*
+ * File: slave_load.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Load generator for the Wire1 slave protocol. Plays the master against the receiveEvent() /
+ *  requestEvent() handlers of main.cpp (built in with setup() and loop()) and sweeps the
+ *  transaction rate, to get the throughput / latency curve of the protocol and the cost of the
+ *  command handling on the control loop. The handlers run as interrupts of the virtual clock
+ *  (host::set_irq_hook): they preempt update() wherever it waits on the sensor bus, are held
+ *  back while interrupts are masked and take their time from it.
+ *
+ *  Master model (Raspberry Pi driver):
+ *    - transactions arrive at random (Poisson) at the offered rate, drawn from the command mix,
+ *      and queue behind the one on the bus; beyond MASTER_BACKLOG waiting they are dropped
+ *    - each transfer takes 9 bits per byte (address byte included) at --clock-hz, plus
+ *      MASTER_GAP_US of driver turnaround after each write / read pair
+ *    - a read is answered with the bytes requestEvent() wrote; the clock is stretched until
+ *      the handler has run, a stretch longer than --stretch-us makes the master give up and
+ *      the response counts as garbled
+ *  Slave model: each handler costs ISR_BASE_NS plus ISR_BYTE_NS per byte of its transfer
+ *  (byte interrupts of the Wire1 slave and handler body, Teensy 4.1 estimate).
+ *
+ *  Command mix (--mix poll=W,samples=W,valves=W,abort=W, relative weights):
+ *    - poll    : FSM_PRB or one sensor value, round robin: write [cmd], read 4 bytes; the value
+ *                must be the prb_memory_t field when the handler ran
+ *    - samples : PRB_NET_SAMPLES of one channel, round robin: write, read SAMPLE_FIFO_BLOCK;
+ *                the block must decode
+ *    - valves  : VALVES_STATE write (both closed) then read back, must be OFF / OFF
+ *    - abort   : ABORT_BURST ABORT writes, RESET, FSM_PRB read back, must be IDLE
+ *
+ *  For every rate (0 first: the unloaded control loop) the tool reports the achieved
+ *  transactions per second, the Wire1 bus occupancy, the master latency (arrival to end of
+ *  the last transfer) p50 / p99, the longest handler latency (due to run), dropped and garbled
+ *  transactions, stale poll responses (value older than --stale-ms), the update() duration
+ *  mean / max (handlers landing in it included), the CPU share of the handlers, and the host
+ *  time of requestEvent() p50 / p99 (the work done while the master clocks the read, to compare
+ *  firmware changes on the same machine).
+ *
+ *  Usage: slave_load [--rates R,R,...] [--mix poll=W,...] [--duration S] [--clock-hz HZ]
+ *                    [--stretch-us US] [--stale-ms MS] [--step-us US] [--seed N] [--csv]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <vector>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "PRBComputer.h"
+#include "sim/ReplayBench.h"
+
+#define MASTER_BACKLOG      16          // transactions waiting for the bus before the master drops
+#define MASTER_GAP_US       50.0        // driver turnaround between two transactions
+#define ISR_BASE_NS         2000        // handler entry, dispatch and exit
+#define ISR_BYTE_NS         500         // per byte of the transfer
+#define ABORT_BURST         3
+#define WARMUP_MS           4000        // past the start-up schedule before the first rate
+#define DEFAULT_STEP_US     10          // foreground time between two loop() calls
+
+// main.cpp
+void setup();
+void loop();
+extern PRBComputer computer;
+
+enum load_kind_t
+{
+    LOAD_POLL,
+    LOAD_SAMPLES,
+    LOAD_VALVES,
+    LOAD_ABORT,
+    LOAD_KINDS
+};
+
+static const char *const kind_names[LOAD_KINDS] = {"poll", "samples", "valves", "abort"};
+
+// one transfer of a transaction: a write of data, or a read of length bytes
+typedef struct transfer_t
+{
+    bool read;
+    uint8_t data[1 + AV_NET_XFER_SIZE];
+    uint8_t length;
+}transfer_t;
+
+typedef struct transaction_t
+{
+    load_kind_t kind;
+    double arrival_us;
+    std::vector<transfer_t> transfers;
+}transaction_t;
+
+typedef struct load_config_t
+{
+    double rate;                    // offered transactions / s
+    double weights[LOAD_KINDS];
+    double duration_s;
+    double clock_hz;
+    double stretch_us;
+    double stale_ms;
+    uint32_t step_us;
+    unsigned seed;
+}load_config_t;
+
+typedef struct load_report_t
+{
+    uint64_t offered;
+    uint64_t completed;
+    uint64_t dropped;
+    uint64_t garbled;
+    uint64_t stale;
+    uint64_t polls;
+    double bus_us;                  // Wire1 busy time
+    double isr_us;                  // handler time
+    double handler_max_us;          // longest due-to-run delay of a handler
+    double max_age_ms;              // oldest poll response
+    std::vector<double> latency_us;
+    std::vector<double> update_us;
+    std::vector<double> request_ns; // host time of requestEvent()
+}load_report_t;
+
+// ================= master =================
+static const uint8_t poll_commands[] = {AV_NET_PRB_FSM_PRB, AV_NET_PRB_P_OIN, AV_NET_PRB_T_FLS_0, AV_NET_PRB_P_EIN,
+    AV_NET_PRB_T_EIN, AV_NET_PRB_P_CCC, AV_NET_PRB_T_CCC, AV_NET_PRB_T_FLS_10};
+
+static struct master_t
+{
+    const load_config_t *config;
+    load_report_t *report;
+    std::mt19937 rng;
+    std::exponential_distribution<double> interval;
+    std::discrete_distribution<int> mix;
+    bool arrivals;                  // false while draining at the end of a run
+    double next_arrival_us;
+    std::deque<transaction_t> backlog;
+    bool busy;
+    transaction_t current;
+    size_t transfer;                // index in current.transfers
+    double event_us;                // end of the write / address byte of the current transfer
+    double bus_free_us;
+    uint32_t poll_index;
+    uint32_t samples_channel;
+    uint32_t next_seq[TLM_CHANNELS];
+    uint64_t isr_ns;                // handler time not yet charged to the clock
+    int64_t fresh_us[TLM_CHANNELS]; // end of the loop() that last acquired each channel
+}master;
+
+static double byte_us(int bytes)
+{
+    return bytes * 9.0 * 1e6 / master.config->clock_hz;
+}
+
+static transfer_t write_transfer(uint8_t cmd, uint8_t d0 = 0, uint8_t d1 = 0, uint8_t d2 = 0, uint8_t d3 = 0)
+{
+    return {false, {cmd, d0, d1, d2, d3}, 1 + AV_NET_XFER_SIZE};
+}
+
+static transfer_t command_transfer(uint8_t cmd)
+{
+    return {false, {cmd}, 1};      // selects the response of the next read, no handler action
+}
+
+static transfer_t read_transfer(uint8_t length)
+{
+    return {true, {}, length};
+}
+
+static transaction_t make_transaction(double arrival_us)
+{
+    transaction_t t;
+    t.kind = (load_kind_t)master.mix(master.rng);
+    t.arrival_us = arrival_us;
+    switch (t.kind) {
+    case LOAD_POLL:
+        t.transfers.push_back(command_transfer(poll_commands[master.poll_index++ % sizeof(poll_commands)]));
+        t.transfers.push_back(read_transfer(AV_NET_XFER_SIZE));
+        break;
+    case LOAD_SAMPLES: {
+        uint32_t c = master.samples_channel++ % TLM_CHANNELS;
+        uint32_t since = master.next_seq[c] & SAMPLE_FIFO_SEQ_MASK;
+        t.transfers.push_back(write_transfer(PRB_NET_SAMPLES, c, since, since >> 8, since >> 16));
+        t.transfers.push_back(read_transfer(SAMPLE_FIFO_BLOCK));
+        break;
+    }
+    case LOAD_VALVES:
+        t.transfers.push_back(write_transfer(AV_NET_PRB_VALVES_STATE, AV_NET_CMD_OFF, AV_NET_CMD_OFF));
+        t.transfers.push_back(read_transfer(AV_NET_XFER_SIZE));
+        break;
+    default:
+        for (int i = 0; i < ABORT_BURST; i++) t.transfers.push_back(write_transfer(AV_NET_PRB_ABORT, AV_NET_CMD_OFF));
+        t.transfers.push_back(write_transfer(AV_NET_PRB_RESET));
+        t.transfers.push_back(command_transfer(AV_NET_PRB_FSM_PRB));
+        t.transfers.push_back(read_transfer(AV_NET_XFER_SIZE));
+        break;
+    }
+    return t;
+}
+
+// the handler time is charged to the virtual clock in whole microseconds
+static void charge_isr(int bytes)
+{
+    uint64_t ns = ISR_BASE_NS + (uint64_t)ISR_BYTE_NS * bytes;
+    master.report->isr_us += ns / 1000.0;
+    master.isr_ns += ns;
+    host::advance_us(master.isr_ns / 1000);
+    master.isr_ns %= 1000;
+}
+
+static int poll_channel(uint8_t cmd)
+{
+    switch (cmd) {
+    case AV_NET_PRB_P_OIN: return TLM_OIN_PRESS;
+    case AV_NET_PRB_T_FLS_0: return TLM_OIN_TEMP;
+    case AV_NET_PRB_P_EIN: return TLM_EIN_PRESS;
+    case AV_NET_PRB_T_EIN: return TLM_EIN_TEMP_SENSATA;
+    case AV_NET_PRB_P_CCC: return TLM_CCC_PRESS;
+    case AV_NET_PRB_T_CCC: return TLM_CCC_TEMP;
+    case AV_NET_PRB_T_FLS_10: return TLM_EIN_TEMP_PT1000;
+    default: return -1;
+    }
+}
+
+static float channel_value(const prb_memory_t &memory, int channel)
+{
+    const float values[TLM_CHANNELS] = {memory.ccc_press, memory.ein_press, memory.ccc_temp,
+        memory.ein_temp_sensata, memory.oin_temp, memory.ein_temp_pt1000, memory.oin_press};
+    return values[channel];
+}
+
+// checks a read response against the state seen when the handler ran
+static bool response_ok(const transaction_t &t, const uint8_t *response, size_t length, uint8_t last_cmd)
+{
+    uint32_t word = 0;
+    if (length >= AV_NET_XFER_SIZE) memcpy(&word, response, AV_NET_XFER_SIZE);
+
+    switch (t.kind) {
+    case LOAD_POLL: {
+        if (length != AV_NET_XFER_SIZE) return false;
+        if (last_cmd == AV_NET_PRB_FSM_PRB) return word == (uint32_t)computer.get_state();
+        int channel = poll_channel(last_cmd);
+        float value;
+        memcpy(&value, response, sizeof(value));
+        float expected = channel_value(computer.get_memory(), channel);
+        if (isnan(expected)) return isnan(value);
+
+        double age_ms = (host::time_us() - master.fresh_us[channel]) / 1000.0;
+        master.report->polls++;
+        master.report->max_age_ms = std::max(master.report->max_age_ms, age_ms);
+        if (master.fresh_us[channel] < 0 || age_ms > master.config->stale_ms) master.report->stale++;
+        return value == expected;
+    }
+    case LOAD_SAMPLES: {
+        sample_block_t decoded;
+        uint32_t c = t.transfers[0].data[1];
+        if (length != SAMPLE_FIFO_BLOCK || !fifo_block_decode(response, length, &decoded) || decoded.channel != c) return false;
+        master.next_seq[c] = decoded.first_seq + decoded.count;
+        return true;
+    }
+    case LOAD_VALVES:
+        return length == AV_NET_XFER_SIZE && word == (uint32_t)((AV_NET_CMD_OFF << 8) | AV_NET_CMD_OFF);
+    default:
+        return length == AV_NET_XFER_SIZE && word == (uint32_t)IDLE;
+    }
+}
+
+static void start_transfer(double start_us)
+{
+    const transfer_t &transfer = master.current.transfers[master.transfer];
+    // a write runs its handler at the STOP, a read after the address byte
+    double bytes = transfer.read ? 1 : 1 + transfer.length;
+    master.event_us = start_us + byte_us(bytes);
+    master.report->bus_us += byte_us(bytes);
+}
+
+static void start_next(double now_us)
+{
+    if (master.busy || master.backlog.empty()) return;
+    master.current = master.backlog.front();
+    master.backlog.pop_front();
+    master.busy = true;
+    master.transfer = 0;
+    start_transfer(std::max(now_us, master.bus_free_us));
+}
+
+// end of a write, or address byte of a read: the slave interrupt
+static void transfer_event()
+{
+    const transfer_t &transfer = master.current.transfers[master.transfer];
+    double due_us = master.event_us;
+    double late_us = std::max(0.0, host::time_us() - ceil(due_us));    // the clock ticks in whole us
+    master.report->handler_max_us = std::max(master.report->handler_max_us, late_us);
+
+    double end_us;
+    if (!transfer.read) {
+        Wire1.slave_receive(transfer.data, transfer.length);
+        charge_isr(transfer.length);
+        end_us = due_us;
+    } else {
+        // the command of the read is the last one written
+        uint8_t last_cmd = master.current.transfers[master.transfer - 1].data[0];
+        uint8_t response[SAMPLE_FIFO_BLOCK] = {};
+        auto start = std::chrono::steady_clock::now();
+        size_t length = Wire1.slave_request(response, transfer.length);
+        master.report->request_ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+        bool ok = late_us <= master.config->stretch_us && response_ok(master.current, response, length, last_cmd);
+        if (!ok) master.report->garbled++;
+        charge_isr(transfer.length);
+        // clock stretched until the handler is done, then the data bytes
+        double stretch_us = std::max(0.0, host::time_us() - due_us);
+        end_us = due_us + stretch_us + byte_us(transfer.length);
+        master.report->bus_us += stretch_us + byte_us(transfer.length);
+    }
+
+    if (++master.transfer < master.current.transfers.size()) {
+        bool pair = master.current.transfers[master.transfer].read;  // repeated start
+        start_transfer(pair ? end_us : end_us + MASTER_GAP_US);
+        return;
+    }
+    master.report->completed++;
+    master.report->latency_us.push_back(end_us - master.current.arrival_us);
+    master.busy = false;
+    master.bus_free_us = end_us + MASTER_GAP_US;
+    start_next(master.bus_free_us);
+}
+
+static double next_master_event()
+{
+    double next = master.arrivals ? master.next_arrival_us : INFINITY;
+    if (master.busy) next = std::min(next, master.event_us);
+    return next;
+}
+
+// interrupt source of the host clock: master events in time order, slave handlers as they come due
+static uint64_t master_irq(uint64_t now_us)
+{
+    for (;;) {
+        double next = next_master_event();
+        if (isinf(next)) return UINT64_MAX;
+        if (next > host::time_us()) return (uint64_t)ceil(next);
+
+        if (master.busy && master.event_us == next) {
+            transfer_event();
+        } else {
+            master.report->offered++;
+            if (master.backlog.size() >= MASTER_BACKLOG) master.report->dropped++;
+            else master.backlog.push_back(make_transaction(next));
+            master.next_arrival_us = next + master.interval(master.rng);
+            start_next(next);
+        }
+    }
+}
+
+static double percentile(std::vector<double> &values, double p)
+{
+    if (values.empty()) return 0.0;
+    size_t k = std::min(values.size() - 1, (size_t)(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+// runs the control loop for one rate, then drains the master
+static load_report_t run(const load_config_t &config)
+{
+    load_report_t report = {};
+    master.config = &config;
+    master.report = &report;
+    master.rng.seed(config.seed);
+    master.interval = std::exponential_distribution<double>(config.rate > 0 ? config.rate / 1e6 : 1.0);
+    master.mix = std::discrete_distribution<int>(config.weights, config.weights + LOAD_KINDS);
+    master.arrivals = config.rate > 0;
+    master.backlog.clear();
+    master.busy = false;
+    master.bus_free_us = host::time_us();
+    master.next_arrival_us = host::time_us() + master.interval(master.rng);
+    host::set_irq_hook(master_irq, master.arrivals ? (uint64_t)ceil(master.next_arrival_us) : UINT64_MAX);
+
+    uint64_t end_us = host::time_us() + (uint64_t)(config.duration_s * 1e6);
+    while (host::time_us() < end_us || master.busy || !master.backlog.empty()) {
+        bool measured = host::time_us() < end_us;
+        if (!measured) master.arrivals = false;
+
+        uint64_t start = host::time_us();
+        loop();
+        if (measured) report.update_us.push_back((double)(host::time_us() - start));
+
+        uint8_t fresh = computer.get_memory().fresh_samples;
+        for (int c = 0; c < TLM_CHANNELS; c++) {
+            if (fresh & (1 << c)) master.fresh_us[c] = (int64_t)host::time_us();
+        }
+        host::advance_us(config.step_us);
+    }
+    host::set_irq_hook(nullptr, 0);
+    return report;
+}
+
+static bool parse_mix(const char *text, double *weights)
+{
+    for (int k = 0; k < LOAD_KINDS; k++) weights[k] = 0.0;
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    for (char *item = strtok(buffer, ","); item; item = strtok(nullptr, ",")) {
+        char *equal = strchr(item, '=');
+        if (!equal) return false;
+        *equal = '\0';
+        int k = 0;
+        while (k < LOAD_KINDS && strcmp(item, kind_names[k])) k++;
+        if (k == LOAD_KINDS) return false;
+        weights[k] = atof(equal + 1);
+    }
+    double total = 0.0;
+    for (int k = 0; k < LOAD_KINDS; k++) total += weights[k];
+    return total > 0.0;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: slave_load [--rates R,R,...] [--mix poll=W,samples=W,valves=W,abort=W] [--duration S] "
+                    "[--clock-hz HZ] [--stretch-us US] [--stale-ms MS] [--step-us US] [--seed N] [--csv]\n");
+}
+
+int main(int argc, char **argv)
+{
+    load_config_t config = {0.0, {16.0, 2.0, 1.0, 1.0}, 5.0, 400000.0, 100.0, 1.5 * SAMPLE_IDLE_MS, DEFAULT_STEP_US, 1234};
+    std::vector<double> rates = {0, 100, 200, 500, 1000, 2000, 3000, 4000, 5000, 7500, 10000};
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rates") && i + 1 < argc) {
+            rates.clear();
+            char buffer[256];
+            snprintf(buffer, sizeof(buffer), "%s", argv[++i]);
+            for (char *item = strtok(buffer, ","); item; item = strtok(nullptr, ",")) rates.push_back(atof(item));
+        }
+        else if (!strcmp(argv[i], "--mix") && i + 1 < argc) {
+            if (!parse_mix(argv[++i], config.weights)) { usage(); return 2; }
+        }
+        else if (!strcmp(argv[i], "--duration") && i + 1 < argc) config.duration_s = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--clock-hz") && i + 1 < argc) config.clock_hz = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--stretch-us") && i + 1 < argc) config.stretch_us = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--stale-ms") && i + 1 < argc) config.stale_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--step-us") && i + 1 < argc) config.step_us = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) config.seed = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else { usage(); return 2; }
+    }
+    if (rates.empty() || config.duration_s <= 0 || config.clock_hz <= 0 || config.step_us == 0) {
+        usage();
+        return 2;
+    }
+
+    // the firmware as flashed, sensors at rest, past the start-up schedule
+    host::reset();
+    ReplayBench bench;
+    prb_log_sample_t rest = {0, {0.0f, 45.0f, 20.0f, 15.0f, -180.0f, 15.0f, 40.0f}};
+    bench.apply(rest);
+    setup();
+    for (int c = 0; c < TLM_CHANNELS; c++) master.fresh_us[c] = -1;
+    master.poll_index = 0;
+    master.samples_channel = 0;
+    memset(master.next_seq, 0, sizeof(master.next_seq));
+    load_config_t warmup = config;
+    warmup.rate = 0;
+    warmup.duration_s = WARMUP_MS / 1000.0;
+    run(warmup);
+
+    if (csv) printf("offered_per_s,achieved_per_s,bus_pct,latency_p50_us,latency_p99_us,handler_max_us,dropped,garbled,stale,"
+                    "update_mean_us,update_max_us,isr_cpu_pct,request_p50_ns,request_p99_ns\n");
+    else printf("  offered  achieved   bus %%  latency p50 / p99 [us]  handler max  dropped  garbled  stale  update() mean / max [us]  isr %%  request [ns] p50 / p99\n");
+
+    for (double rate : rates) {
+        config.rate = rate;
+        load_report_t r = run(config);
+
+        double span_us = config.duration_s * 1e6;
+        double update_mean = 0.0;
+        for (double d : r.update_us) update_mean += d;
+        if (!r.update_us.empty()) update_mean /= r.update_us.size();
+        double update_max = r.update_us.empty() ? 0.0 : *std::max_element(r.update_us.begin(), r.update_us.end());
+        double p50 = percentile(r.latency_us, 0.50);
+        double p99 = percentile(r.latency_us, 0.99);
+        double request_p50 = percentile(r.request_ns, 0.50);
+        double request_p99 = percentile(r.request_ns, 0.99);
+
+        if (csv) {
+            printf("%.0f,%.1f,%.2f,%.1f,%.1f,%.1f,%llu,%llu,%llu,%.2f,%.1f,%.3f,%.0f,%.0f\n", rate, r.completed / config.duration_s,
+                   100.0 * r.bus_us / span_us, p50, p99, r.handler_max_us, (unsigned long long)r.dropped,
+                   (unsigned long long)r.garbled, (unsigned long long)r.stale, update_mean, update_max,
+                   100.0 * r.isr_us / span_us, request_p50, request_p99);
+        } else {
+            printf("  %7.0f  %8.1f  %5.1f  %10.1f / %-10.1f  %11.1f  %7llu  %7llu  %5llu  %12.2f / %-9.1f  %5.2f  %10.0f / %.0f\n",
+                   rate, r.completed / config.duration_s, 100.0 * r.bus_us / span_us, p50, p99, r.handler_max_us,
+                   (unsigned long long)r.dropped, (unsigned long long)r.garbled, (unsigned long long)r.stale,
+                   update_mean, update_max, 100.0 * r.isr_us / span_us, request_p50, request_p99);
+        }
+    }
+    return 0;
+}
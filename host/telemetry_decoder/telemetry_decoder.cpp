@@ -0,0 +1,349 @@
+/*
+ * File: telemetry_decoder.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Host decoder of the binary telemetry stream (see src/Telemetry.h). Reads the COBS frames
+ *  from the Teensy USB serial device, a capture file or stdin, checks their CRC and sequence
+ *  numbers and writes, live while the bench runs:
+ *    - PREFIX_samples.csv (t_us,channel,value) and PREFIX_events.csv (t_us,kind,a0,a1,a2,a3)
+ *    - a .prbl columnar log (samples and events tables), readable by replay and post_fire
+ *
+ *  Usage: telemetry_decoder [--csv PREFIX] [--log FILE.prbl] input
+ *    input is a serial device (put in raw mode), a capture file, or '-' for stdin
+ *
+ *  Packed sample records (TLM_SAMPLES) are decoded with SampleCodec: after a lost frame, each
+ *  channel is skipped until its next absolute value.
+ *
+ *  Times are on the master clock once the PRB got its first AV_NET_PRB_TIMESTAMP (ClockSync),
+ *  micros() of the PRB before: they step once at the first exchange.
+ *
+ *  Statistics (frames, CRC errors, frames lost in transit, frames dropped on the PRB, worst
+ *  loop times, achieved sample rates, clock sync state and idle power reported by the PRB) are
+ *  printed on stderr at the end of the input or on Ctrl-C.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "Telemetry.h"
+#include "common/prb_log.h"
+
+static_assert((int)TLM_CHANNELS == (int)LOG_SAMPLE_CHANNELS, "telemetry channels must match the log columns");
+
+typedef struct decoder_stats_t
+{
+    uint64_t frames;
+    uint64_t bad_frames;            // COBS or CRC errors
+    uint64_t lost;                  // sequence gaps
+    uint64_t unsynced;              // packed samples skipped until their next absolute value
+    uint32_t prb_sent;              // last TLM_STATS report
+    uint32_t prb_dropped;
+    uint32_t control_cycles_max;    // worst FSM tick over all reports
+    uint32_t sweep_cycles_max;      // worst sensor sweep over all reports
+    int32_t time_ready;             // every channel sampled [ms after reset], -1 not yet / not reported
+    uint16_t rates[TLM_CHANNELS];   // last TLM_RATES report [0.1 Hz]
+    uint16_t rates_max[TLM_CHANNELS]; // highest rate of every channel over all reports [0.1 Hz]
+    float sync_error;               // last TLM_CLOCK report [us], NAN while unsynced
+    float sync_error_max;           // worst synced report [us]
+    float drift_ppm;
+    uint16_t sync_exchanges;
+    uint16_t sync_rejected;
+    bool power;                     // TLM_POWER reports received (profile idle_sleep)
+    uint16_t awake_duty;            // last TLM_POWER report [0.1 %]
+    uint16_t awake_duty_min;        // lowest over all reports [0.1 %]
+    bool sensata_asleep;
+    int32_t wake_latency_us;        // last Sensata wake-up [us], -1 none yet
+}decoder_stats_t;
+
+static volatile sig_atomic_t stop_requested = 0;
+static void on_signal(int) { stop_requested = 1; }
+
+class TelemetryDecoder
+{
+public:
+    TelemetryDecoder() : samples_csv(nullptr), events_csv(nullptr), log(nullptr), frame_length(0),
+                         last_seq(-1), last_t_us(0), t_offset_us(0)
+    {
+        memset(&stats, 0, sizeof(stats));
+        stats.sync_error = NAN;
+        stats.time_ready = -1;
+        stats.wake_latency_us = -1;
+        codec_reset(&codec);
+    }
+
+    void feed(const uint8_t *data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++) {
+            if (data[i] == 0x00) {
+                if (frame_length > 0) decode_frame();
+                frame_length = 0;
+            } else if (frame_length < sizeof(frame)) {
+                frame[frame_length++] = data[i];
+            } else {
+                frame_length = sizeof(frame) + 1;   // oversized, drop until next delimiter
+            }
+        }
+    }
+
+    FILE *samples_csv;
+    FILE *events_csv;
+    PRBLogWriter *log;
+    decoder_stats_t stats;
+
+private:
+    uint8_t frame[TLM_MAX_FRAME];
+    size_t frame_length;
+    int last_seq;
+    uint32_t last_t_us;
+    int64_t t_offset_us;
+    sample_codec_t codec;           // decoder of the TLM_SAMPLES records
+
+    // micros() wraps every ~71 minutes
+    int64_t unwrap(uint32_t t_us)
+    {
+        if (stats.frames > 0 && t_us < last_t_us && last_t_us - t_us > 0x80000000u) t_offset_us += 0x100000000LL;
+        last_t_us = t_us;
+        return t_offset_us + t_us;
+    }
+
+    void decode_frame()
+    {
+        uint8_t payload[TLM_MAX_FRAME];
+        if (frame_length > sizeof(frame)) {
+            stats.bad_frames++;
+            return;
+        }
+        size_t length = cobs_decode(frame, frame_length, payload);
+        if (length < TLM_HEADER_SIZE + TLM_CRC_SIZE) {
+            stats.bad_frames++;
+            return;
+        }
+        length -= TLM_CRC_SIZE;
+        uint16_t crc = (uint16_t)(payload[length] | (payload[length + 1] << 8));
+        if (crc != crc16_ccitt(payload, length)) {
+            stats.bad_frames++;
+            return;
+        }
+
+        uint8_t type = payload[0];
+        uint8_t seq = payload[1];
+        uint32_t t_raw;
+        memcpy(&t_raw, payload + 2, 4);
+        uint8_t gap = last_seq >= 0 ? (uint8_t)(seq - last_seq - 1) : 0;
+        stats.lost += gap;
+        last_seq = seq;
+        // a lost record breaks the delta chain, wait for absolute values
+        if (gap) codec_reset(&codec);
+
+        int64_t t_us = unwrap(t_raw);
+        stats.frames++;
+        const uint8_t *body = payload + TLM_HEADER_SIZE;
+        size_t body_length = length - TLM_HEADER_SIZE;
+
+        switch (type) {
+        case TLM_SAMPLE: {
+            if (body_length < 5 || body[0] >= TLM_CHANNELS) break;
+            float value;
+            memcpy(&value, body + 1, 4);
+            if (samples_csv) fprintf(samples_csv, "%lld,%s,%g\n", (long long)t_us, prb_log_channel_names[body[0]], value);
+            if (log) {
+                prb_log_sample_t sample;
+                sample.t_us = t_us;
+                for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) sample.values[c] = NAN;
+                sample.values[body[0]] = value;
+                log->append(sample);
+            }
+            break;
+        }
+        case TLM_SAMPLES: {
+            sample_record_t record;
+            if (!codec_decode(&codec, body, body_length, &record)) {
+                codec_reset(&codec);
+                break;
+            }
+            stats.unsynced += __builtin_popcount((body[0] & 0x7F) & ~record.mask);
+            if (!record.mask) break;
+            // sample time, relative to the frame time stamp
+            int64_t t_sample = t_us - (int32_t)(t_raw - record.t_us);
+            prb_log_sample_t sample;
+            sample.t_us = t_sample;
+            for (int c = 0; c < LOG_SAMPLE_CHANNELS; c++) {
+                sample.values[c] = record.values[c];
+                if (samples_csv && (record.mask & (1 << c))) {
+                    fprintf(samples_csv, "%lld,%s,%g\n", (long long)t_sample, prb_log_channel_names[c], record.values[c]);
+                }
+            }
+            if (log) log->append(sample);
+            break;
+        }
+        case TLM_STATE:
+        case TLM_VALVE: {
+            prb_log_event_t event;
+            memset(&event, 0, sizeof(event));
+            event.t_us = t_us;
+            event.kind = (type == TLM_STATE) ? LOG_EVENT_STATE : LOG_EVENT_VALVE;
+            for (size_t a = 0; a < body_length && a < PRB_LOG_EVENT_ARGS; a++) event.args[a] = body[a];
+            if (events_csv) {
+                fprintf(events_csv, "%lld,%s,%u,%u,%u,%u\n", (long long)t_us, type == TLM_STATE ? "state" : "valve",
+                        event.args[0], event.args[1], event.args[2], event.args[3]);
+            }
+            if (log) log->append(event);
+            break;
+        }
+        case TLM_STATS:
+            if (body_length < 8) break;
+            memcpy(&stats.prb_sent, body, 4);
+            memcpy(&stats.prb_dropped, body + 4, 4);
+            if (body_length >= 16) {
+                uint32_t control_cycles, sweep_cycles;
+                memcpy(&control_cycles, body + 8, 4);
+                memcpy(&sweep_cycles, body + 12, 4);
+                if (control_cycles > stats.control_cycles_max) stats.control_cycles_max = control_cycles;
+                if (sweep_cycles > stats.sweep_cycles_max) stats.sweep_cycles_max = sweep_cycles;
+            }
+            if (body_length >= 20) memcpy(&stats.time_ready, body + 16, 4);
+            break;
+        case TLM_RATES:
+            if (body_length < sizeof(stats.rates)) break;
+            memcpy(stats.rates, body, sizeof(stats.rates));
+            for (int c = 0; c < TLM_CHANNELS; c++) {
+                if (stats.rates[c] > stats.rates_max[c]) stats.rates_max[c] = stats.rates[c];
+            }
+            break;
+        case TLM_CLOCK:
+            if (body_length < 12) break;
+            memcpy(&stats.sync_error, body, 4);
+            memcpy(&stats.drift_ppm, body + 4, 4);
+            memcpy(&stats.sync_exchanges, body + 8, 2);
+            memcpy(&stats.sync_rejected, body + 10, 2);
+            if (stats.sync_error > stats.sync_error_max) stats.sync_error_max = stats.sync_error;
+            break;
+        case TLM_POWER:
+            if (body_length < 7) break;
+            memcpy(&stats.awake_duty, body, 2);
+            stats.sensata_asleep = body[2];
+            memcpy(&stats.wake_latency_us, body + 3, 4);
+            if (!stats.power || stats.awake_duty < stats.awake_duty_min) stats.awake_duty_min = stats.awake_duty;
+            stats.power = true;
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+static int open_input(const char *path)
+{
+    if (strcmp(path, "-") == 0) return STDIN_FILENO;
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd >= 0 && isatty(fd)) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tio.c_cc[VMIN] = 1;
+            tio.c_cc[VTIME] = 0;
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+    return fd;
+}
+
+static FILE *open_csv(const char *prefix, const char *suffix, const char *header)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, suffix);
+    FILE *file = fopen(path, "w");
+    if (file) fprintf(file, "%s\n", header);
+    return file;
+}
+
+int main(int argc, char **argv)
+{
+    const char *csv_prefix = nullptr;
+    const char *log_path = nullptr;
+    const char *input = nullptr;
+    bool bad_usage = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--csv") && i + 1 < argc) csv_prefix = argv[++i];
+        else if (!strcmp(argv[i], "--log") && i + 1 < argc) log_path = argv[++i];
+        else if (argv[i][0] == '-' && argv[i][1] != '\0') bad_usage = true;
+        else input = argv[i];
+    }
+    if (!input || bad_usage) {
+        fprintf(stderr, "usage: telemetry_decoder [--csv PREFIX] [--log FILE.prbl] input\n");
+        return 2;
+    }
+
+    int fd = open_input(input);
+    if (fd < 0) {
+        fprintf(stderr, "telemetry_decoder: cannot open %s\n", input);
+        return 1;
+    }
+
+    TelemetryDecoder decoder;
+    PRBLogWriter log;
+    if (csv_prefix) {
+        decoder.samples_csv = open_csv(csv_prefix, "samples", "t_us,channel,value");
+        decoder.events_csv = open_csv(csv_prefix, "events", "t_us,kind,a0,a1,a2,a3");
+    }
+    if (log_path) {
+        if (!log.open(log_path)) {
+            fprintf(stderr, "telemetry_decoder: cannot create %s\n", log_path);
+            return 1;
+        }
+        decoder.log = &log;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    uint8_t buffer[4096];
+    while (!stop_requested) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        decoder.feed(buffer, (size_t)n);
+        // keep the outputs readable while the bench is running
+        if (decoder.samples_csv) fflush(decoder.samples_csv);
+        if (decoder.events_csv) fflush(decoder.events_csv);
+    }
+
+    log.close();
+    if (decoder.samples_csv) fclose(decoder.samples_csv);
+    if (decoder.events_csv) fclose(decoder.events_csv);
+
+    const decoder_stats_t &s = decoder.stats;
+    fprintf(stderr, "frames %llu, bad %llu, lost in transit %llu, dropped on PRB %u (of %u sent)\n",
+            (unsigned long long)s.frames, (unsigned long long)s.bad_frames, (unsigned long long)s.lost,
+            s.prb_dropped, s.prb_sent);
+    fprintf(stderr, "samples skipped while resyncing %llu\n", (unsigned long long)s.unsynced);
+    fprintf(stderr, "worst FSM tick %.1f us, worst sensor sweep %.1f us\n",
+            s.control_cycles_max / (F_CPU_ACTUAL / 1e6), s.sweep_cycles_max / (F_CPU_ACTUAL / 1e6));
+    if (s.time_ready >= 0) fprintf(stderr, "every channel sampled %d ms after reset\n", s.time_ready);
+    else fprintf(stderr, "every channel sampled: not yet\n");
+    fprintf(stderr, "sample rate [Hz] last / max:");
+    for (int c = 0; c < TLM_CHANNELS; c++) {
+        fprintf(stderr, " %s %.1f / %.1f", prb_log_channel_names[c], s.rates[c] / 10.0, s.rates_max[c] / 10.0);
+    }
+    fprintf(stderr, "\n");
+    if (isnan(s.sync_error)) {
+        fprintf(stderr, "clock sync: none, local PRB times (%u exchanges)\n", s.sync_exchanges);
+    } else {
+        fprintf(stderr, "clock sync: error last %.1f / max %.1f us, drift %.2f ppm, %u exchanges (%u rejected)\n",
+                s.sync_error, s.sync_error_max, s.drift_ppm, s.sync_exchanges, s.sync_rejected);
+    }
+    if (s.power) {
+        fprintf(stderr, "idle power: awake last %.1f / min %.1f %%, Sensatas %s, ", s.awake_duty / 10.0,
+                s.awake_duty_min / 10.0, s.sensata_asleep ? "asleep" : "awake");
+        if (s.wake_latency_us >= 0) fprintf(stderr, "last wake-up %d us\n", s.wake_latency_us);
+        else fprintf(stderr, "no wake-up yet\n");
+    }
+    return 0;
+}
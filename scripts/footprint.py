@@ -0,0 +1,59 @@
+# File: footprint.py
+# Author: C - AV Team
+# Last update: 18/10/2026
+#
+# Description:
+#  PlatformIO post-build script of the firmware environments (extra_scripts in platformio.ini).
+#  Reads the section sizes of the linked firmware and reports, per build profile:
+#    - FLASH: everything stored in the 8 MB flash (code, read-only and initialised data)
+#    - ITCM:  FASTRUN / default code copied to ITCM, rounded up to the 32 kB banks it takes
+#    - DTCM:  static data (.data + .bss), shares the 512 kB RAM1 with ITCM
+#    - RAM2:  DMAMEM (.bss.dma)
+#  The line is printed and appended to .pio/footprint.csv to compare the cost of each profile.
+
+import os
+import subprocess
+
+Import("env")
+
+FLASH_SECTIONS = (".text.headers", ".text.code", ".text.progmem", ".text.itcm", ".ARM.exidx", ".data", ".text.csf")
+ITCM_SECTIONS = (".text.itcm", ".ARM.exidx")
+DTCM_SECTIONS = (".data", ".bss")
+RAM2_SECTIONS = (".bss.dma",)
+
+ITCM_BANK = 32 * 1024
+RAM1_SIZE = 512 * 1024
+RAM2_SIZE = 512 * 1024
+
+
+def section_sizes(elf):
+    output = subprocess.run([env.subst("$SIZETOOL"), "-A", elf], capture_output=True, text=True, check=True).stdout
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[1].isdigit():
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def report(source, target, env):
+    sizes = section_sizes(str(target[0]))
+    flash = sum(sizes.get(name, 0) for name in FLASH_SECTIONS)
+    itcm = sum(sizes.get(name, 0) for name in ITCM_SECTIONS)
+    itcm_banks = (itcm + ITCM_BANK - 1) // ITCM_BANK * ITCM_BANK
+    dtcm = sum(sizes.get(name, 0) for name in DTCM_SECTIONS)
+    ram2 = sum(sizes.get(name, 0) for name in RAM2_SECTIONS)
+    profile = env["PIOENV"]
+
+    print("Footprint [%s]: FLASH %d B, ITCM %d B (%d kB banks), DTCM %d B, RAM1 free %d B, RAM2 %d B (free %d B)"
+          % (profile, flash, itcm, itcm_banks // 1024, dtcm, RAM1_SIZE - itcm_banks - dtcm, ram2, RAM2_SIZE - ram2))
+
+    path = os.path.join(env.subst("$PROJECT_DIR"), ".pio", "footprint.csv")
+    new_file = not os.path.exists(path)
+    with open(path, "a") as csv:
+        if new_file:
+            csv.write("profile,flash,itcm,itcm_banks,dtcm,ram2\n")
+        csv.write("%s,%d,%d,%d,%d,%d\n" % (profile, flash, itcm, itcm_banks, dtcm, ram2))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)
@@ -0,0 +1,110 @@
+/*
+ * File: ClockSync.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the master clock estimate declared in ClockSync.h.
+ */
+
+#include "ClockSync.h"
+
+void clock_sync_reset(clock_sync_t *sync)
+{
+    sync->time_us = 0;
+    sync->offset_us = 0;
+    sync->offset_frac = 0.0;
+    sync->drift = 0.0;
+    sync->error = 0.0;
+    sync->exchanges = 0;
+    sync->rejected = 0;
+    sync->outliers = 0;
+    sync->samples = 0;
+}
+
+// moves the offset by delta [us], keeping the fractional part in [-0.5, 0.5]
+static inline void shift_offset(clock_sync_t *sync, float delta)
+{
+    float offset = sync->offset_frac + delta;
+    int32_t whole = lroundf(offset);
+    sync->offset_us += whole;
+    sync->offset_frac = offset - whole;
+}
+
+/**
+ * @brief Corrects the estimate with one exchange.
+ *
+ * @param local_us  micros() when the AV_NET_PRB_TIMESTAMP command was received.
+ * @param master_us Master time sent with the command.
+ * @return false if the exchange was rejected as an outlier.
+ */
+bool clock_sync_update(clock_sync_t *sync, uint32_t local_us, uint32_t master_us)
+{
+    uint32_t measured = master_us + CLOCK_SYNC_LATENCY_US - local_us;
+
+    if (sync->samples == 0) {
+        sync->time_us = local_us;
+        sync->offset_us = measured;
+        sync->offset_frac = 0.0;
+        sync->drift = 0.0;
+        sync->error = 0.0;
+        sync->outliers = 0;
+        sync->samples = 1;
+        if (sync->exchanges < UINT16_MAX) sync->exchanges++;
+        return true;
+    }
+
+    int32_t dt = (int32_t)(local_us - sync->time_us);
+    float predicted = sync->offset_frac + sync->drift * dt;
+    float residual = (float)(int32_t)(measured - sync->offset_us) - predicted;
+
+    if (sync->samples == 2 && fabsf(residual) > CLOCK_SYNC_OUTLIER_US) {
+        if (sync->rejected < UINT16_MAX) sync->rejected++;
+        if (++sync->outliers < CLOCK_SYNC_MAX_REJECTS) return false;
+        // the master clock jumped: restart from this exchange
+        sync->samples = 0;
+        return clock_sync_update(sync, local_us, master_us);
+    }
+    sync->outliers = 0;
+    if (sync->exchanges < UINT16_MAX) sync->exchanges++;
+
+    if (sync->samples == 1) {
+        // the drift needs two exchanges far enough apart, else only the offset moves
+        if (dt >= CLOCK_SYNC_MIN_DT_US) {
+            sync->drift = residual / dt;
+            sync->samples = 2;
+        }
+        shift_offset(sync, residual);
+        sync->time_us = local_us;
+        return true;
+    }
+
+    shift_offset(sync, sync->drift * dt + CLOCK_SYNC_ALPHA * residual);
+    if (dt >= CLOCK_SYNC_MIN_DT_US) sync->drift += CLOCK_SYNC_BETA / dt * residual;
+    sync->time_us = local_us;
+
+    float variance = sync->error * sync->error;
+    variance += CLOCK_SYNC_STATS_GAIN * (residual * residual - variance);
+    sync->error = sqrtf(variance);
+    return true;
+}
+
+/**
+ * @brief Master time at local time local_us, local_us itself before the first exchange.
+ */
+FASTRUN uint32_t clock_sync_time(const clock_sync_t *sync, uint32_t local_us)
+{
+    if (sync->samples == 0) return local_us;
+    int32_t dt = (int32_t)(local_us - sync->time_us);
+    return local_us + sync->offset_us + lroundf(sync->offset_frac + sync->drift * dt);
+}
+
+/**
+ * @brief Estimated error of clock_sync_time() at local_us [us], NAN before the drift is known.
+ */
+float clock_sync_error(const clock_sync_t *sync, uint32_t local_us)
+{
+    if (sync->samples < 2) return NAN;
+    uint32_t age = local_us - sync->time_us;
+    return sync->error + CLOCK_SYNC_WANDER * age;
+}
@@ -0,0 +1,49 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+/*
+ * File: ClockSync.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Estimate of the master clock from the AV_NET_PRB_TIMESTAMP exchanges, so the published
+ *  samples and valve events carry master-aligned times instead of the local micros().
+ *
+ *  Each exchange gives the master time (sent with the command, plus CLOCK_SYNC_LATENCY_US of
+ *  transfer) and the local micros() at which it was received. An alpha-beta filter tracks the
+ *  offset (master - local) and the drift (relative rate of the two crystals), constant time and
+ *  memory per exchange:
+ *    - the first exchange sets the offset, the second one the drift
+ *    - an exchange off the prediction by more than CLOCK_SYNC_OUTLIER_US (delayed handler,
+ *      late master time stamp) is rejected; CLOCK_SYNC_MAX_REJECTS in a row mean the master
+ *      clock jumped, the filter restarts from the last one
+ *
+ *  The sync error is the RMS residual of the accepted exchanges, plus CLOCK_SYNC_WANDER per
+ *  microsecond since the last one (drift estimate error while coasting).
+ *
+ *  Times are uint32 microseconds on both sides and wrap together (offset modulo 2^32).
+ *  The functions are shared with the host tools (host/clock_sync).
+ */
+
+#include <stdint.h>
+#include "constant.h"
+
+typedef struct clock_sync_t
+{
+    uint32_t time_us;               // local time of the last accepted exchange [us]
+    uint32_t offset_us;             // master - local at time_us, integer part [us]
+    float offset_frac;              // fractional part of the offset [us]
+    float drift;                    // master rate - local rate [us/us]
+    float error;                    // RMS residual of the accepted exchanges [us]
+    uint16_t exchanges;             // accepted exchanges, saturates
+    uint16_t rejected;              // rejected exchanges, saturates
+    uint8_t outliers;               // consecutive rejected exchanges
+    uint8_t samples;                // accepted exchanges since the (re)start, saturates at 2
+}clock_sync_t;
+
+void clock_sync_reset(clock_sync_t *sync);
+bool clock_sync_update(clock_sync_t *sync, uint32_t local_us, uint32_t master_us);
+uint32_t clock_sync_time(const clock_sync_t *sync, uint32_t local_us);
+float clock_sync_error(const clock_sync_t *sync, uint32_t local_us);
+
+#endif // CLOCK_SYNC_H
@@ -0,0 +1,92 @@
+/*
+ * File: Journal.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the sequence state journal declared in Journal.h.
+ */
+
+#include <string.h>
+#include "Journal.h"
+#include "Telemetry.h"
+
+static inline uint16_t record_crc(const journal_record_t *record)
+{
+    return crc16_ccitt((const uint8_t *)record, offsetof(journal_record_t, crc));
+}
+
+static inline bool record_valid(const journal_record_t *record)
+{
+    return record->magic == JOURNAL_MAGIC && record->crc == record_crc(record);
+}
+
+// slot of the newest valid record, -1 if none: the higher sequence number first, the other
+// slot if that one is torn
+static int newest_slot(const journal_t *journal)
+{
+    static_assert(JOURNAL_SLOTS == 2, "two slots written alternately");
+    int first = (int32_t)(journal->slots[1].seq - journal->slots[0].seq) > 0 ? 1 : 0;
+    if (record_valid(&journal->slots[first])) return first;
+    if (record_valid(&journal->slots[1 - first])) return 1 - first;
+    return -1;
+}
+
+/**
+ * @brief Whether the journal may be resumed after this reset.
+ *
+ * Only a warm reset keeps RAM2: software reset or core lockup (SYSRESETREQ) and the
+ * watchdogs. A power-on or brownout (POR_B, also set with any other cause on power-up) may leave
+ * a CRC-valid record of a previous run, which must not re-drive the valves.
+ *
+ * @param reset_cause SRC_SRSR read at start-up.
+ */
+bool journal_warm_reset(uint32_t reset_cause)
+{
+    if (reset_cause & SRC_SRSR_IPP_RESET_B) return false;
+    return reset_cause & (SRC_SRSR_LOCKUP_SYSRESETREQ | SRC_SRSR_WDOG_RST_B | SRC_SRSR_WDOG3_RST_B);
+}
+
+/**
+ * @brief Invalidates every record (power-on, or a run that must not be resumed).
+ */
+void journal_clear(journal_t *journal)
+{
+    memset(journal, 0, sizeof(*journal));
+    arm_dcache_flush(journal, sizeof(*journal));
+}
+
+/**
+ * @brief Records a new sequence state over the oldest slot, the newest one is left intact.
+ *
+ * @param entry   State to record.
+ * @param time_ms millis() now.
+ */
+void journal_write(journal_t *journal, const journal_entry_t *entry, uint32_t time_ms)
+{
+    int newest = newest_slot(journal);
+    journal_record_t record;
+    record.magic = JOURNAL_MAGIC;
+    record.seq = newest < 0 ? 0 : journal->slots[newest].seq + 1;
+    record.time_ms = time_ms;
+    record.entry = *entry;
+    record.crc = record_crc(&record);
+
+    journal_record_t *slot = &journal->slots[newest == 0 ? 1 : 0];
+    memcpy(slot, &record, sizeof(record));
+    arm_dcache_flush(slot, sizeof(*slot));
+}
+
+/**
+ * @brief Newest valid record of the journal.
+ *
+ * @param record Copy of the record, untouched if there is none.
+ * @return false if no slot holds a valid record (power-on, cleared journal).
+ */
+bool journal_read(const journal_t *journal, journal_record_t *record)
+{
+    int newest = newest_slot(journal);
+    if (newest < 0) return false;
+    *record = journal->slots[newest];
+    return true;
+}
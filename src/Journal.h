@@ -0,0 +1,67 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+/*
+ * File: Journal.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Journal of the sequence state (FSM state, stages, open valves, passivation flags) kept in
+ *  RAM that survives a warm reset, so a PRB that resets during IGNITION_SQ, PASSIVATION_SQ or
+ *  ABORT resumes the right stage instead of coming back in IDLE (PRBComputer::resume()).
+ *
+ *  The journal lives in DMAMEM (RAM2 on Teensy 4.1): the start-up code does not clear it, so
+ *  its content survives a watchdog or SYSRESETREQ restart, and is garbage after a power cycle.
+ *  setup() reads the reset cause (SRC_SRSR) and only resumes after a warm reset
+ *  (journal_warm_reset()); a power-on, brownout or POR_B pin reset clears the journal. RAM2 is
+ *  behind the data cache, every write is flushed to the RAM before returning.
+ *
+ *  Two slots are written alternately, each with a sequence number and a CRC-16/CCITT: a reset
+ *  in the middle of a write leaves the previous record valid, and random power-on content is
+ *  rejected. A write checks the CRC of the newest slot and computes the one of the new record
+ *  (20 bytes, no padding).
+ *
+ *  The functions are shared with the host tools (fault_injection, benchmarks).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "constant.h"
+
+#define JOURNAL_MAGIC               0x4A425250  // "PRBJ"
+#define JOURNAL_SLOTS               2
+
+#define JOURNAL_PASSIVATION         0x01        // memory.passivation
+#define JOURNAL_PASSIVATION_ABORT   0x02        // memory.did_passivation_abort
+
+// Sequence state persisted on every transition
+typedef struct journal_entry_t
+{
+    uint8_t state;                  // PRB_FSM
+    uint8_t ignition;               // ignitionStage
+    uint8_t passivation;            // passivationStage
+    uint8_t abort;                  // abortStage
+    uint8_t valves;                 // OUT_* bits of the open valves
+    uint8_t flags;                  // JOURNAL_PASSIVATION, JOURNAL_PASSIVATION_ABORT
+}journal_entry_t;
+
+typedef struct journal_record_t
+{
+    uint32_t magic;                 // JOURNAL_MAGIC
+    uint32_t seq;                   // write count, the newest valid slot wins
+    uint32_t time_ms;               // millis() at the write
+    journal_entry_t entry;
+    uint16_t crc;                   // CRC-16/CCITT of the record up to crc
+}journal_record_t;
+
+typedef struct journal_t
+{
+    journal_record_t slots[JOURNAL_SLOTS];
+}journal_t;
+
+void journal_clear(journal_t *journal);
+void journal_write(journal_t *journal, const journal_entry_t *entry, uint32_t time_ms);
+bool journal_read(const journal_t *journal, journal_record_t *record);
+bool journal_warm_reset(uint32_t reset_cause);
+
+#endif // JOURNAL_H
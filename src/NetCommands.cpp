@@ -0,0 +1,241 @@
+/*
+ * File: NetCommands.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Command table and dispatch of the Wire1 slave protocol declared in NetCommands.h.
+ */
+
+#include <string.h>
+#include "NetCommands.h"
+
+static volatile uint32_t resp_word = 0;         // FSM / valves state response
+static uint8_t resp_block[SAMPLE_FIFO_BLOCK];   // PRB_NET_SAMPLES response
+static const uint8_t resp_none[AV_NET_XFER_SIZE] = {};
+
+const volatile void *net_resp_data = resp_none;
+volatile uint8_t net_resp_length = AV_NET_XFER_SIZE;
+
+static_assert(sizeof(float) == AV_NET_XFER_SIZE, "float responses are served from their prb_memory_t field");
+
+// ================= write handlers =================
+// Run from the Wire1 receive handler once net_receive() checked the state and the data length.
+
+// master time (us, LE) to the clock sync
+static void on_timestamp(PRBComputer &, const uint8_t *data)
+{
+    post_master_time(data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+    status_led(WHITE);
+}
+
+static void on_clear_to_ignite(PRBComputer &computer, const uint8_t *data)
+{
+    if (data[0] == AV_NET_CMD_ON) computer.set_state(CLEAR_TO_IGNITE);
+}
+
+// back to IDLE after an abort or a passivation
+static void on_reset(PRBComputer &computer, const uint8_t *)
+{
+    computer.set_state(IDLE);
+    request_mux_reset(); // Deactivate MUX, deferred to the main loop (owns the sensor bus)
+}
+
+// ME, MO: AV_NET_CMD_ON / AV_NET_CMD_OFF, both valves switch on the same edge. An unknown
+// byte leaves its valve as is; it is only printed in the debug profile, where USB Serial is
+// not the telemetry stream.
+static void on_valves_state(PRBComputer &computer, const uint8_t *data)
+{
+    status_led(PURPLE);
+    uint32_t open = 0;
+    uint32_t close = 0;
+
+    if (data[0] == AV_NET_CMD_ON) {
+        open |= OUT_ME_b;
+        status_led(GREEN);
+    } else if (data[0] == AV_NET_CMD_OFF) {
+        close |= OUT_ME_b;
+    } else if constexpr (PROFILE.debug) {
+        Serial.print("Unknown state for ME_b valve: ");
+        Serial.println(data[0], HEX);
+    }
+
+    if (data[1] == AV_NET_CMD_ON) {
+        open |= OUT_MO_bC;
+    } else if (data[1] == AV_NET_CMD_OFF) {
+        close |= OUT_MO_bC;
+    } else if constexpr (PROFILE.debug) {
+        Serial.print("Unknown state for MO_bC valve: ");
+        Serial.println(data[1], HEX);
+    }
+
+    computer.set_valves(open, close);
+}
+
+static void on_igniter(PRBComputer &computer, const uint8_t *data)
+{
+    if (data[0] == AV_NET_CMD_ON) computer.ignite(millis());
+}
+
+// AV_NET_CMD_ON: abort with passivation
+static void on_abort(PRBComputer &computer, const uint8_t *data)
+{
+    computer.set_state(ABORT);
+    computer.set_passivation(data[0] == AV_NET_CMD_ON);
+}
+
+static void on_passivate(PRBComputer &computer, const uint8_t *)
+{
+    computer.set_state(PASSIVATION_SQ);
+    computer.set_passivation_stage(PASSIVATION_ETH);
+}
+
+// ================= command table =================
+static constexpr net_command_t net_commands[] = {
+//   id                          states                                  payload  response          value                                handler
+    {0,                          0,                                            0, NET_RESP_NONE,    nullptr,                             nullptr},  // unknown command
+    {AV_NET_PRB_TIMESTAMP,       NET_ANY_STATE,                                4, NET_RESP_NONE,    nullptr,                             on_timestamp},
+    {AV_NET_PRB_CLEAR_TO_IGNITE, NET_ANY_STATE,                                1, NET_RESP_NONE,    nullptr,                             on_clear_to_ignite},
+    {AV_NET_PRB_FSM_PRB,         0,                                            0, NET_RESP_STATE,   nullptr,                             nullptr},
+    {AV_NET_PRB_P_OIN,           0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::oin_press,            nullptr},
+    {AV_NET_PRB_T_FLS_0,         0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::oin_temp,             nullptr},
+    {AV_NET_PRB_P_EIN,           0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::ein_press,            nullptr},
+    {AV_NET_PRB_T_EIN,           0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::ein_temp_sensata,     nullptr},
+    {AV_NET_PRB_P_CCC,           0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::ccc_press,            nullptr},
+    {AV_NET_PRB_T_CCC,           0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::ccc_temp,             nullptr},
+    {AV_NET_PRB_T_FLS_10,        0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::ein_temp_pt1000,      nullptr},
+    {AV_NET_PRB_VALVES_STATE,    NET_STATE(IDLE) | NET_STATE(ABORT),           2, NET_RESP_VALVES,  nullptr,                             on_valves_state},
+    {AV_NET_PRB_SPECIFIC_IMP,    0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::engine_total_impulse, nullptr},
+    {AV_NET_PRB_PRESSURE_CHECK,  0,                                            0, NET_RESP_FLOAT,   &prb_memory_t::ccc_press,            nullptr},
+    {AV_NET_PRB_IGNITER,         NET_STATE(CLEAR_TO_IGNITE),                   1, NET_RESP_NONE,    nullptr,                             on_igniter},
+    {AV_NET_PRB_ABORT,           NET_ANY_STATE,                                1, NET_RESP_NONE,    nullptr,                             on_abort},
+    {AV_NET_PRB_PASSIVATE,       NET_STATE(IGNITION_SQ),                       0, NET_RESP_NONE,    nullptr,                             on_passivate},
+    {AV_NET_PRB_RESET,           NET_STATE(ABORT) | NET_STATE(PASSIVATION_SQ), 0, NET_RESP_NONE,    nullptr,                             on_reset},
+    {PRB_NET_SAMPLES,            0,                                            4, NET_RESP_SAMPLES, nullptr,                             nullptr},
+};
+
+static constexpr size_t NET_COMMANDS = sizeof(net_commands) / sizeof(net_commands[0]);
+
+static constexpr bool table_consistent()
+{
+    for (size_t i = 1; i < NET_COMMANDS; i++) {
+        const net_command_t &command = net_commands[i];
+        if (command.id == 0 || command.payload > AV_NET_XFER_SIZE) return false;
+        if ((command.response == NET_RESP_FLOAT) != (command.value != nullptr)) return false;
+        if ((command.handler == nullptr) != (command.states == 0)) return false;
+        for (size_t j = 1; j < i; j++) {
+            if (net_commands[j].id == command.id) return false;
+        }
+    }
+    return NET_COMMANDS <= 256;
+}
+static_assert(table_consistent(), "net_commands: one entry per command byte, float responses with their field, handlers with their states");
+
+// entry of every command byte, 0 (unknown command) if none
+typedef struct net_index_t
+{
+    uint8_t entry[256];
+}net_index_t;
+
+static constexpr net_index_t make_index()
+{
+    net_index_t index = {};
+    for (size_t i = 1; i < NET_COMMANDS; i++) index.entry[net_commands[i].id] = (uint8_t)i;
+    return index;
+}
+
+static constexpr net_index_t net_index = make_index();
+
+// ================= dispatch =================
+
+/**
+ * @brief Table entry of a command byte (the unknown command entry if none), one indexed load.
+ */
+FASTRUN const net_command_t &net_command(uint8_t id)
+{
+    return net_commands[net_index.entry[id]];
+}
+
+/**
+ * @brief Handles one write of the master. Called from the Wire1 receive handler.
+ *
+ * A command byte alone selects the response of the next read (and turns the status LED off).
+ * With data, the handler of the command runs if the FSM is in one of its states and the write
+ * carries its payload; the response is then staged, after the command took effect
+ * (VALVES_STATE read back).
+ *
+ * @param frame  Command byte then up to AV_NET_XFER_SIZE data bytes.
+ * @param length Bytes in frame.
+ */
+FASTRUN void net_receive(PRBComputer &computer, const uint8_t *frame, size_t length)
+{
+    if (length == 0) return;
+
+    uint8_t data[AV_NET_XFER_SIZE] = {};
+    size_t data_length = length - 1 < AV_NET_XFER_SIZE ? length - 1 : AV_NET_XFER_SIZE;
+    memcpy(data, frame + 1, data_length);
+
+    if (length == 1) {
+        net_stage(computer, frame[0], data);
+        status_led(OFF);
+        return;
+    }
+
+    const net_command_t &command = net_command(frame[0]);
+    if (command.handler && (command.states & NET_STATE(computer.get_state())) && data_length >= command.payload) {
+        command.handler(computer, data);
+    }
+    net_stage(computer, frame[0], data);
+}
+
+/**
+ * @brief Stages the response of the next read for command id.
+ *
+ * Sensor values are served straight from their prb_memory_t field, so a read returns the
+ * value at the time it is clocked; the FSM and valve states and the PRB_NET_SAMPLES block are
+ * built here. The Wire1 request handler is then a bounded copy of net_resp_length bytes while
+ * the master clocks the read, with no clock stretching.
+ *
+ * @param data AV_NET_XFER_SIZE data bytes of the command (PRB_NET_SAMPLES: channel, sequence
+ *             LE 24 bits).
+ */
+FASTRUN void net_stage(PRBComputer &computer, uint8_t id, const uint8_t *data)
+{
+    const net_command_t &command = net_command(id);
+    const prb_memory_t &memory = computer.get_memory();
+    const volatile void *response = &resp_word;
+    uint8_t length = AV_NET_XFER_SIZE;
+
+    switch (command.response) {
+    case NET_RESP_FLOAT:
+        response = &(memory.*command.value);
+        break;
+
+    case NET_RESP_STATE:
+        resp_word = computer.get_state();
+        break;
+
+    case NET_RESP_VALVES: {
+        uint8_t response_ME = memory.ME_state ? AV_NET_CMD_ON : AV_NET_CMD_OFF;
+        uint8_t response_MO = memory.MO_state ? AV_NET_CMD_ON : AV_NET_CMD_OFF;
+        resp_word = (response_MO << 8) | response_ME;
+        break;
+    }
+
+    case NET_RESP_SAMPLES: {
+        uint32_t since = data[1] | (data[2] << 8) | ((uint32_t)data[3] << 16);
+        memset(resp_block, 0, SAMPLE_FIFO_BLOCK);
+        computer.drain_samples(data[0], since, resp_block);
+        response = resp_block;
+        length = SAMPLE_FIFO_BLOCK;
+        break;
+    }
+
+    default:
+        response = resp_none;
+        break;
+    }
+
+    net_resp_data = response;
+    net_resp_length = length;
+}
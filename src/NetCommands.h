@@ -0,0 +1,63 @@
+#ifndef NET_COMMANDS_H
+#define NET_COMMANDS_H
+/*
+ * File: NetCommands.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Wire1 slave protocol of the PRB: the commands of the master (AV_NET_PRB_*, PRB_NET_*) in one
+ *  constexpr table, net_commands in NetCommands.cpp. Each entry gives:
+ *    - the handler of a write, and the FSM states it runs in (checked by net_receive() for
+ *      every command, the handler itself only checks its data)
+ *    - the data bytes the handler needs after the command byte (a shorter write is ignored)
+ *    - the response of the next read: none (zeros), a live prb_memory_t float, the FSM state,
+ *      the valve states or a PRB_NET_SAMPLES block
+ *
+ *  A 256-entry index built at compile time maps the command byte to its entry, so the Wire1
+ *  handlers of main.cpp do one lookup and one guard check whatever the size of the table. A
+ *  new command is one line of the table. The dispatch takes the PRBComputer as a parameter and
+ *  is shared with the host tools, so each handler can be run and benchmarked without Wire1.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "PRBComputer.h"
+
+#define NET_STATE(state)    (1 << (state))      // bit of a PRB_FSM state in net_command_t::states
+#define NET_ANY_STATE       0xFF
+
+static_assert(ERROR < 8, "the accepted FSM states are a byte of bits");
+
+// Response of a command to the next read
+enum net_response_t : uint8_t
+{
+    NET_RESP_NONE,                  // AV_NET_XFER_SIZE zeros (write-only and unknown commands)
+    NET_RESP_FLOAT,                 // prb_memory_t field, read when the master clocks it
+    NET_RESP_STATE,                 // PRB_FSM (32 bits)
+    NET_RESP_VALVES,                // ME, MO: AV_NET_CMD_ON / AV_NET_CMD_OFF (one byte each)
+    NET_RESP_SAMPLES,               // SAMPLE_FIFO_BLOCK bytes, see SampleFifo.h
+};
+
+// data: AV_NET_XFER_SIZE bytes after the command byte, zero-padded
+typedef void (*net_handler_t)(PRBComputer &computer, const uint8_t *data);
+
+typedef struct net_command_t
+{
+    uint8_t id;                         // command byte, 0: unknown command
+    uint8_t states;                     // NET_STATE() bits of the states the handler runs in
+    uint8_t payload;                    // data bytes the handler needs
+    net_response_t response;
+    float prb_memory_t::*value;         // NET_RESP_FLOAT field
+    net_handler_t handler;              // write handler, nullptr for a read-only command
+}net_command_t;
+
+// response of the next read, copied by the Wire1 request handler
+extern const volatile void *net_resp_data;
+extern volatile uint8_t net_resp_length;
+
+const net_command_t &net_command(uint8_t id);
+void net_receive(PRBComputer &computer, const uint8_t *frame, size_t length);
+void net_stage(PRBComputer &computer, uint8_t id, const uint8_t *data);
+
+#endif // NET_COMMANDS_H
@@ -0,0 +1,114 @@
+/*
+ * File: Outputs.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the shadowed valve / LED outputs declared in Outputs.h.
+ */
+
+#include <Arduino.h>
+#include "Outputs.h"
+
+static const uint8_t output_pins[OUTPUTS] = {ME_b, MO_bC, IGNITER, RGB_RED, RGB_GREEN, RGB_BLUE};
+
+// GPIO port driving at least one output
+typedef struct output_port_t
+{
+    uint8_t pin;                    // one output pin of the port, selects its DR_SET / DR_CLEAR registers
+    uint32_t outputs;               // OUT_* bits on this port
+}output_port_t;
+
+static output_port_t ports[OUTPUTS];
+static uint8_t port_count = 0;
+static uint32_t output_gpio_bits[OUTPUTS];  // GPIO bit of each output in its port
+static volatile uint32_t shadow = 0;        // current levels, OUT_* bits
+
+/**
+ * @brief Configures the output pins, drives them LOW and groups them by GPIO port.
+ *
+ * Must run before the first outputs_write() (setup(), or the host tools before update()).
+ */
+FLASHMEM void outputs_begin()
+{
+    port_count = 0;
+    shadow = 0;
+    for (int i = 0; i < OUTPUTS; i++) {
+        uint8_t pin = output_pins[i];
+        pinMode(pin, OUTPUT);
+        digitalWrite(pin, LOW);
+        output_gpio_bits[i] = digitalPinToBitMask(pin);
+
+        int p = 0;
+        while (p < port_count && portSetRegister(ports[p].pin) != portSetRegister(pin)) p++;
+        if (p == port_count) {
+            ports[p].pin = pin;
+            ports[p].outputs = 0;
+            port_count++;
+        }
+        ports[p].outputs |= 1u << i;
+    }
+}
+
+// GPIO bits of the outputs in bits (OUT_*) that are on port p
+static inline uint32_t port_bits(int p, uint32_t bits)
+{
+    bits &= ports[p].outputs;
+    uint32_t gpio = 0;
+    while (bits) {
+        gpio |= output_gpio_bits[__builtin_ctz(bits)];
+        bits &= bits - 1;
+    }
+    return gpio;
+}
+
+/**
+ * @brief Sets the outputs selected by mask to the levels given in levels (OUT_* bits).
+ *
+ * Outputs already at the requested level are skipped. The changed outputs are driven with one
+ * DR_SET and one DR_CLEAR write per GPIO port, so all the edges on a port happen in the same
+ * cycle. The writes are absolute levels: an output whose pin was driven behind the shadow is
+ * set right by its next transition instead of inverted (as a DR_TOGGLE write would).
+ *
+ * No interrupt masking: the shadow is committed with a compare-and-swap after the port writes.
+ * If a Wire1 handler wrote outputs in between, the call starts over from the new shadow and
+ * writes its levels again, so the shadow always ends with the levels of the last writer.
+ */
+FASTRUN void outputs_write(uint32_t mask, uint32_t levels)
+{
+    uint32_t current = shadow;
+    uint32_t changed;
+    do {
+        changed = (current ^ levels) & mask;
+        if (!changed) return;
+        for (int p = 0; p < port_count; p++) {
+            uint32_t set = port_bits(p, changed & levels);
+            uint32_t clear = port_bits(p, changed & ~levels);
+            if (set) *portSetRegister(ports[p].pin) = set;
+            if (clear) *portClearRegister(ports[p].pin) = clear;
+        }
+    } while (!__atomic_compare_exchange_n(&shadow, &current, current ^ changed, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+uint32_t outputs_levels()
+{
+    return shadow;
+}
+
+/**
+ * @brief OUT_* bit of a valve pin (ME_b, MO_bC, IGNITER), 0 for any other pin.
+ */
+uint32_t valve_output(int valve)
+{
+    switch (valve)
+    {
+    case ME_b:
+        return OUT_ME_b;
+    case MO_bC:
+        return OUT_MO_bC;
+    case IGNITER:
+        return OUT_IGNITER;
+    default:
+        return 0;
+    }
+}
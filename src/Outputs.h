@@ -0,0 +1,43 @@
+#ifndef OUTPUTS_H
+#define OUTPUTS_H
+/*
+ * File: Outputs.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Output layer of the valves, igniter and status LED. It keeps a shadow word of the output
+ *  levels and:
+ *    - only touches the hardware when a level actually changes (the sequences re-send the same
+ *      LED colour on every loop iteration)
+ *    - commits every change of one call with one write to the DR_SET and DR_CLEAR registers of
+ *      each GPIO port involved, so simultaneous transitions (open MO_bC + close IGNITER) switch
+ *      in the same cycle. ME_b, MO_bC and IGNITER share GPIO7, the RGB LED shares GPIO6.
+ *
+ *  Outputs are addressed by the OUT_* bits, a call sets the outputs in mask to levels:
+ *      outputs_write(OUT_MO_bC | OUT_IGNITER, OUT_MO_bC);   // open MO_bC, close IGNITER
+ *
+ *  Callable from the Wire1 handlers without masking interrupts: the shadow is committed with a
+ *  compare-and-swap, retried if a handler wrote outputs in between (see outputs_write()).
+ */
+
+#include <stdint.h>
+#include "constant.h"
+
+#define OUT_ME_b        (1u << 0)
+#define OUT_MO_bC       (1u << 1)
+#define OUT_IGNITER     (1u << 2)
+#define OUT_LED_RED     (1u << 3)
+#define OUT_LED_GREEN   (1u << 4)
+#define OUT_LED_BLUE    (1u << 5)
+#define OUTPUTS         6
+
+#define OUT_VALVES      (OUT_ME_b | OUT_MO_bC | OUT_IGNITER)
+#define OUT_LED         (OUT_LED_RED | OUT_LED_GREEN | OUT_LED_BLUE)
+
+void outputs_begin();
+void outputs_write(uint32_t mask, uint32_t levels);
+uint32_t outputs_levels();
+uint32_t valve_output(int valve);
+
+#endif // OUTPUTS_H
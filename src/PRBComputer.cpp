@@ -7,14 +7,21 @@
  *  This file implements the PRBComputer class, which manages the core logic and control
  *  of the PRB (Propulsion Rocket Bench) system. It includes:
  *    - State machine management for ignition, passivation, and abort sequences
- *    - Valve control (open/close for main engine, oxidizer, and igniter)
+ *    - Valve control (open/close for main engine, oxidizer, and igniter, through Outputs)
  *    - Sensor reading functions for pressure and temperature (analog and I2C)
- *    - Memory structure for storing system state, sensor data, and control flags
+ *    - Memory structures for the hot control state and the cold status bookkeeping
  *    - Getters and setters for system state and memory
  *    - High-level ignition and shutdown sequence logic
  *
  *  The class interfaces with hardware via digital and analog I/O, as well as I2C communication.
  *  It is designed for embedded use in the PRB avionics system.
+ *
+ *  Memory placement (Teensy 4.1): the burn-critical code (update, ignition_sq, abort_sq and the
+ *  chamber pressure integrator) is marked FASTRUN so it always executes from ITCM, and the
+ *  global PRBComputer lives in DTCM. Start-up only code is moved to flash with FLASHMEM to keep
+ *  the tightly-coupled memory for the control path. Build the environment of a profile
+ *  (hot_fire, cold_flow, bench) and inspect its map, e.g. .pio/build/hot_fire/firmware.map, to
+ *  check the placement.
  */
 
 // =================== Implementation ===================
@@ -30,19 +37,28 @@
 #include "PRBComputer.h"
 #include "Wire.h"
 
-PRBComputer::PRBComputer(PRB_FSM state_)
+PRBComputer::PRBComputer(PRB_FSM state_, TwoWire &ccc_wire) : my_sensor(SENSOR_WIRE), ccc_sensor(ccc_wire)
 {
     state = state_;
+    ccc_on_mux = &ccc_wire == &SENSOR_WIRE;
     memory.time_ignition = 0;
     memory.time_passivation = 0;
+    memory.time_abort = 0;
     ignition_phase = NOGO;
     passivation_phase = SLEEP;
-    memory.status_led = false;
-    memory.time_led = 0;
-    memory.time_print = 0;
+    abort_phase = ABORT_OXYDANT;
     memory.ME_state = false;
     memory.MO_state = false;
     memory.IGNITER_state = false;
+    memory.oin_temp = 0.0;
+    memory.ein_temp_pt1000 = 0.0;
+    memory.oin_press = 0.0;
+    memory.ein_temp_sensata = 0.0;
+    memory.ein_press = 0.0;
+    memory.ccc_temp = 0.0;
+    memory.ccc_press = 0.0;
+    estimator_reset(&memory.ccc_estimator);
+    memory.mean_ccc_press = 0.0;
     memory.integral = 0.0;
     memory.integral_past_time = 0;
     memory.engine_total_impulse = 0.0;
@@ -54,6 +70,48 @@ PRBComputer::PRBComputer(PRB_FSM state_)
     memory.ccc_press_index = 0;
     memory.check_press_done = false;
     memory.did_passivation_abort = false;
+    memory.sensor_flags = 0;
+    memory.fresh_samples = 0;
+    clock_sync_reset(&memory.clock);
+    telemetry_clock(&memory.clock);
+    fifo_reset(&samples);
+    journaled = {0xFF, 0, 0, 0, 0, 0}; // the first update() journals the state
+    sample_fresh = false;
+    status_channel = -1;
+    channel_status = 0;
+
+    status.status_led = false;
+    status.time_led = 0;
+    status.time_print = 0;
+    status.time_burn_debug = 0;
+    status.show_step = 0;
+    status.time_show = 0;
+    status.startup = true;
+    status.first_samples = 0;
+    status.time_ready = -1;
+    status.control_cycles = 0;
+    status.control_cycles_max = 0;
+    status.sweep_cycles = 0;
+    status.sweep_cycles_max = 0;
+    status.reported_state = state;
+    status.reported_ignition = ignition_phase;
+    status.reported_passivation = passivation_phase;
+    status.reported_abort = abort_phase;
+    status.reported_valves = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        status.sensor_health[i] = {0, 0, 0, 0, 0, 0, 0};
+    }
+    status.sensata_asleep = false;
+    status.sensata_waking = 0;
+    status.time_woken_us = 0;
+    status.wake_latency_us = -1;
+    status.sleep_us = 0;
+    status.awake_duty = 1000;
+    for (int i = 0; i < TLM_CHANNELS; i++) {
+        status.time_sampled[i] = -0x40000000; // every channel is due on the first update()
+        status.sample_count[i] = 0;
+        status.sample_rate[i] = 0;
+    }
 }
 
 PRBComputer::~PRBComputer()
@@ -63,11 +121,30 @@ PRBComputer::~PRBComputer()
 
 // ========= valve control =========
 /**
- * @brief Open the specified valve by updating its state and setting its control pin HIGH.
+ * @brief Opens and closes several valves in one output transition.
+ *
+ * Updates the valve states in memory and switches the control pins through outputs_write(), so
+ * every edge of the transition lands in the same cycle (the valve pins share one GPIO port). A
+ * valve both in open and close is opened. The edges are reported on the telemetry stream by
+ * update(), as this also runs from the Wire1 receive handler.
  *
- * This function sets the internal state of the specified valve to 'open' (true)
- * in the memory structure and sends a HIGH signal to the corresponding hardware pin
- * to physically open the valve.
+ * @param open  OUT_* bits of the valves to open (OUT_ME_b, OUT_MO_bC, OUT_IGNITER).
+ * @param close OUT_* bits of the valves to close.
+ */
+void PRBComputer::set_valves(uint32_t open, uint32_t close)
+{
+    close &= ~open;
+    if (open & OUT_ME_b) memory.ME_state = true;
+    else if (close & OUT_ME_b) memory.ME_state = false;
+    if (open & OUT_MO_bC) memory.MO_state = true;
+    else if (close & OUT_MO_bC) memory.MO_state = false;
+    if (open & OUT_IGNITER) memory.IGNITER_state = true;
+    else if (close & OUT_IGNITER) memory.IGNITER_state = false;
+    outputs_write((open | close) & OUT_VALVES, open);
+}
+
+/**
+ * @brief Open the specified valve by updating its state and setting its control pin HIGH.
  *
  * @param valve The identifier of the valve to open. Valid values are:
  *              - ME_b: Main Engine valve
@@ -78,30 +155,12 @@ PRBComputer::~PRBComputer()
  */
 void PRBComputer::open_valve(int valve)
 {
-    switch (valve)
-    {
-    case ME_b:
-        memory.ME_state = true;
-        break;
-    case MO_bC:
-        memory.MO_state = true;
-        break;
-    case IGNITER:
-        memory.IGNITER_state = true;
-        break;
-    default:
-        break;
-    }
-    digitalWrite(valve, HIGH);
+    set_valves(valve_output(valve), 0);
 }
 
 /**
  * @brief Closes the specified valve by updating its state and setting its control pin LOW.
  *
- * This function sets the internal state of the specified valve to 'closed' (false)
- * in the memory structure and sends a LOW signal to the corresponding hardware pin
- * to physically close the valve.
- *
  * @param valve The identifier of the valve to close. Valid values are:
  *              - ME_b: Main Engine valve
  *              - MO_bC: Main Oxidizer valve
@@ -111,188 +170,452 @@ void PRBComputer::open_valve(int valve)
  */
 void PRBComputer::close_valve(int valve)
 {
-    switch (valve)
+    set_valves(0, valve_output(valve));
+}
+
+
+// ========= sensor reading =========
+
+// Every sampled channel, in acquisition order. An entry gives how the channel is read (kind,
+// multiplexer channel or ADC pin), how it is converted, where its value is kept and its sample
+// period in each schedule phase; update() switches the phase with the FSM state, so the bus time
+// goes to the CCC pressure during the burn. After a reset, the startup periods retry every
+// channel until the first valid data of each is published.
+//
+// read_sensors() walks the table once per update(): the CCC comes first, so its sample is the
+// closest to the FSM tick, and the entries of a multiplexer channel are contiguous, so a channel
+// is selected once per sweep for all its due reads. A Sensata temperature comes just before its
+// pressure, for the STATUS reuse of sensata_data_ready().
+static constexpr sensor_desc_t sensor_table[] = {
+    // channel             kind                   source  health        flags                                calibration            value                               STARTUP            IDLE            ARMED            SEQUENCE             BURN
+    {TLM_CCC_TEMP,         SENSOR_KIND_SENSATA_T, CCC_CH, SENSOR_CCC,   0,                                   sensata_temperature_c, &prb_memory_t::ccc_temp,            {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_TEMP_MS,  SAMPLE_BURN_TEMP_MS}},
+    {TLM_CCC_PRESS,        SENSOR_KIND_SENSATA_S, CCC_CH, SENSOR_CCC,   SENSOR_PRESSURE | SENSOR_ESTIMATOR,  sensata_pressure_bar,  &prb_memory_t::ccc_press,           {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_PRESS_MS, SAMPLE_BURN_CCC_MS}},
+    {TLM_EIN_TEMP_SENSATA, SENSOR_KIND_SENSATA_T, EIN_CH, SENSOR_EIN,   0,                                   sensata_temperature_c, &prb_memory_t::ein_temp_sensata,    {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_TEMP_MS,  SAMPLE_BURN_TEMP_MS}},
+    {TLM_EIN_PRESS,        SENSOR_KIND_SENSATA_S, EIN_CH, SENSOR_EIN,   SENSOR_PRESSURE,                     sensata_pressure_bar,  &prb_memory_t::ein_press,           {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_PRESS_MS, SAMPLE_BURN_PRESS_MS}},
+    {TLM_OIN_TEMP,         SENSOR_KIND_PT1000,    T_OIN,  SENSOR_T_OIN, 0,                                   pt1000_temperature_c,  &prb_memory_t::oin_temp,            {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_TEMP_MS,  SAMPLE_BURN_TEMP_MS}},
+    {TLM_EIN_TEMP_PT1000,  SENSOR_KIND_PT1000,    T_EIN,  SENSOR_T_EIN, 0,                                   pt1000_temperature_c,  &prb_memory_t::ein_temp_pt1000,     {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_TEMP_MS,  SAMPLE_BURN_TEMP_MS}},
+    PROFILE.kulite
+        ? sensor_desc_t{TLM_OIN_PRESS, SENSOR_KIND_KULITE,    P_OIN,  SENSOR_OIN,   SENSOR_PRESSURE,             kulite_pressure_bar,   &prb_memory_t::oin_press,           {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_PRESS_MS, SAMPLE_BURN_PRESS_MS}}
+        : sensor_desc_t{TLM_OIN_PRESS, SENSOR_KIND_SENSATA_S, P_OIN,  SENSOR_OIN,   SENSOR_PRESSURE,             sensata_pressure_bar,  &prb_memory_t::oin_press,           {SAMPLE_STARTUP_MS, SAMPLE_IDLE_MS, SAMPLE_ARMED_MS, SAMPLE_SEQ_PRESS_MS, SAMPLE_BURN_PRESS_MS}},
+};
+
+static constexpr size_t SENSOR_ENTRIES = sizeof(sensor_table) / sizeof(sensor_table[0]);
+
+static constexpr bool is_sensata(const sensor_desc_t &sensor)
+{
+    return sensor.kind == SENSOR_KIND_SENSATA_T || sensor.kind == SENSOR_KIND_SENSATA_S;
+}
+
+// telemetry channels read from a Sensata, bit (1 << telemetry_channel_t)
+static constexpr uint8_t sensata_channels()
+{
+    uint8_t channels = 0;
+    for (size_t i = 0; i < SENSOR_ENTRIES; i++) {
+        if (is_sensata(sensor_table[i])) channels |= 1 << sensor_table[i].channel;
+    }
+    return channels;
+}
+
+static constexpr bool table_covers_channels()
+{
+    uint32_t seen = 0;
+    for (size_t i = 0; i < SENSOR_ENTRIES; i++) {
+        if (sensor_table[i].channel >= TLM_CHANNELS || (seen & (1 << sensor_table[i].channel))) return false;
+        seen |= 1 << sensor_table[i].channel;
+    }
+    return seen == (1 << TLM_CHANNELS) - 1;
+}
+static_assert(table_covers_channels(), "every telemetry channel must have exactly one sensor_table entry");
+
+static constexpr bool table_groups_channels()
+{
+    for (size_t i = 0; i < SENSOR_ENTRIES; i++) {
+        for (size_t j = i + 2; j < SENSOR_ENTRIES; j++) {
+            if (!is_sensata(sensor_table[i]) || !is_sensata(sensor_table[j])) continue;
+            if (sensor_table[i].source != sensor_table[j].source) continue;
+            for (size_t k = i + 1; k < j; k++) {
+                if (!is_sensata(sensor_table[k]) || sensor_table[k].source != sensor_table[i].source) return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(table_groups_channels(), "the entries of a multiplexer channel must be contiguous in sensor_table");
+
+// the single-shot trigger is sent by the pressure read, right after the temperature read
+static constexpr bool table_triggers_sensata()
+{
+    for (size_t i = 0; i < SENSOR_ENTRIES; i++) {
+        if (sensor_table[i].kind != SENSOR_KIND_SENSATA_T) continue;
+        if (i + 1 >= SENSOR_ENTRIES) return false;
+        const sensor_desc_t &press = sensor_table[i + 1];
+        if (press.kind != SENSOR_KIND_SENSATA_S || press.source != sensor_table[i].source) return false;
+        for (int phase = 0; phase < SAMPLE_PHASES; phase++) {
+            if (press.period_ms[phase] > sensor_table[i].period_ms[phase]) return false;
+        }
+    }
+    return true;
+}
+static_assert(table_triggers_sensata(), "a Sensata temperature must be followed by its pressure, sampled at least as often");
+
+/**
+ * @brief Reads one sensor_table entry, the multiplexer channel of a Sensata being selected.
+ *
+ * An analog sensor is read with analogRead() and always gives a new value. A Sensata result
+ * register is read only if sensata_data_ready() reports a new conversion; the pressure read
+ * then sends the next single-shot trigger (it is the last read of its channel in a sweep).
+ * The raw value goes through the health checks, then through the calibration of the entry.
+ *
+ * @param sensor Entry to read.
+ * @return The new value, or the value held in memory if there was no new conversion or the
+ *         read failed (sample_fresh tells which). Pressures are clamped at 0 bar.
+ */
+float PRBComputer::read_sensor(const sensor_desc_t &sensor)
+{
+    int raw = 0;
+    sample_fresh = true;
+
+    switch (sensor.kind)
     {
-    case ME_b:
-        memory.ME_state = false;
-        break;
-    case MO_bC:
-        memory.MO_state = false;
+    case SENSOR_KIND_PT1000:
+    case SENSOR_KIND_KULITE:
+        raw = analogRead(sensor.source);
+        update_health(sensor.health, true, raw >= SENSOR_ADC_MARGIN && raw <= 4095 - SENSOR_ADC_MARGIN, raw, false);
         break;
-    case IGNITER:
-        memory.IGNITER_state = false;
+
+    case SENSOR_KIND_SENSATA_T: {
+        PTE7300_I2C &sensata = sensata_for(sensor.source);
+        uint16_t sensor_status;
+        if (sensata_data_ready(sensata, sensor.source, PTE7300_STATUS_DSP_T_UP, &sensor_status)) {
+            raw = sensata.readDSP_T();
+            sample_fresh = sensata.readOK();
+            update_health(sensor.health, sample_fresh, abs(raw) <= SENSOR_DSP_LIMIT, raw, false);
+        } else {
+            // staleness is counted on the pressure reads only
+            sample_fresh = false;
+            if (!sensata.readOK()) update_health(sensor.health, false, true, 0, false);
+        }
         break;
+    }
 
-    default:
+    case SENSOR_KIND_SENSATA_S: {
+        PTE7300_I2C &sensata = sensata_for(sensor.source);
+        uint16_t sensor_status;
+        if (sensata_data_ready(sensata, sensor.source, PTE7300_STATUS_DSP_S_UP, &sensor_status)) {
+            raw = sensata.readDSP_S();
+            sample_fresh = sensata.readOK();
+            update_health(sensor.health, sample_fresh, abs(raw) <= SENSOR_DSP_LIMIT, raw, true);
+        } else {
+            sample_fresh = false;
+            update_health_stale(sensor.health, sensata.readOK());
+        }
+        sensata_trigger(sensata, sensor_status);
         break;
     }
-    digitalWrite(valve, LOW);
+    }
+
+    if (!sample_fresh) return memory.*sensor.value; // keep last value if error
+
+    float value = sensor.calibration(raw);
+    if ((sensor.flags & SENSOR_PRESSURE) && value < 0) value = 0.0; // avoid negative pressures
+    return value;
 }
 
+/**
+ * @brief Driver of a Sensata sensor: the CCC has its own when it sits on a separate bus.
+ */
+PTE7300_I2C &PRBComputer::sensata_for(int sensor)
+{
+    return (sensor == CCC_CH && !ccc_on_mux) ? ccc_sensor : my_sensor;
+}
 
-// ========= sensor reading =========
 /**
- * @brief Reads the pressure value from the specified sensor.
- *
- * This function reads the pressure from either an analog or I2C-based sensor,
- * depending on the sensor identifier provided. For analog sensors (e.g., KULITE),
- * it reads the raw ADC value, converts it to voltage, and then calculates the pressure.
- * For I2C sensors, it selects the appropriate I2C channel, reads the digital sensor value,
- * and converts it to pressure in bar. The function handles sensor selection and
- * communication protocol internally.
+ * @brief false for a sensor read without the multiplexer (CCC on its own bus).
+ */
+bool PRBComputer::on_mux(int sensor)
+{
+    return sensor != CCC_CH || ccc_on_mux;
+}
+
+/**
+ * @brief Tells whether a result register of the selected PTE7300 holds a new conversion.
  *
- * @param sensor The identifier of the pressure sensor to read from. Valid values include:
- *               - P_OIN: Analog or I2C sensor (depending on compilation flags)
- *               - EIN_CH: I2C sensor channel
- *               - CCC_CH: I2C sensor channel
+ * With ACQ_POLL the result is always read, except while the Sensatas wake up (sensata_power()).
+ * With ACQ_DATA_READY and ACQ_SINGLE_SHOT the STATUS register is read first, and the result read
+ * is skipped while its "updated" bit is clear (no conversion since the last read) or when STATUS
+ * cannot be read.
  *
- * @return The measured pressure value in bar.
+ * STATUS is read once per channel and sweep: the value read for the temperature is kept and
+ * reused by the pressure read that follows it, so a channel without a new conversion costs a
+ * single transfer instead of the two result reads.
  *
- * @note If an unknown sensor identifier is provided, the function returns 0.0.
- * @note The function assumes a 12-bit ADC and 3.3V reference for analog sensors.
- * @note I2C communication is properly closed before returning.
+ * @param sensata       Driver of the sensor (sensata_for()).
+ * @param channel       Multiplexer channel of the sensor.
+ * @param updated_bit   PTE7300_STATUS_DSP_S_UP or PTE7300_STATUS_DSP_T_UP.
+ * @param sensor_status STATUS register value, 0 if it was not read.
+ * @return true if the result register has to be read.
  */
-float PRBComputer::read_pressure(int sensor)
+bool PRBComputer::sensata_data_ready(PTE7300_I2C &sensata, int channel, uint16_t updated_bit, uint16_t *sensor_status)
 {
-    bool I2C = false;
-    int DSP_S = 0;
-    float press = 0.0;
-
-    switch (sensor)
-    {
-    case P_OIN: {
-        #ifdef KULITE
-        int max_kulite_value = 100;
-        int rawValue = analogRead(P_OIN);
-        float voltage = (rawValue / 4095.0) * 3.3; // Assuming a 12-bit ADC and 3.3V reference
-        float v_sensor = voltage / 33;
-        press = (v_sensor * 1000.0) * (max_kulite_value / 100.0);
-        #else 
-        selectI2CChannel(sensor);
-        I2C = true;
-        #endif
-        break;
+    *sensor_status = 0;
+    if constexpr (PROFILE.acquisition == ACQ_POLL) {
+        if (!status.sensata_waking) return true;
     }
 
-    case EIN_CH:
-    case CCC_CH:
-        selectI2CChannel(sensor);
-        I2C = true;
-        break;
-    
-    default:
-        //error
-        break;
+    uint16_t value;
+    if (updated_bit == PTE7300_STATUS_DSP_S_UP && status_channel == channel) {
+        value = channel_status;
+    } else {
+        value = sensata.readSTATUS();
+        if (!sensata.readOK()) {
+            status_channel = -1;
+            return false;
+        }
     }
-    
-    if (I2C)
-    {
-        DSP_S = my_sensor.readDSP_S();
-        if (DSP_S != NAN) {
-            press = ((DSP_S - (-16000.0)) * (100.0) / (16000.0 - (-16000.0))); // in bar
-        } else {
+    // kept for the pressure read of the same channel only
+    status_channel = updated_bit == PTE7300_STATUS_DSP_T_UP ? channel : -1;
+    channel_status = value;
 
-            switch (sensor)
-            {
-            case EIN_CH:
-                press = memory.ein_press; // keep last value if error
-                break;
+    *sensor_status = value;
+    return (value & updated_bit) != 0;
+}
 
-            case CCC_CH:
-                press = memory.ccc_press; // keep last value if error
-                break;
-            
-            default:
-                break;
+/**
+ * @brief Triggers the next single conversion of the selected PTE7300 (ACQ_SINGLE_SHOT).
+ *
+ * A sensor in idle mode with no conversion running gets a START, so its next result is ready
+ * for the next sweep. A new result while not idle means the sensor runs in continuous mode
+ * (power-on default, or after a reset): it is put back in idle mode first.
+ *
+ * @param sensata       Driver of the sensor (sensata_for()).
+ * @param sensor_status STATUS register read with sensata_data_ready().
+ */
+void PRBComputer::sensata_trigger(PTE7300_I2C &sensata, uint16_t sensor_status)
+{
+    if constexpr (PROFILE.acquisition == ACQ_SINGLE_SHOT) {
+        if (sensor_status & PTE7300_STATUS_IDLE) {
+            sensata.start();
+        } else if (sample_fresh) {
+            sensata.idle();
+        }
+    }
+}
+
+/**
+ * @brief Updates the health checks of a sensor after one of its reads.
+ *
+ * A sensor is flagged in memory.sensor_flags while any fault is raised:
+ *   - SENSOR_FAULT_READ:  SENSOR_FAIL_READS consecutive failed reads (cleared by a good read)
+ *   - SENSOR_FAULT_RANGE: last good raw value outside the sensor span
+ *   - SENSOR_FAULT_STUCK: raw pressure identical for SENSOR_STUCK_READS reads and at least
+ *     SENSOR_STUCK_MS (a live sensor always moves by a few LSB; both, as the read rate follows
+ *     the sensor schedule and a polled sensor is read faster than it converts in the burn)
+ *   - SENSOR_FAULT_STALE: see update_health_stale(), cleared by a new pressure
+ *
+ * @param sensor      Sensor the read belongs to.
+ * @param read_ok     false if the read failed (NAK, short frame, CRC error).
+ * @param in_range    Raw value inside the span, ignored if the read failed.
+ * @param raw         Raw value (DSP counts or ADC code).
+ * @param check_stuck Track the raw value for the stuck check (pressure reads).
+ */
+void PRBComputer::update_health(sensor_id_t sensor, bool read_ok, bool in_range, int raw, bool check_stuck)
+{
+    sensor_health_t &health = status.sensor_health[sensor];
+
+    if (!read_ok) {
+        if (health.failed_reads < 255) health.failed_reads++;
+        if (health.failed_reads >= SENSOR_FAIL_READS) health.faults |= SENSOR_FAULT_READ;
+    } else {
+        health.failed_reads = 0;
+        health.faults &= ~SENSOR_FAULT_READ;
+
+        if (in_range) health.faults &= ~SENSOR_FAULT_RANGE;
+        else health.faults |= SENSOR_FAULT_RANGE;
+
+        if (check_stuck) {
+            int time = millis();
+            health.stale = 0;
+            health.time_fresh = time;
+            health.faults &= ~SENSOR_FAULT_STALE;
+            if (raw == health.last_raw) {
+                if (health.unchanged < 255) health.unchanged++;
+            } else {
+                health.unchanged = 0;
+                health.time_changed = time;
+            }
+            health.last_raw = raw;
+            if (health.unchanged >= SENSOR_STUCK_READS && time - health.time_changed >= SENSOR_STUCK_MS) {
+                health.faults |= SENSOR_FAULT_STUCK;
+            } else {
+                health.faults &= ~SENSOR_FAULT_STUCK;
             }
         }
     }
 
-    endI2CCommunication();
+    if (health.faults) memory.sensor_flags |= 1 << sensor;
+    else memory.sensor_flags &= ~(1 << sensor);
+}
 
-    if (press < 0) press = 0.0; // avoid negative pressures
+/**
+ * @brief Updates the health checks of a sensor whose pressure read was skipped because the
+ * PTE7300 had no new conversion (data-ready acquisition).
+ *
+ * SENSOR_FAULT_STALE is raised after SENSOR_STALE_READS such reads spanning SENSOR_STALE_MS since
+ * the last new conversion: the sensor converts much faster than the slowest schedule, but the
+ * CCC is read faster than it converts in the burn. A failed STATUS read counts as a failed read.
+ *
+ * @param sensor    Sensor the read belongs to.
+ * @param status_ok false if the STATUS read failed.
+ */
+void PRBComputer::update_health_stale(sensor_id_t sensor, bool status_ok)
+{
+    if (!status_ok) {
+        update_health(sensor, false, true, 0, false);
+        return;
+    }
 
-    return press;
+    sensor_health_t &health = status.sensor_health[sensor];
+    if (health.stale < 255) health.stale++;
+    if (health.stale >= SENSOR_STALE_READS && (int)millis() - health.time_fresh >= SENSOR_STALE_MS) {
+        health.faults |= SENSOR_FAULT_STALE;
+    }
+    memory.sensor_flags |= health.faults ? (1 << sensor) : 0;
 }
 
-
 /**
- * @brief Reads the temperature from the specified sensor.
+ * @brief Reads the channels due in this update() and stores them in memory.
  *
- * This function reads the temperature value from either an analog or I2C-based sensor,
- * depending on the sensor identifier provided. For analog sensors (e.g., T_OIN, T_EIN),
- * it reads the analog value, converts it to voltage, calculates the resistance of a PT1000
- * sensor using a resistor divider formula, and then computes the temperature in Celsius.
- * For I2C-based sensors (e.g., EIN_CH, CCC_CH), it selects the appropriate I2C channel,
- * reads the digital temperature value, and converts it to Celsius using a sensor-specific formula.
+ * Walks sensor_table in order. A multiplexer channel is selected before the first due read of
+ * its entries and released after the last one, so a Sensata with its temperature and pressure
+ * due costs one select (and its reset pulse) instead of one per read. Every sample is tagged
+ * fresh (new conversion) or stale (held value).
  *
- * @param sensor The identifier of the sensor to read from.
- *               - For analog sensors: T_OIN, T_EIN
- *               - For I2C sensors: EIN_CH, CCC_CH
- * @return The measured temperature in degrees Celsius.
+ * @param due Channels to read, bit (1 << telemetry_channel_t).
+ * @return Channels that got a new value, same bits.
  */
-float PRBComputer::read_temperature(int sensor)
+uint8_t PRBComputer::read_sensors(uint8_t due)
 {
-    bool I2C = false;
-    int value = 0.0;
-    float voltage = 0.0, resistance_pt1000 = 0.0, temp = 0.0;
-    int DSP_T = 0;
-
-    switch (sensor)
-    {
-    case T_OIN:
-    case T_EIN:
-        //read analog temperature
-        value = analogRead(sensor);
-        voltage = (value * 3.3) / 4095.0; // Assuming a 12-bit ADC and 3V3 reference
-        resistance_pt1000 = (voltage * 1100.0)/(3.3 - voltage); // formula from a resistor divider
-        temp = (resistance_pt1000-1000)/3.85;
-        break;
+    uint8_t fresh = 0;
+    int selected = -1;   // multiplexer channel enabled, -1 if none
+    status_channel = -1; // a STATUS value is only reused within one update()
+
+    for (const sensor_desc_t &sensor : sensor_table) {
+        if (!(due & (1 << sensor.channel))) continue;
+
+        int mux_channel = is_sensata(sensor) && on_mux(sensor.source) ? sensor.source : -1;
+        if (mux_channel != selected) {
+            if (selected >= 0) endI2CCommunication();
+            if (mux_channel >= 0) selectI2CChannel(mux_channel);
+            selected = mux_channel;
+        }
 
-    case EIN_CH:
-    case CCC_CH:
-        selectI2CChannel(sensor);
-        I2C = true;
-        break;
-    
-    default:
-        break;
+        float value = read_sensor(sensor);
+        memory.*sensor.value = value;
+        fresh |= sample_fresh << sensor.channel;
+        if constexpr (PROFILE.pressure_estimator) {
+            // a stale sample would be counted twice by the estimator, with a zero rate
+            if ((sensor.flags & SENSOR_ESTIMATOR) && sample_fresh) estimator_update(&memory.ccc_estimator, value, micros());
+        }
     }
-    
-    if (I2C)
-    {
-        DSP_T = my_sensor.readDSP_T();
 
-        if (DSP_T != NAN) {
-            temp = DSP_T * 82.5 / 16000 + 42.5;
-        } else {
-            switch (sensor)
-            {
-            case EIN_CH:
-                temp = memory.ein_temp_sensata; // keep last value if error
-                break;
+    if (selected >= 0) endI2CCommunication();
+    return fresh;
+}
 
-            case CCC_CH:
-                temp = memory.ccc_temp; // keep last value if error
-                break;
-            
-            default:
-                break;
-            }
+/**
+ * @brief Puts the Sensatas in sleep mode in IDLE, past the start-up schedule, and wakes them up
+ * when the FSM leaves IDLE (profile idle_sleep).
+ *
+ * Asleep, they are left out of the schedule: the IDLE housekeeping reads the analog sensors
+ * only, and the master reads the Sensata values of the last sample before the sleep.
+ * The wake-up command is RESET, back to the power-on continuous mode (IDLE with
+ * ACQ_SINGLE_SHOT, the pressure read then sends the START). Until every Sensata channel has a
+ * new sample, or SENSATA_WAKE_MAX_MS, the channels are read on every loop and through STATUS
+ * whatever the acquisition, so no result register from before the wake-up is published; the
+ * time until the last one is kept in wake_latency_us.
+ *
+ * @param time The current time [ms].
+ */
+FLASHMEM void PRBComputer::sensata_power(int time)
+{
+    bool asleep = state == IDLE && !status.startup;
+    if (asleep == status.sensata_asleep) return;
+    if (!asleep) status.time_woken_us = micros();
+
+    for (const sensor_desc_t &sensor : sensor_table) {
+        if (sensor.kind != SENSOR_KIND_SENSATA_S) continue;    // one pressure entry per sensor
+
+        bool mux = on_mux(sensor.source);
+        if (mux) selectI2CChannel(sensor.source);
+        PTE7300_I2C &sensata = sensata_for(sensor.source);
+        if (asleep) sensata.sleep();
+        else if constexpr (PROFILE.acquisition == ACQ_SINGLE_SHOT) sensata.idle();
+        else sensata.reset();
+        if (mux) endI2CCommunication();
+
+        if (!asleep) {
+            // no stuck / stale count across the sleep
+            sensor_health_t &health = status.sensor_health[sensor.health];
+            health.unchanged = 0;
+            health.stale = 0;
+            health.time_changed = time;
+            health.time_fresh = time;
         }
     }
 
-    endI2CCommunication();
-
-    return temp;
+    status.sensata_asleep = asleep;
+    if (!asleep) status.sensata_waking = sensata_channels();
 }
 
 // ========= getter =========
-prb_memory_t PRBComputer::get_memory() { return memory; }
+const prb_memory_t &PRBComputer::get_memory() { return memory; }
+const prb_status_t &PRBComputer::get_status() { return status; }
 PRB_FSM PRBComputer::get_state() { return state; }
 ignitionStage PRBComputer::get_ignition_stage() { return ignition_phase; }
 passivationStage PRBComputer::get_shutdown_stage() { return passivation_phase; }
 
+/**
+ * @brief Response block of a PRB_NET_SAMPLES request: the fresh samples of a channel from
+ * sequence number since (24 bits), see SampleFifo.h. Called from the Wire1 receive handler.
+ */
+FASTRUN size_t PRBComputer::drain_samples(uint8_t channel, uint32_t since, uint8_t *block)
+{
+    return fifo_drain(&samples, channel, since, block);
+}
+
+/**
+ * @brief Phase of the sensor schedule for the current FSM state.
+ *
+ * IDLE starts on the startup schedule, until every channel got a new sample or
+ * SAMPLE_STARTUP_MAX_MS after reset.
+ * The burn phase starts when the oxidizer valve opens (BURN_START_ME, the estimator gets the
+ * pressure rise) and ends when the main valve closes. The ignitionStage values are not in
+ * sequence order, so the stages are listed explicitly.
+ */
+sample_phase_t PRBComputer::get_sample_phase()
+{
+    switch (state)
+    {
+    case IDLE:
+        return status.startup ? SAMPLE_STARTUP : SAMPLE_IDLE;
+    case CLEAR_TO_IGNITE:
+        return SAMPLE_ARMED;
+    case IGNITION_SQ:
+        switch (ignition_phase)
+        {
+        case BURN_START_ME:
+        case BURN:
+        case BURN_STOP_MO:
+        case BURN_STOP_ME:
+            return SAMPLE_BURN;
+        default:
+            return SAMPLE_SEQUENCE;
+        }
+    default:
+        return SAMPLE_SEQUENCE;
+    }
+}
+
 
 // ========= setter =========
 void PRBComputer::set_state(PRB_FSM new_state) { state = new_state; }
@@ -329,7 +652,7 @@ void PRBComputer::set_passivation_stage(passivationStage new_stage) { passivatio
  * Relies on pre-defined constants for durations, pressures, and thresholds.
  *
  */
-void PRBComputer::ignition_sq()
+FASTRUN void PRBComputer::ignition_sq()
 {
     switch (ignition_phase)
     {
@@ -341,8 +664,7 @@ void PRBComputer::ignition_sq()
     
     case IGNITION:
         if (millis() - memory.time_ignition >= PRECHILL_DURATION) {
-            close_valve(MO_bC);
-            open_valve(IGNITER);
+            set_valves(OUT_IGNITER, OUT_MO_bC);
             ignition_phase = BURN_START_MO;
             memory.time_ignition = millis();
         }
@@ -350,8 +672,7 @@ void PRBComputer::ignition_sq()
 
     case BURN_START_MO:
         if (millis() - memory.time_ignition >= IGNITER_DURATION) {
-            open_valve(MO_bC);
-            close_valve(IGNITER);
+            set_valves(OUT_MO_bC, OUT_IGNITER);
             ignition_phase = BURN_START_ME;
             memory.time_ignition = millis();
         }
@@ -363,10 +684,10 @@ void PRBComputer::ignition_sq()
             // ignition_phase = PRESSURE_CHECK;
             ignition_phase = BURN;
             memory.time_ignition = millis();
-            #ifdef INTEGRATE_CHAMBER_PRESSURE
+            if constexpr (PROFILE.integrate_chamber_pressure) {
                 memory.calculate_integral = true;
                 memory.integral_past_time = millis();
-            #endif
+            }
         }
         break;
 
@@ -388,7 +709,7 @@ void PRBComputer::ignition_sq()
     //     if (millis() - memory.time_ignition >= RAMPUP_DURATION) {
     //         if (memory.mean_ccc_press >= RAMP_UP_CHECK_PRESSURE) {
     //             ignition_phase = BURN;
-    //             memory.time_burn_debug = millis();
+    //             status.time_burn_debug = millis();
     //             memory.time_ignition = millis();
     //         } else {
     //             state = ABORT;
@@ -400,17 +721,18 @@ void PRBComputer::ignition_sq()
     //     }
     
     case BURN: {
-        memory.ccc_press_buffer[memory.ccc_press_index] = memory.ccc_press; // in Pa
-        memory.ccc_press_index = (memory.ccc_press_index + 1) % 5;
-        float sum_ccc_press = 0.0;
-        for (int i = 0; i < 5; i++) {
-            sum_ccc_press += memory.ccc_press_buffer[i];
+        if constexpr (PROFILE.pressure_estimator) {
+            // estimate at this tick instead of the last sweep, no averaging delay
+            memory.mean_ccc_press = ccc_press_estimate();
+        } else {
+            memory.mean_ccc_press = mean5_push(memory.ccc_press_buffer, &memory.ccc_press_index, memory.ccc_press);
         }
-        memory.mean_ccc_press = sum_ccc_press / 5.0;
 
         if (!memory.check_press_done && millis() - memory.time_ignition >= RAMPUP_DURATION) {
             memory.check_press_done = true;
-            if (memory.mean_ccc_press >= RAMP_UP_CHECK_PRESSURE) {  
+            // a flagged CCC sensor cannot confirm the ramp-up (unless the profile runs without pressure)
+            bool ccc_valid = PROFILE.test_without_pressure || !(memory.sensor_flags & (1 << SENSOR_CCC));
+            if (ccc_valid && memory.mean_ccc_press >= RAMP_UP_CHECK_PRESSURE) {  
                 // continue the burn
             } else {
                 state = ABORT;
@@ -419,38 +741,32 @@ void PRBComputer::ignition_sq()
             }
         }
 
-#ifdef INTEGRATE_CHAMBER_PRESSURE
+        if constexpr (PROFILE.integrate_chamber_pressure) {
 
-        float chamber_pressure_Pa = memory.ccc_press * 1e5; // Convert bar to Pa
-        memory.integral += chamber_pressure_Pa * (millis() - memory.integral_past_time) / 1000.0; // in Pa.s
-        memory.integral_past_time = millis();
+            integrate_chamber_pressure();
 
-        memory.engine_total_impulse = I_SP * G * (AREA_THROAT/C_STAR) * memory.integral;
-
-        if (millis() - memory.time_ignition <= (MIN_BURN_TIME)) {
-            break;
-        }
+            if (millis() - memory.time_ignition <= (MIN_BURN_TIME)) {
+                break;
+            }
 
 
-        if (memory.integral >= (I_TARGET * C_STAR) / (I_SP * G * AREA_THROAT) ||
-            millis() - memory.time_ignition >= (MAX_BURN_TIME)) {
-            ignition_phase = BURN_STOP_MO;
-            // Serial.print("Total burn time: ");
-            // Serial.println(millis() - memory.time_burn_debug);
-            memory.time_ignition = millis();
-        }
+            if (memory.integral >= (I_TARGET * C_STAR) / (I_SP * G * AREA_THROAT) ||
+                millis() - memory.time_ignition >= (MAX_BURN_TIME)) {
+                ignition_phase = BURN_STOP_MO;
+                // Serial.print("Total burn time: ");
+                // Serial.println(millis() - status.time_burn_debug);
+                memory.time_ignition = millis();
+            }
 
-        break;
+        } else {
 
-#else
+            if (millis() - memory.time_ignition >= BURN_DURATION) {
+                ignition_phase = BURN_STOP_MO;
+                memory.time_ignition = millis();
+            }
 
-        if (millis() - memory.time_ignition >= BURN_DURATION) {
-            ignition_phase = BURN_STOP_MO;
-            memory.time_ignition = millis();
         }
         break;
-
-#endif
         }
 
         case BURN_STOP_MO:
@@ -484,6 +800,40 @@ void PRBComputer::ignition_sq()
 }
 
 
+/**
+ * @brief CCC pressure estimate of the BURN decisions [bar].
+ *
+ * The estimate extrapolated to the current tick while the CCC sensor is healthy. Once it is
+ * flagged (failed reads, stale, out of range) the slope of its last samples no longer tells
+ * anything, so the last corrected estimate is held instead of extrapolated.
+ */
+FASTRUN float PRBComputer::ccc_press_estimate()
+{
+    if (memory.sensor_flags & (1 << SENSOR_CCC)) return estimator_pressure(&memory.ccc_estimator, memory.ccc_estimator.time_us);
+    return estimator_pressure(&memory.ccc_estimator, micros());
+}
+
+/**
+ * @brief Integrates the chamber pressure since the last call and updates the total impulse.
+ *
+ * Rectangle rule on the latest CCC pressure sample, called on every BURN tick. With the
+ * pressure estimator the estimate at the current tick is used instead of the held sample.
+ */
+FASTRUN void PRBComputer::integrate_chamber_pressure()
+{
+    float chamber_pressure_Pa;
+    if constexpr (PROFILE.pressure_estimator) {
+        chamber_pressure_Pa = ccc_press_estimate() * 1e5; // Convert bar to Pa
+    } else {
+        chamber_pressure_Pa = memory.ccc_press * 1e5; // Convert bar to Pa
+    }
+    memory.integral = chamber_integral_step(memory.integral, chamber_pressure_Pa, millis() - memory.integral_past_time);
+    memory.integral_past_time = millis();
+
+    memory.engine_total_impulse = engine_impulse(memory.integral);
+}
+
+
 // ========================== passivation sequence =============================
 
 /**
@@ -496,7 +846,7 @@ void PRBComputer::ignition_sq()
  * to safely passivate the system.
  *
  * Phases:
- * - PASSIVATION_ETH: Opens the ME_b valve (unless VSTF_AND_COLD_FLOW is defined),
+ * - PASSIVATION_ETH: Opens the ME_b valve (unless the build profile is vstf_and_cold_flow),
  *   sets the next phase to PASSIVATION_LOX, and records the current time.
  * - PASSIVATION_LOX: After PASSIVATION_FUEL_DURATION has elapsed, closes ME_b,
  *   opens MO_bC, sets the next phase to SHUTOFF, and records the current time.
@@ -511,9 +861,9 @@ void PRBComputer::passivation_sq()
     switch (passivation_phase)
     {
     case PASSIVATION_ETH:
-#ifndef VSTF_AND_COLD_FLOW
-        open_valve(ME_b);
-#endif
+        if constexpr (!PROFILE.vstf_and_cold_flow) {
+            open_valve(ME_b);
+        }
         passivation_phase = PASSIVATION_INTERLUDE;
         memory.time_passivation = millis();
         break;
@@ -565,13 +915,12 @@ void PRBComputer::passivation_sq()
  * The function uses the system's memory and timing functions to ensure safe and orderly
  * shutdown of the relevant components during an abort event.
  */
-void PRBComputer::abort_sq()
+FASTRUN void PRBComputer::abort_sq()
 {
     switch (abort_phase)
     {
         case ABORT_OXYDANT:
-            close_valve(MO_bC);
-            close_valve(IGNITER);
+            set_valves(0, OUT_MO_bC | OUT_IGNITER);
             memory.time_abort = millis();
             abort_phase = ABORT_ETHANOL;
             break;
@@ -604,7 +953,156 @@ void PRBComputer::abort_sq()
     }
 }
 
+// ============================ warm restart ===============================
+//
+// Every change of the sequence state is journaled by update(), and setup() resumes from the
+// journal after a warm reset. The stage timers are not journaled: a resumed stage starts over.
+
+DMAMEM journal_t sequence_journal; // not cleared by the start-up code, see Journal.h
+
+/**
+ * @brief Sequence state to journal: FSM state, stages, open valves and passivation flags.
+ */
+journal_entry_t PRBComputer::sequence_entry()
+{
+    journal_entry_t entry;
+    entry.state = state;
+    entry.ignition = ignition_phase;
+    entry.passivation = passivation_phase;
+    entry.abort = abort_phase;
+    entry.valves = (memory.ME_state ? OUT_ME_b : 0) | (memory.MO_state ? OUT_MO_bC : 0) |
+                   (memory.IGNITER_state ? OUT_IGNITER : 0);
+    entry.flags = (memory.passivation ? JOURNAL_PASSIVATION : 0) |
+                  (memory.did_passivation_abort ? JOURNAL_PASSIVATION_ABORT : 0);
+    return entry;
+}
+
+/**
+ * @brief Resumes the sequence journaled before a warm reset. Called from setup(), right after
+ * outputs_begin(), before the first update().
+ *
+ * After any other reset (power-on, brownout, see journal_warm_reset()) the journal is cleared
+ * and nothing is resumed.
+ *
+ * The reset released every output, so the valves are closed. Resume rules:
+ *   - IGNITION_SQ up to BURN_STOP_ME: the burn cannot be resumed (ramp-up check and impulse
+ *     lost), the PRB goes to ABORT from ABORT_OXYDANT, with the journaled passivation request
+ *   - IGNITION_SQ in WAIT_FOR_PASSIVATION: the burn is over, the delay is waited again
+ *   - PASSIVATION_SQ: the stage restarts, the valve it holds open is opened again
+ *   - ABORT: restarts from ABORT_OXYDANT (valves already closed), or if it was waiting for or
+ *     running its passivation, continues it without a second ABORT_PASSIVATION_DELAY
+ *   - IDLE and CLEAR_TO_IGNITE: nothing to resume, the master arms again
+ *
+ * @param reset_cause SRC_SRSR read at start-up.
+ * @return true if a sequence was resumed.
+ */
+FLASHMEM bool PRBComputer::resume(uint32_t reset_cause)
+{
+    if (!journal_warm_reset(reset_cause)) {
+        journal_clear(&sequence_journal);
+        return false;
+    }
+
+    journal_record_t record;
+    if (!journal_read(&sequence_journal, &record)) return false;
+
+    const journal_entry_t &entry = record.entry;
+    int time = millis();
+    uint32_t passivation_valves = entry.valves & (OUT_ME_b | OUT_MO_bC);
+    memory.passivation = entry.flags & JOURNAL_PASSIVATION;
+    memory.did_passivation_abort = entry.flags & JOURNAL_PASSIVATION_ABORT;
+
+    switch (entry.state)
+    {
+    case IGNITION_SQ:
+        if (entry.ignition == WAIT_FOR_PASSIVATION) {
+            state = IGNITION_SQ;
+            ignition_phase = WAIT_FOR_PASSIVATION;
+            memory.time_ignition = time;
+        } else {
+            state = ABORT;
+            abort_phase = ABORT_OXYDANT;
+            memory.time_abort = time;
+        }
+        break;
+
+    case PASSIVATION_SQ:
+        state = PASSIVATION_SQ;
+        passivation_phase = (passivationStage)entry.passivation;
+        memory.time_passivation = time;
+        if (passivation_phase != SLEEP) set_valves(passivation_valves, 0);
+        break;
+
+    case ABORT:
+        state = ABORT;
+        if (entry.abort == WAIT_FOR_PASSIVATION_ABORT) {
+            abort_phase = WAIT_FOR_PASSIVATION_ABORT;
+            memory.time_abort = time;
+            if (memory.did_passivation_abort) {
+                memory.time_abort = time - ABORT_PASSIVATION_DELAY;
+                passivation_phase = (passivationStage)entry.passivation;
+                memory.time_passivation = time;
+                if (passivation_phase != SLEEP) set_valves(passivation_valves, 0);
+            }
+        } else {
+            abort_phase = ABORT_OXYDANT;
+            memory.time_abort = time;
+        }
+        break;
+
+    default:
+        return false;
+    }
+    return true;
+}
+
+// ============================ master clock sync ===============================
+//
+// The AV_NET_PRB_TIMESTAMP handler only posts the exchange, the clock estimate is read and
+// corrected by the main loop alone (update()).
+
+static volatile bool sync_request = false;
+static volatile uint32_t sync_local_us;
+static volatile uint32_t sync_master_us;
+
+/**
+ * @brief Posts the master time received with AV_NET_PRB_TIMESTAMP, stamped with micros() now.
+ *
+ * Called from the Wire1 receive handler. A newer exchange replaces one not yet applied.
+ */
+FASTRUN void post_master_time(uint32_t master_us) {
+    sync_local_us = micros();
+    sync_master_us = master_us;
+    sync_request = true;
+}
+
 // ============================ I2C multiplexer control ===============================
+//
+// The sensor bus (Wire2 and the mux RESET pin) is owned by the main loop. The Wire2 master is
+// polled, so its transactions run with interrupts enabled and the Wire1 slave handlers are never
+// held off by a sensor read. A handler that needs the mux posts a request, applied by update()
+// between two transactions.
+
+static volatile bool mux_reset_request = false;
+
+/**
+ * @brief Requests the I2C multiplexer to be deactivated (RESET held LOW).
+ *
+ * Safe to call from the Wire1 handlers: the RESET pin is only driven by update(), outside of
+ * any Wire2 transaction. The next sensor sweep re-activates the multiplexer.
+ */
+void request_mux_reset() {
+    mux_reset_request = true;
+}
+
+/**
+ * @brief Configures the ADC pins of the analog sensors of sensor_table. Called from setup().
+ */
+FLASHMEM void sensor_pins_begin() {
+    for (const sensor_desc_t &sensor : sensor_table) {
+        if (!is_sensata(sensor)) pinMode(sensor.source, INPUT);
+    }
+}
 
 /**
  * @brief Selects a specific I2C channel on the multiplexer.
@@ -620,11 +1118,9 @@ void selectI2CChannel(int channel) {
     delay(10);
     digitalWrite(RESET, HIGH);
 
-    noInterrupts();
     Wire2.beginTransmission(MUX_ADDR);
     Wire2.write(channel); // Enable only the selected channel
     Wire2.endTransmission();
-    interrupts();
 }
 
 
@@ -636,11 +1132,9 @@ void selectI2CChannel(int channel) {
  * through the multiplexer. It uses the Wire2 interface for communication.
  */
 void endI2CCommunication() {
-    noInterrupts();
     Wire2.beginTransmission(MUX_ADDR);
     Wire2.write(0); // Disable all channels
     Wire2.endTransmission();
-    interrupts();
 }
 
  /**
@@ -663,38 +1157,44 @@ void PRBComputer::ignite(int time)
  *
  * This function manages the state machine of the PRBComputer, handling different states
  * such as IDLE, CLEAR_TO_IGNITE, IGNITION_SQ, PASSIVATION_SQ, and ABORT. It also reads
- * various sensors (temperature and pressure) and updates the internal memory with the
- * latest readings. The function includes optional debug output to print the current state
- * and sensor values at regular intervals.
+ * the sensors due in the schedule of the current phase (sensor_table) and updates the
+ * internal memory with the latest readings. The function includes optional debug output to
+ * print the current state, sensor values and achieved sample rates at regular intervals.
  *
  * @param time The current time (in milliseconds) used for timing operations.
  */
-void PRBComputer::update(int time)
+FASTRUN void PRBComputer::update(int time)
 {
+    uint32_t cycles = ARM_DWT_CYCCNT;
+
+    // the FSM LED colours take over from the start-up show when the master moves the FSM
+    if (state != IDLE && status.show_step != STARTUP_SHOW_DONE) end_startup_show();
+
     switch (state)
     {
         case IDLE:
-            if (!memory.status_led && time - memory.time_led >= LED_TIMEOUT) {
+            if (startup_show(time)) break;
+            if (!status.status_led && time - status.time_led >= LED_TIMEOUT) {
                 status_led(TEAL);
-                memory.time_led = time;
-                memory.status_led = true;
-            } else if (memory.status_led && time - memory.time_led >= LED_TIMEOUT) {
+                status.time_led = time;
+                status.status_led = true;
+            } else if (status.status_led && time - status.time_led >= LED_TIMEOUT) {
                 status_led(OFF);
-                memory.time_led = time;
-                memory.status_led = false;
+                status.time_led = time;
+                status.status_led = false;
             }
 
             break;
         
         case CLEAR_TO_IGNITE:
-            if (!memory.status_led && time - memory.time_led >= LED_TIMEOUT) {
+            if (!status.status_led && time - status.time_led >= LED_TIMEOUT) {
                 status_led(ORANGE);
-                memory.time_led = time;
-                memory.status_led = true;
-            } else if (memory.status_led && time - memory.time_led >= LED_TIMEOUT) {
+                status.time_led = time;
+                status.status_led = true;
+            } else if (status.status_led && time - status.time_led >= LED_TIMEOUT) {
                 status_led(OFF);
-                memory.time_led = time;
-                memory.status_led = false;
+                status.time_led = time;
+                status.status_led = false;
             }
             break;
 
@@ -717,77 +1217,299 @@ void PRBComputer::update(int time)
             break;
     }
 
-    if(time - memory.time_sensors_update > SENSORS_POLLING_RATE_MS) {
-        memory.ein_temp_sensata = read_temperature(EIN_CH);
-        memory.ein_press = read_pressure(EIN_CH);
-        memory.ccc_temp = read_temperature(CCC_CH);
-        memory.ccc_press = read_pressure(CCC_CH);
-        memory.oin_temp = read_temperature(T_OIN);
-        memory.ein_temp_pt1000 = read_temperature(T_EIN);
-        memory.oin_press = read_pressure(P_OIN);
-        memory.time_sensors_update = time;
-
-#ifdef INTEGRATE_CHAMBER_PRESSURE
-        if (memory.calculate_integral) {
-            if (memory.integral_past_time == 0) {
-                memory.integral_past_time = time;
-            } else {
-                float chamber_pressure_pa = memory.ccc_press / 1e5;
+    status.control_cycles = ARM_DWT_CYCCNT - cycles;
+    if (status.control_cycles > status.control_cycles_max) status.control_cycles_max = status.control_cycles;
+
+    if constexpr (PROFILE.telemetry_stream) {
+        // report FSM transitions, including the ones requested by the I2C handlers
+        if (state != status.reported_state || ignition_phase != status.reported_ignition ||
+            passivation_phase != status.reported_passivation || abort_phase != status.reported_abort) {
+            telemetry_state(state, ignition_phase, passivation_phase, abort_phase);
+            status.reported_state = state;
+            status.reported_ignition = ignition_phase;
+            status.reported_passivation = passivation_phase;
+            status.reported_abort = abort_phase;
+        }
+        // valve edges, including the ones commanded by the I2C handlers
+        uint32_t valves = outputs_levels() & OUT_VALVES;
+        if (valves != status.reported_valves) {
+            static const int valve_pins[] = {ME_b, MO_bC, IGNITER};
+            for (int pin : valve_pins) {
+                uint32_t bit = valve_output(pin);
+                if ((valves ^ status.reported_valves) & bit) telemetry_valve(pin, valves & bit);
+            }
+            status.reported_valves = valves;
+        }
+    }
 
-                memory.integral += chamber_pressure_pa * (time - memory.integral_past_time)/1000; // in Pa.ms
-                memory.integral_past_time = time;
-                memory.engine_total_impulse = I_SP * G * (AREA_THROAT/C_STAR) * memory.integral;
+    // every sequence transition is journaled for a warm restart (resume())
+    journal_entry_t entry = sequence_entry();
+    if (memcmp(&entry, &journaled, sizeof(entry))) {
+        journal_write(&sequence_journal, &entry, time);
+        journaled = entry;
+    }
+
+    if (mux_reset_request) {
+        mux_reset_request = false;
+        digitalWrite(RESET, LOW); // Deactivate MUX
+    }
+
+    if (sync_request) {
+        noInterrupts();
+        uint32_t local_us = sync_local_us;
+        uint32_t master_us = sync_master_us;
+        sync_request = false;
+        interrupts();
+        clock_sync_update(&memory.clock, local_us, master_us);
+        telemetry_clock(&memory.clock);
+    }
+
+    if (status.startup && (status.time_ready >= 0 || time >= SAMPLE_STARTUP_MAX_MS)) status.startup = false;
+
+    if constexpr (PROFILE.idle_sleep) sensata_power(time);
+
+    // sensor schedule of the current phase, follows the FSM transitions of this tick
+    sample_phase_t phase = get_sample_phase();
+    uint8_t due = 0;
+    for (const sensor_desc_t &sensor : sensor_table) {
+        if (time - status.time_sampled[sensor.channel] >= sensor.period_ms[phase]) due |= 1 << sensor.channel;
+    }
+    if constexpr (PROFILE.idle_sleep) {
+        if (status.sensata_asleep) due &= ~sensata_channels();
+        due |= status.sensata_waking;
+    }
+    memory.fresh_samples = 0;
+
+    if (due) {
+        cycles = ARM_DWT_CYCCNT;
+        uint8_t fresh = read_sensors(due);
+        memory.fresh_samples = fresh;
+        for (int channel = 0; channel < TLM_CHANNELS; channel++) {
+            if (due & (1 << channel)) status.time_sampled[channel] = time;
+            if (fresh & (1 << channel)) status.sample_count[channel]++;
+        }
+        if (status.time_ready < 0) {
+            status.first_samples |= fresh;
+            if (status.first_samples == (1 << TLM_CHANNELS) - 1) status.time_ready = time;
+        }
+
+        // stale samples are not re-sent, the fresh ones are queued for the master and go out
+        // as one packed record
+        if (fresh) {
+            sample_record_t record;
+            record.t_us = clock_sync_time(&memory.clock, micros());
+            record.mask = fresh;
+            for (const sensor_desc_t &sensor : sensor_table) {
+                record.values[sensor.channel] = memory.*sensor.value;
             }
+            fifo_push(&samples, &record);
+            telemetry_samples(&record);
         }
-#endif
+
+        status.sweep_cycles = ARM_DWT_CYCCNT - cycles;
+        if (status.sweep_cycles > status.sweep_cycles_max) status.sweep_cycles_max = status.sweep_cycles;
     }
 
-#ifdef DEBUG
-    if (time - memory.time_print >= LED_TIMEOUT) {
-        Serial.print("State : ");
-        Serial.println(state);
-        Serial.print("EIN T°: ");
-        Serial.println(memory.ein_temp_sensata);
-        Serial.print("EIN P: ");
-        Serial.println(memory.ein_press);
-        Serial.print("CCC T°: ");
-        Serial.println(memory.ccc_temp);
-        Serial.print("CCC P: ");
-        Serial.println(memory.ccc_press);
-        Serial.print("OIN T°: ");
-        Serial.println(memory.oin_temp);
-        Serial.print("EIN T° (PT1000): ");
-        Serial.println(memory.ein_temp_pt1000);
-        Serial.print("OIN P: ");
-        Serial.println(memory.oin_press);
-        memory.time_print = time;
+    if constexpr (PROFILE.idle_sleep) {
+        if (status.sensata_waking) {
+            status.sensata_waking &= ~memory.fresh_samples;
+            uint32_t woken_us = micros() - status.time_woken_us;
+            if (!status.sensata_waking) status.wake_latency_us = woken_us;
+            else if (woken_us >= SENSATA_WAKE_MAX_MS * 1000u) status.sensata_waking = 0;
+        }
     }
+
+    // loop-time report, on the debug dump or the telemetry stream depending on the profile
+    if (time - status.time_print >= LED_TIMEOUT) {
+        // achieved rate of every channel over the report window, new samples only
+        for (int channel = 0; channel < TLM_CHANNELS; channel++) {
+            status.sample_rate[channel] = status.sample_count[channel] * 10000 / (time - status.time_print);
+            status.sample_count[channel] = 0;
+        }
+        if constexpr (PROFILE.idle_sleep) {
+            uint32_t asleep = status.sleep_us / (time - status.time_print);    // [0.1 %]
+            status.awake_duty = asleep >= 1000 ? 0 : 1000 - asleep;
+            status.sleep_us = 0;
+        }
+        if constexpr (PROFILE.debug) {
+            Serial.print("State : ");
+            Serial.println(state);
+            Serial.print("EIN T°: ");
+            Serial.println(memory.ein_temp_sensata);
+            Serial.print("EIN P: ");
+            Serial.println(memory.ein_press);
+            Serial.print("CCC T°: ");
+            Serial.println(memory.ccc_temp);
+            Serial.print("CCC P: ");
+            Serial.println(memory.ccc_press);
+            if constexpr (PROFILE.pressure_estimator) {
+                Serial.print("CCC P est / rate / noise / lag: ");
+                Serial.print(memory.ccc_estimator.press);
+                Serial.print(" / ");
+                Serial.print(memory.ccc_estimator.rate);
+                Serial.print(" / ");
+                Serial.print(memory.ccc_estimator.noise);
+                Serial.print(" / ");
+                Serial.println(estimator_lag_ms(&memory.ccc_estimator));
+            }
+            Serial.print("OIN T°: ");
+            Serial.println(memory.oin_temp);
+            Serial.print("EIN T° (PT1000): ");
+            Serial.println(memory.ein_temp_pt1000);
+            Serial.print("OIN P: ");
+            Serial.println(memory.oin_press);
+            Serial.print("Sensor flags (EIN CCC OIN T_OIN T_EIN): 0x");
+            Serial.println(memory.sensor_flags, HEX);
+            Serial.print("Fresh samples: 0x");
+            Serial.println(memory.fresh_samples, HEX);
+            Serial.print("Sample rates [Hz] (CCC_P EIN_P CCC_T EIN_T OIN_T T_EIN OIN_P):");
+            for (int channel = 0; channel < TLM_CHANNELS; channel++) {
+                Serial.print(" ");
+                Serial.print(status.sample_rate[channel] / 10.0f, 1);
+            }
+            Serial.println();
+            Serial.print("FSM tick [cycles] last/max: ");
+            Serial.print(status.control_cycles);
+            Serial.print(" / ");
+            Serial.println(status.control_cycles_max);
+            Serial.print("Sensor sweep [cycles] last/max: ");
+            Serial.print(status.sweep_cycles);
+            Serial.print(" / ");
+            Serial.println(status.sweep_cycles_max);
+            Serial.print("Every channel sampled [ms after reset]: ");
+            Serial.println(status.time_ready);
+            Serial.print("Clock sync error [us] / drift [ppm] / exchanges / rejected: ");
+            Serial.print(clock_sync_error(&memory.clock, micros()));
+            Serial.print(" / ");
+            Serial.print(memory.clock.drift * 1e6f);
+            Serial.print(" / ");
+            Serial.print(memory.clock.exchanges);
+            Serial.print(" / ");
+            Serial.println(memory.clock.rejected);
+            if constexpr (PROFILE.idle_sleep) {
+                Serial.print("Awake [%] / Sensatas asleep / wake-up [us]: ");
+                Serial.print(status.awake_duty / 10.0f, 1);
+                Serial.print(" / ");
+                Serial.print(status.sensata_asleep);
+                Serial.print(" / ");
+                Serial.println(status.wake_latency_us);
+            }
+        }
+        telemetry_stats(status.control_cycles_max, status.sweep_cycles_max, status.time_ready);
+        telemetry_rates(status.sample_rate);
+        telemetry_clock_stats(micros());
+        if constexpr (PROFILE.idle_sleep) telemetry_power(status.awake_duty, status.sensata_asleep, status.wake_latency_us);
+        status.control_cycles_max = 0;
+        status.sweep_cycles_max = 0;
+        status.time_print = time;
+    }
+}
+
+// ============================ idle power ===============================
+
+// Wait For Interrupt, unless the core provides it (the host core runs its virtual clock). The
+// "memory" clobber makes the compiler reload what an interrupt handler may have changed.
+#ifndef __WFI
+#define __WFI() __asm__ volatile("wfi" ::: "memory")
 #endif
+
+/**
+ * @brief Time left until the next task of update() in IDLE: a due sensor, the LED blink or
+ * the loop-time report [ms].
+ */
+int PRBComputer::next_task(int time)
+{
+    int wait = LED_TIMEOUT - (time - status.time_led);
+    if (LED_TIMEOUT - (time - status.time_print) < wait) wait = LED_TIMEOUT - (time - status.time_print);
+
+    sample_phase_t phase = get_sample_phase();
+    for (const sensor_desc_t &sensor : sensor_table) {
+        if (status.sensata_asleep && is_sensata(sensor)) continue;
+        int sensor_wait = sensor.period_ms[phase] - (time - status.time_sampled[sensor.channel]);
+        if (sensor_wait < wait) wait = sensor_wait;
+    }
+    return wait;
+}
+
+/**
+ * @brief Sleeps the core in IDLE until the next task of update() (profile idle_sleep). Called
+ * by loop() after update().
+ *
+ * The core waits in WFI, woken by every interrupt: SysTick (millis(), 1 ms) and the Wire1
+ * handlers. It returns as soon as a handler moved the FSM or posted work for update() (mux
+ * reset, clock sync), else when the next task is due. Only with the Sensatas asleep and the
+ * start-up show over, so the start-up schedule and every other state run flat out.
+ * The time spent here gives the awake duty cycle of the loop-time report (awake_duty).
+ *
+ * @param time The time passed to the last update() [ms].
+ */
+FASTRUN void PRBComputer::idle_wait(int time)
+{
+    if constexpr (PROFILE.idle_sleep) {
+        if (state != IDLE || !status.sensata_asleep || status.show_step != STARTUP_SHOW_DONE) return;
+
+        int wait = next_task(time);
+        uint32_t start_us = micros();
+        // state is set by the Wire1 handlers but not volatile: read it through a volatile access,
+        // whatever clobbers the __WFI() of the core declares
+        const volatile PRB_FSM &fsm_state = state;
+        while (fsm_state == IDLE && !mux_reset_request && !sync_request && (int)millis() - time < wait) __WFI();
+        status.sleep_us += micros() - start_us;
+    }
 }
 
 // =============== status LED configuration ===============
 
 void status_led(RGBColor color) {
-    digitalWrite(RGB_RED, color.red);
-    digitalWrite(RGB_GREEN, color.green);
-    digitalWrite(RGB_BLUE, color.blue);
+    outputs_write(OUT_LED, (color.red ? OUT_LED_RED : 0) | (color.green ? OUT_LED_GREEN : 0) |
+                           (color.blue ? OUT_LED_BLUE : 0));
 }
 
-void turn_on_sequence()
+// Start-up show, run by update() in IDLE instead of blocking setup(): the FSM, the sensors and
+// the Wire1 handlers are live from the first loop.
+typedef struct startup_step_t
 {
-  digitalWrite(LED_BUILTIN, HIGH);
+    RGBColor color;
+    uint16_t duration_ms;
+    uint16_t tone_hz;               // buzzer for the whole step, 0: silent
+}startup_step_t;
+
+static const startup_step_t startup_steps[] = {
+    {BLUE, 500, 0},
+    {GREEN, 500, 0},
+    {RED, 500, 0},
+    {WHITE, 1000, 440},
+};
+#define STARTUP_STEPS   (sizeof(startup_steps) / sizeof(startup_steps[0]))
 
-  status_led(BLUE);
-  delay(500);
-  status_led(GREEN);
-  delay(500);
-  status_led(RED);
-  delay(500);
-  status_led(WHITE);
-  tone(BUZZER, 440, 1000);
-  delay(1000);
-  noTone(BUZZER);
-  status_led(OFF);
+/**
+ * @brief Advances the start-up LED / buzzer show, never waits.
+ *
+ * @return true while the show owns the status LED.
+ */
+FLASHMEM bool PRBComputer::startup_show(int time)
+{
+    if (status.show_step == STARTUP_SHOW_DONE) return false;
+    if (status.show_step > 0 && time - status.time_show < startup_steps[status.show_step - 1].duration_ms) return true;
 
-  digitalWrite(LED_BUILTIN, LOW);
+    if (status.show_step == STARTUP_STEPS) {
+        end_startup_show();
+        status.time_led = time;
+        return false;
+    }
+    if (status.show_step == 0) digitalWrite(LED_BUILTIN, HIGH);
+    const startup_step_t &step = startup_steps[status.show_step];
+    status_led(step.color);
+    if (step.tone_hz) tone(BUZZER, step.tone_hz, step.duration_ms);
+    status.time_show = time;
+    status.show_step++;
+    return true;
+}
+
+FLASHMEM void PRBComputer::end_startup_show()
+{
+    status.show_step = STARTUP_SHOW_DONE;
+    noTone(BUZZER);
+    status_led(OFF);
+    digitalWrite(LED_BUILTIN, LOW);
 }
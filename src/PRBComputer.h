@@ -11,7 +11,7 @@
  *    - State machine management for ignition, passivation, and abort sequences
  *    - Valve control methods (open/close for main engine, oxidizer, and igniter)
  *    - Sensor reading functions for pressure and temperature (analog and I2C)
- *    - Memory structure for storing system state, sensor data, and control flags
+ *    - Memory structures for the hot control state and the cold status bookkeeping
  *    - Getters and setters for system state and memory
  *    - High-level ignition and shutdown sequence logic
  *
@@ -22,39 +22,146 @@
 #include "constant.h"
 #include "./2024_C_AV_INTRANET/intranet_commands.h"
 #include "PTE7300_I2C.h"
+#include "Telemetry.h"
+#include "PressureEstimator.h"
+#include "Outputs.h"
+#include "SignalMath.h"
+#include "SampleFifo.h"
+#include "ClockSync.h"
+#include "Journal.h"
+
+// Sensors monitored by the health checks (bit index in prb_memory_t::sensor_flags)
+enum sensor_id_t
+{
+    SENSOR_EIN,                     // Sensata EIN_CH (pressure and temperature)
+    SENSOR_CCC,                     // Sensata CCC_CH (pressure and temperature)
+    SENSOR_OIN,                     // P_OIN, Kulite or Sensata channel 3
+    SENSOR_T_OIN,                   // PT1000
+    SENSOR_T_EIN,                   // PT1000
+    SENSORS
+};
+
+#define SENSOR_FAULT_READ   0x01    // SENSOR_FAIL_READS consecutive failed reads
+#define SENSOR_FAULT_STUCK  0x02    // raw pressure unchanged for SENSOR_STUCK_READS reads and SENSOR_STUCK_MS
+#define SENSOR_FAULT_RANGE  0x04    // raw value outside the sensor span (open / short / saturated)
+#define SENSOR_FAULT_STALE  0x08    // no new conversion for SENSOR_STALE_READS reads and SENSOR_STALE_MS
+
+typedef struct sensor_health_t
+{
+    uint8_t faults;                 // SENSOR_FAULT_* currently raised
+    uint8_t failed_reads;           // consecutive failed reads
+    uint8_t unchanged;              // consecutive reads with the same raw pressure
+    uint8_t stale;                  // consecutive reads without a new pressure conversion
+    int16_t last_raw;               // last raw pressure
+    int time_changed;               // time @ which the raw pressure last changed [ms]
+    int time_fresh;                 // time @ which the last new pressure conversion was read [ms]
+}sensor_health_t;
+
+// Phases of the sensor schedule (index of sensor_desc_t::period_ms)
+enum sample_phase_t
+{
+    SAMPLE_STARTUP,                 // IDLE after reset, until every channel got a new sample
+    SAMPLE_IDLE,                    // IDLE
+    SAMPLE_ARMED,                   // CLEAR_TO_IGNITE
+    SAMPLE_SEQUENCE,                // ignition sequence up to the main valves, passivation, abort
+    SAMPLE_BURN,                    // main valves open: BURN_START_ME to BURN_STOP_ME
+    SAMPLE_PHASES
+};
 
+// Hot state: read or written on every control tick during the burn. Burn-critical fields come
+// first. The global PRBComputer lives in DTCM (Teensy 4.x default for static data), so this is
+// single-cycle, cache-free memory.
 typedef struct prb_memory_t
 {
+    float ccc_press;                // CCC pressure (Sensata) [bar]
+    pressure_estimator_t ccc_estimator; // CCC pressure and rate estimate (profile pressure_estimator)
+    float integral;                 // chamber pressure integral [Pa.s], integrate_chamber_pressure() only
+    int integral_past_time;         // past time for integral calculation [ms]
+    float engine_total_impulse;     // engine specific impulse [N.s]
+    bool calculate_integral;        // flag to start/stop integral calculation
+    bool check_press_done;
+    int ccc_press_index;            // Index for circular buffer
+    float ccc_press_buffer[5];      // CCC pressure buffer for moving average [bar]
+    float mean_ccc_press;           // mean or estimated CCC pressure (for pressure check) [bar]
     int time_ignition;              // time @ which ignition starts [ms]
-    int time_passivation;           // time @ which shutdown starts [ms]
     int time_abort;                 // time @ which abort starts [ms]
-    int time_sensors_update;        // time @which sensors where last updated [ms]
-    bool status_led;                // status LED state
+    int time_passivation;           // time @ which shutdown starts [ms]
     bool ME_state;                  // ME valve state
     bool MO_state;                  // MO valve state
     bool IGNITER_state;             // IGNITER state
-    int time_led;                   // time @ which LED state changes [ms]
-    int time_print;                 // time @ which print occurs [ms]
+    bool passivation;               // flag to start/stop passivation sequence
+    bool did_passivation_abort;
+    float ein_press;                // EIN pressure (Sensata) [bar]
+    float ccc_temp;                 // CCC temperature (Sensata) [°C]
+    float ein_temp_sensata;         // EIN temperature (Sensata) [°C]
     float oin_temp;                 // OIN temperature (PT1000) [°C]
     float ein_temp_pt1000;          // EIN temperature (PT1000) [°C]
     float oin_press;                // OIN pressure (Kulite) [bar]
-    float ein_temp_sensata;         // EIN temperature (Sensata) [°C]
-    float ein_press;                // EIN pressure (Sensata) [bar]
-    float ccc_temp;                 // CCC temperature (Sensata) [°C]
-    float ccc_press;                // CCC pressure (Sensata) [bar]
-    float ccc_press_buffer[5];      // CCC pressure buffer for moving average [bar]
-    int ccc_press_index;            // Index for circular buffer
-    float integral;                 // integral [bar.s]
-    float engine_total_impulse;     // engine specific impulse [N.s]
-    int integral_past_time;         // past time for integral calculation [ms]
-    bool calculate_integral;        // flag to start/stop integral calculation
-    bool passivation;               // flag to start/stop passivation sequence
-    float mean_ccc_press;           // mean CCC pressure (for pressure check) [bar]
-    int time_burn_debug;            // time @ which burn debug starts [ms]
-    bool check_press_done;
-    bool did_passivation_abort;
+    uint8_t sensor_flags;           // bit (1 << sensor_id_t) set while a sensor has a fault raised
+    uint8_t fresh_samples;          // bit (1 << telemetry_channel_t) set if the last update() got a new value
+    clock_sync_t clock;             // master clock estimate (AV_NET_PRB_TIMESTAMP), times of the published samples
 }prb_memory_t;
 
+// Acquisition of a sensor_desc_t entry, which also selects its calibration input
+enum sensor_kind_t : uint8_t
+{
+    SENSOR_KIND_SENSATA_T,          // PTE7300 DSP_T on SENSOR_WIRE (mux channel) or the CCC bus
+    SENSOR_KIND_SENSATA_S,          // PTE7300 DSP_S, sends the single-shot trigger of the sensor
+    SENSOR_KIND_PT1000,             // PT1000 divider on an ADC pin
+    SENSOR_KIND_KULITE,             // Kulite amplifier on an ADC pin
+};
+
+#define SENSOR_PRESSURE     0x01    // negative values clamped to 0
+#define SENSOR_ESTIMATOR    0x02    // fresh values feed memory.ccc_estimator (profile pressure_estimator)
+
+// One sampled channel, see sensor_table in PRBComputer.cpp
+typedef struct sensor_desc_t
+{
+    uint8_t channel;                    // telemetry_channel_t: sample bit, FIFO and telemetry slot
+    sensor_kind_t kind;
+    uint8_t source;                     // multiplexer channel (Sensata) or ADC pin
+    sensor_id_t health;                 // health checks the reads count for
+    uint8_t flags;                      // SENSOR_PRESSURE, SENSOR_ESTIMATOR
+    float (*calibration)(int raw);      // DSP counts or ADC code to bar / °C (SignalMath.h)
+    float prb_memory_t::*value;         // memory slot of the last value
+    uint16_t period_ms[SAMPLE_PHASES];  // sample period in each schedule phase, 0 on every loop
+}sensor_desc_t;
+
+#define STARTUP_SHOW_DONE   0xFF
+
+// Cold bookkeeping: LED blinking, debug output and loop timing, never on the burn path.
+typedef struct prb_status_t
+{
+    bool status_led;                // status LED state
+    int time_led;                   // time @ which LED state changes [ms]
+    int time_print;                 // time @ which print occurs [ms]
+    int time_burn_debug;            // time @ which burn debug starts [ms]
+    uint8_t show_step;              // next step of the start-up LED / buzzer show, STARTUP_SHOW_DONE once over
+    int time_show;                  // time @ which the current show step started [ms]
+    bool startup;                   // SAMPLE_STARTUP schedule in IDLE
+    uint8_t first_samples;          // bit (1 << telemetry_channel_t) set once the channel got a new sample
+    int time_ready;                 // time @ which every channel had a new sample [ms after reset], -1 before
+    uint32_t control_cycles;        // CPU cycles of the last FSM tick
+    uint32_t control_cycles_max;    // worst FSM tick since last report
+    uint32_t sweep_cycles;          // CPU cycles of the sensor reads of the last update()
+    uint32_t sweep_cycles_max;      // worst sensor reads since last report
+    int time_sampled[TLM_CHANNELS]; // time @ which each channel was last read [ms]
+    uint16_t sample_count[TLM_CHANNELS]; // new samples of each channel since last report
+    uint16_t sample_rate[TLM_CHANNELS];  // achieved rate of each channel over the last report [0.1 Hz]
+    PRB_FSM reported_state;                 // last FSM state sent on the telemetry stream
+    ignitionStage reported_ignition;        // last ignition stage sent on the telemetry stream
+    passivationStage reported_passivation;  // last passivation stage sent on the telemetry stream
+    abortStage reported_abort;              // last abort stage sent on the telemetry stream
+    uint32_t reported_valves;               // OUT_* bits of the open valves sent on the telemetry stream
+    sensor_health_t sensor_health[SENSORS]; // read / stuck / range checks of every sensor
+    bool sensata_asleep;            // Sensatas in sleep mode (IDLE, profile idle_sleep)
+    uint8_t sensata_waking;         // bit (1 << telemetry_channel_t) set until the Sensata channel has a new sample after its wake-up
+    uint32_t time_woken_us;         // micros() @ which the Sensatas were woken
+    int32_t wake_latency_us;        // wake-up command to a new sample on every Sensata channel [us], -1 none yet
+    uint32_t sleep_us;              // time spent in WFI since last report [us]
+    uint16_t awake_duty;            // share of the last report the core was awake [0.1 %]
+}prb_status_t;
+
 
 class PRBComputer
 {
@@ -64,32 +171,58 @@ private:
     passivationStage passivation_phase;
     abortStage abort_phase;
 
-    PTE7300_I2C my_sensor;
+    PTE7300_I2C my_sensor;          // Sensata sensors behind the mux (SENSOR_WIRE)
+    PTE7300_I2C ccc_sensor;         // CCC Sensata, on its own bus unless ccc_on_mux
+    bool ccc_on_mux;                // CCC behind the mux on SENSOR_WIRE (default wiring)
+    bool sample_fresh;              // last read_sensor() got a new conversion
+    int status_channel;             // channel whose STATUS is held in channel_status, -1 if none
+    uint16_t channel_status;        // STATUS read with a Sensata temperature, reused by its pressure
 
     prb_memory_t memory;
+    prb_status_t status;
+    sample_fifo_t samples;          // fresh samples for PRB_NET_SAMPLES (~28 KB, DTCM with the object)
+    journal_entry_t journaled;      // last sequence state written to sequence_journal
 
     //sensor reading
-    float read_pressure(int sensor);
-    float read_temperature(int sensor);
+    float read_sensor(const sensor_desc_t &sensor);
+    void update_health(sensor_id_t sensor, bool read_ok, bool in_range, int raw, bool check_stuck);
+    void update_health_stale(sensor_id_t sensor, bool status_ok);
+    PTE7300_I2C &sensata_for(int sensor);
+    bool on_mux(int sensor);
+    bool sensata_data_ready(PTE7300_I2C &sensata, int channel, uint16_t updated_bit, uint16_t *sensor_status);
+    void sensata_trigger(PTE7300_I2C &sensata, uint16_t sensor_status);
+    uint8_t read_sensors(uint8_t due);
+    void sensata_power(int time);
+    int next_task(int time);
+    bool startup_show(int time);
+    void end_startup_show();
+    journal_entry_t sequence_entry();
 
     //valves sequences
     void ignition_sq();
     void passivation_sq();
     void abort_sq();
+    float ccc_press_estimate();
+    void integrate_chamber_pressure();
 
 public:
-    PRBComputer(PRB_FSM);
+    // ccc_wire: bus of the CCC Sensata, SENSOR_WIRE (behind the mux) or a bus of its own
+    PRBComputer(PRB_FSM, TwoWire &ccc_wire = SENSOR_WIRE);
     ~PRBComputer();
 
     //valve control
     void open_valve(int valve);
     void close_valve(int valve);
+    void set_valves(uint32_t open, uint32_t close);
 
     //getters
-    prb_memory_t get_memory();
+    const prb_memory_t &get_memory();
+    const prb_status_t &get_status();
     PRB_FSM get_state();
     ignitionStage get_ignition_stage();
     passivationStage get_shutdown_stage();
+    sample_phase_t get_sample_phase();
+    size_t drain_samples(uint8_t channel, uint32_t since, uint8_t *block);
 
     //setters
     void set_state(PRB_FSM new_state);
@@ -97,15 +230,21 @@ public:
     void set_passivation_stage(passivationStage new_stage);
 
     void ignite(int time);
+    bool resume(uint32_t reset_cause);
 
     void update(int time);
+    void idle_wait(int time);
 };
 
 
+extern journal_t sequence_journal;
+
+void sensor_pins_begin();
 void selectI2CChannel(int channel); 
 void endI2CCommunication();
+void request_mux_reset();
+void post_master_time(uint32_t master_us);
 
 void status_led(RGBColor color);
-void turn_on_sequence();
 
 #endif // PRB_COMPUTER_H
\ No newline at end of file
@@ -22,21 +22,25 @@
 #define RAM_ADDR_STATUS	   0x36
 #define RAM_ADDR_ADC_TC    0x26
 
-PTE7300_I2C::PTE7300_I2C()
+PTE7300_I2C::PTE7300_I2C(TwoWire &wire)
 {
+  _wire = &wire;
   _nodeAddress = DEFAULT_NODE_ADDRESS;
   _bUseCRC = false; // CRC flag
+  _bLastReadOK = false;
 }
 
 bool PTE7300_I2C::isConnected()
 {
-	Wire2.write(_nodeAddress);
-    if (Wire2.endTransmission() == 0) {return true;}
+	_wire->write(_nodeAddress);
+    if (_wire->endTransmission() == 0) {return true;}
 	else { return false;}
 }
 
 void PTE7300_I2C::CRC(bool tf) {_bUseCRC = tf;}
 
+bool PTE7300_I2C::readOK() {return _bLastReadOK;}
+
 void PTE7300_I2C::start()
 {
 	uint16_t CMD = 0x8B93; // START command
@@ -67,20 +71,24 @@ unsigned int PTE7300_I2C::readRegister(uint8_t address, unsigned int number, uin
 	if(_bUseCRC)
 	{
 		bytesRead = this->readRegisterCRC(address, number, buffer);
-		if (bytesRead != (number*2)+1)
+		_bLastReadOK = (bytesRead == (number*2)+1);
+		if (!_bLastReadOK)
 		{
-		  // "Error: Could not read from register!"
-		  return NAN;
+		  // "Error: Could not read from register!" (NAK, short frame or CRC error)
+		  for (unsigned int i = 0; i < number; i++) buffer[i] = 0;
+		  return 0;
 		}
 		return bytesRead;
 	}
 	else
 	{
 		bytesRead = this->readRegisterNoCRC(address, number, buffer);
-		if (bytesRead != (number*2))
+		_bLastReadOK = (bytesRead == (number*2));
+		if (!_bLastReadOK)
 		{
-		  // "Error: Could not read from register!"
-		  return NAN;
+		  // "Error: Could not read from register!" (NAK or short frame)
+		  for (unsigned int i = 0; i < number; i++) buffer[i] = 0;
+		  return 0;
 		}
 		return bytesRead;
 	}
@@ -91,19 +99,18 @@ unsigned int PTE7300_I2C::readRegisterNoCRC(uint8_t address, unsigned int number
   
   unsigned int bytesRead = 0; // default return var
 
-  noInterrupts();
-  Wire2.beginTransmission(_nodeAddress);
-  Wire2.write(address); //Send register address
-  Wire2.endTransmission();
-  Wire2.requestFrom(_nodeAddress, number * 2); //Request register, note that register is 2 bytes wide
-  interrupts();
-  bytesRead = Wire2.available();
+  // bus master is polled: no interrupt masking, the Wire1 slave handlers stay live
+  _wire->beginTransmission(_nodeAddress);
+  _wire->write(address); //Send register address
+  _wire->endTransmission();
+  _wire->requestFrom(_nodeAddress, number * 2); //Request register, note that register is 2 bytes wide
+  bytesRead = _wire->available();
   if ( bytesRead >= number * 2 )
   {
     for (int i = 0; i < number; i++)
     {
-      byte lowByte = Wire2.read(); // read low byte
-	  byte highByte = Wire2.read(); // read high byte
+      byte lowByte = _wire->read(); // read low byte
+	  byte highByte = _wire->read(); // read high byte
 	  buffer[i] = highByte << 8 | lowByte; // join two bytes into word (uint16)
     }
   }
@@ -138,26 +145,24 @@ unsigned int PTE7300_I2C::readRegisterCRC(uint8_t address, unsigned int number,
   crc8_hold = this->calc_crc8(0xD5,0xFF,all,3);
   // Serial.println("Info: New CRC8-stub is 0x" + String(crc8_hold, HEX));
 
-  noInterrupts();
-  Wire2.beginTransmission(_nodeAddress | 1); //indicate CRC-transmission by setting first address bit to 1
-  Wire2.write(address); //Send register address
-  Wire2.write((((number*2)-1) << 4) | (crc4 & 0x0F));
-  Wire2.endTransmission();
-  Wire2.requestFrom(_nodeAddress | 1,(number*2)+1); //Request registers, note that registers 2 bytes wide
-  interrupts();
+  _wire->beginTransmission(_nodeAddress | 1); //indicate CRC-transmission by setting first address bit to 1
+  _wire->write(address); //Send register address
+  _wire->write((((number*2)-1) << 4) | (crc4 & 0x0F));
+  _wire->endTransmission();
+  _wire->requestFrom(_nodeAddress | 1,(number*2)+1); //Request registers, note that registers 2 bytes wide
   node = ((_nodeAddress << 1) & 0xFC) | 0x03; // CRC-Flag 1, Readflag 1
-  bytesRead = Wire2.available();
+  bytesRead = _wire->available();
   // Serial.println("Bytes read: " + String(bytesRead, DEC));
   if(bytesRead >= (number*2)+1) 
   {
     for(int i=0;i<number;i++)
     {
-       byte lowByte = Wire2.read(); // read low byte
-	   byte highByte = Wire2.read(); // read high byte
+       byte lowByte = _wire->read(); // read low byte
+	   byte highByte = _wire->read(); // read high byte
 	   buffer[i] = highByte << 8 | lowByte; // join two bytes into word (uint16)
     }
   }
-  int crc8_received = Wire2.read(); // read CRC byte, after reading the databuffer words
+  int crc8_received = _wire->read(); // read CRC byte, after reading the databuffer words
   // Serial.println("CRC8 received: 0x" + String(crc8_received,HEX));
  
   all[0]=node;
@@ -194,15 +199,15 @@ void PTE7300_I2C::writeRegister(uint8_t address, unsigned int number, uint16_t*
 
 void PTE7300_I2C::writeRegisterNoCRC(uint8_t address, unsigned int number, uint16_t* data)
 {
-	Wire2.beginTransmission(_nodeAddress);
-	Wire2.write(address); //Send register address
+	_wire->beginTransmission(_nodeAddress);
+	_wire->write(address); //Send register address
 
 	for (int i = 0; i < number; i++)
 	{
-		Wire2.write(data[i] & 0x00FF); //write low byte
-		Wire2.write((data[i] & 0xFF00) >> 8); // write high byte
+		_wire->write(data[i] & 0x00FF); //write low byte
+		_wire->write((data[i] & 0xFF00) >> 8); // write high byte
 	}
-	Wire2.endTransmission();
+	_wire->endTransmission();
 }
 
 
@@ -213,7 +218,7 @@ void PTE7300_I2C::writeRegisterCRC(uint8_t address, unsigned int number, uint16_
 	unsigned char crc4;
 	unsigned char crc8;
 	unsigned char header[2];
-	unsigned char all[3 + number];
+	unsigned char all[3 + number * 2];
 	unsigned char crc8all;
 	unsigned char crc8_hold_all;
 	unsigned char node;
@@ -233,16 +238,16 @@ void PTE7300_I2C::writeRegisterCRC(uint8_t address, unsigned int number, uint16_
 
 	crc8_hold_all = crc8all;
 
-	Wire2.beginTransmission(_nodeAddress | 1); //indicate CRC-transmission by setting first address bit to 1
-	Wire2.write(address); //Send register address
-	Wire2.write((((number * 2) - 1) << 4) | (crc4 & 0x0F));
+	_wire->beginTransmission(_nodeAddress | 1); //indicate CRC-transmission by setting first address bit to 1
+	_wire->write(address); //Send register address
+	_wire->write((((number * 2) - 1) << 4) | (crc4 & 0x0F));
 	for (int i = 0; i < number; i++)
 	{
-		Wire2.write(data[i] & 0x00FF); //write low byte
-		Wire2.write((data[i] & 0xFF00) >> 8); // write high byte
+		_wire->write(data[i] & 0x00FF); //write low byte
+		_wire->write((data[i] & 0xFF00) >> 8); // write high byte
 	}
-	Wire2.write(crc8all);
-	Wire2.endTransmission();
+	_wire->write(crc8all);
+	_wire->endTransmission();
 
 }
 
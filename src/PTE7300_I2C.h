@@ -9,16 +9,23 @@
 #define PTE7300_I2C_h
 
 #include "Arduino.h"
+#include "Wire.h"
+
+// STATUS register bits
+#define PTE7300_STATUS_IDLE		0x0001	// idle mode and no conversion running (single mode)
+#define PTE7300_STATUS_DSP_S_UP	0x0008	// DSP_S updated since it was last read
+#define PTE7300_STATUS_DSP_T_UP	0x0010	// DSP_T updated since it was last read
 
 class PTE7300_I2C
 {
   public:
-    // constructor
-	PTE7300_I2C();
+    // constructor, on the given bus master (Wire2 behind the multiplexer by default)
+	PTE7300_I2C(TwoWire &wire = Wire2);
 	
 	// low-level functions
 	bool		  isConnected(); // check connectivity of device to the I2C-bus
 	void		  CRC(bool tf);	// use CRC checking on datatransmission on/off (default true)
+	bool		  readOK();		// last register read complete (and CRC valid), the value is 0 otherwise
 	
 	// high-level functions
 	uint32_t      readSERIAL();
@@ -30,11 +37,17 @@ class PTE7300_I2C
 	void 	      sleep();
 	void 		  idle();
 	void 		  reset();
+
+	// CRC of the framed transfers (public for the host benchmarks)
+	static char   calc_crc4(unsigned char polynom, unsigned char init, unsigned char* data, unsigned int len);
+	static char   calc_crc8(unsigned char polynom, unsigned char init, unsigned char* data, unsigned int len);
 	
   private:
     // class properties
+	TwoWire *_wire;
 	int _nodeAddress;
 	bool _bUseCRC;
+	bool _bLastReadOK;
 	
 	// static functions	
 	unsigned int  readRegister(uint8_t address, unsigned int number, uint16_t *buffer);
@@ -43,8 +56,6 @@ class PTE7300_I2C
 	void          writeRegisterNoCRC(uint8_t address, unsigned int number, uint16_t *data);
 	void 		  writeRegisterCRC(uint8_t address, unsigned int number, uint16_t *data);
 	void          writeRegister(uint8_t address, unsigned int number, uint16_t *data);
-	static char   calc_crc4(unsigned char polynom, unsigned char init, unsigned char* data, unsigned int len);
-	static char   calc_crc8(unsigned char polynom, unsigned char init, unsigned char* data, unsigned int len);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+ * File: PressureEstimator.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the chamber pressure alpha-beta estimator declared in PressureEstimator.h.
+ */
+
+#include "PressureEstimator.h"
+
+void estimator_reset(pressure_estimator_t *estimator)
+{
+    estimator->press = 0.0;
+    estimator->rate = 0.0;
+    estimator->noise = 0.0;
+    estimator->bias = 0.0;
+    estimator->time_us = 0;
+    estimator->samples = 0;
+}
+
+/**
+ * @brief Corrects the estimate with a new measurement.
+ *
+ * Predict to the measurement time, then correct pressure and rate with the fixed gains
+ * ESTIMATOR_ALPHA / ESTIMATOR_BETA. The first measurement initialises the pressure, the second
+ * one the rate. NAN measurements (failed reads) are ignored, the estimate keeps coasting.
+ */
+FASTRUN void estimator_update(pressure_estimator_t *estimator, float measured, uint32_t time_us)
+{
+    if (isnan(measured)) return;
+
+    if (estimator->samples == 0) {
+        estimator->press = measured;
+        estimator->time_us = time_us;
+        estimator->samples = 1;
+        return;
+    }
+
+    float dt = (time_us - estimator->time_us) / 1e6f;
+    if (dt <= 0.0f) return;
+
+    if (estimator->samples == 1) {
+        estimator->rate = (measured - estimator->press) / dt;
+        estimator->press = measured;
+        estimator->time_us = time_us;
+        estimator->samples = 2;
+        return;
+    }
+
+    float predicted = estimator->press + estimator->rate * dt;
+    float innovation = measured - predicted;
+    estimator->press = predicted + ESTIMATOR_ALPHA * innovation;
+    estimator->rate += ESTIMATOR_BETA / dt * innovation;
+    estimator->time_us = time_us;
+
+    estimator->bias += ESTIMATOR_STATS_GAIN * (innovation - estimator->bias);
+    float variance = estimator->noise * estimator->noise;
+    variance += ESTIMATOR_STATS_GAIN * (innovation * innovation - variance);
+    estimator->noise = sqrtf(variance);
+}
+
+/**
+ * @brief Estimated pressure at the given time, extrapolated along the estimated slope.
+ *
+ * The extrapolation is capped at ESTIMATOR_MAX_HORIZON_MS after the last measurement so a
+ * sensor that stops answering freezes the estimate instead of letting it run away, and the
+ * estimate is clamped at 0 bar as the measured pressures are (a falling slope would otherwise
+ * extrapolate below 0).
+ */
+FASTRUN float estimator_pressure(const pressure_estimator_t *estimator, uint32_t time_us)
+{
+    float press = estimator->press;
+    if (estimator->samples >= 2) {
+        uint32_t elapsed_us = time_us - estimator->time_us;
+        if (elapsed_us > ESTIMATOR_MAX_HORIZON_MS * 1000u) elapsed_us = ESTIMATOR_MAX_HORIZON_MS * 1000u;
+        press += estimator->rate * (elapsed_us / 1e6f);
+    }
+    if (press < 0) press = 0.0; // avoid negative pressures
+    return press;
+}
+
+/**
+ * @brief Current tracking lag: mean innovation over the slope, 0 on a plateau.
+ */
+float estimator_lag_ms(const pressure_estimator_t *estimator)
+{
+    if (fabsf(estimator->rate) < ESTIMATOR_MIN_RATE) return 0.0;
+    return estimator->bias / estimator->rate * 1000.0f;
+}
@@ -0,0 +1,43 @@
+#ifndef PRESSURE_ESTIMATOR_H
+#define PRESSURE_ESTIMATOR_H
+/*
+ * File: PressureEstimator.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Alpha-beta estimator of the chamber pressure and its rate of change (pressure_estimator
+ *  in the build profile).
+ *  In BURN the CCC sensor is read on every loop (SAMPLE_BURN_CCC_MS), but the samples still
+ *  come at an uneven pace (the loops that also read the feed pressures and temperatures take
+ *  longer) and each one is as old as its bus transfer, while the 5-entry moving average used by
+ *  the ramp-up check runs behind the ramp. The estimator tracks pressure and slope with fixed
+ *  gains, constant time per sample, and extrapolates to the time of each control tick.
+ *
+ *  It also keeps a running estimate of:
+ *    - noise: RMS of the innovations (measurement - prediction) [bar]
+ *    - lag: mean innovation divided by the slope, i.e. how far behind the measurements the
+ *      estimate runs on the current ramp [ms]
+ *
+ *  The functions are shared with the host tools (host/estimator).
+ */
+
+#include <stdint.h>
+#include "constant.h"
+
+typedef struct pressure_estimator_t
+{
+    float press;                    // estimated pressure at time_us [bar]
+    float rate;                     // estimated rate of change [bar/s]
+    float noise;                    // RMS innovation [bar]
+    float bias;                     // mean innovation [bar]
+    uint32_t time_us;               // time of the last measurement [us]
+    uint8_t samples;                // measurements seen, saturates at 2
+}pressure_estimator_t;
+
+void estimator_reset(pressure_estimator_t *estimator);
+void estimator_update(pressure_estimator_t *estimator, float measured, uint32_t time_us);
+float estimator_pressure(const pressure_estimator_t *estimator, uint32_t time_us);
+float estimator_lag_ms(const pressure_estimator_t *estimator);
+
+#endif // PRESSURE_ESTIMATOR_H
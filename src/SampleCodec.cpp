@@ -0,0 +1,190 @@
+/*
+ * File: SampleCodec.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the delta / varint sample record codec declared in SampleCodec.h.
+ */
+
+#include "SampleCodec.h"
+
+#define CODEC_MAX_Q     (1 << 30)   // quantised values are clamped to +-2^30, deltas fit in int32
+
+// quantisation step of each channel, telemetry_channel_t order
+static const float codec_lsb[CODEC_CHANNELS] = {
+    CODEC_PRESS_LSB,                // CCC pressure
+    CODEC_PRESS_LSB,                // EIN pressure
+    CODEC_TEMP_LSB,                 // CCC temperature
+    CODEC_TEMP_LSB,                 // EIN temperature (Sensata)
+    CODEC_TEMP_LSB,                 // OIN temperature
+    CODEC_TEMP_LSB,                 // EIN temperature (PT1000)
+    CODEC_PRESS_LSB,                // OIN pressure
+};
+
+static const float codec_inv_lsb[CODEC_CHANNELS] = {
+    1.0f / CODEC_PRESS_LSB, 1.0f / CODEC_PRESS_LSB, 1.0f / CODEC_TEMP_LSB, 1.0f / CODEC_TEMP_LSB,
+    1.0f / CODEC_TEMP_LSB, 1.0f / CODEC_TEMP_LSB, 1.0f / CODEC_PRESS_LSB,
+};
+
+static inline int32_t quantise(int channel, float value)
+{
+    float scaled = value * codec_inv_lsb[channel];
+    if (scaled > CODEC_MAX_Q) return CODEC_MAX_Q;
+    if (scaled < -CODEC_MAX_Q) return -CODEC_MAX_Q;
+    return (int32_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline size_t put_varint(uint8_t *output, uint32_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80) {
+        output[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    output[n++] = (uint8_t)value;
+    return n;
+}
+
+// returns the bytes used, 0 if the input ends inside the varint or it is longer than 5 bytes
+static inline size_t get_varint(const uint8_t *input, size_t length, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (size_t n = 0; n < length && n < 5; n++) {
+        result |= (uint32_t)(input[n] & 0x7F) << (7 * n);
+        if (!(input[n] & 0x80)) {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static inline uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+static inline int32_t unzigzag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+/**
+ * @brief Forgets every reference value: the encoder codes its next records absolute, the
+ * decoder skips deltas until it gets them.
+ */
+void codec_reset(sample_codec_t *codec)
+{
+    codec->t_us = 0;
+    for (int c = 0; c < CODEC_CHANNELS; c++) {
+        codec->last[c] = 0;
+        codec->since_key[c] = 0;
+    }
+    codec->synced = 0;
+}
+
+/**
+ * @brief Encodes one record against the previous ones of the stream.
+ *
+ * @param codec  Encoder state of the stream.
+ * @param record Record to encode, absent and NAN channels are left out.
+ * @param output At least CODEC_MAX_RECORD bytes.
+ * @return Encoded length [bytes].
+ */
+FASTRUN size_t codec_encode(sample_codec_t *codec, const sample_record_t *record, uint8_t *output)
+{
+    uint8_t present = 0;
+    uint8_t key = 0;
+    int32_t q[CODEC_CHANNELS];
+
+    for (int c = 0; c < CODEC_CHANNELS; c++) {
+        bool valid = ((record->mask >> c) & 1) && !isnan(record->values[c]);
+        q[c] = valid ? quantise(c, record->values[c]) : 0;
+        bool absolute = !((codec->synced >> c) & 1) || codec->since_key[c] >= CODEC_KEYFRAME - 1;
+        present |= valid << c;
+        key |= (valid && absolute) << c;
+    }
+
+    // a key byte carries the absolute time, also needed while the time has no reference
+    bool keyed = key || !(codec->synced & CODEC_SYNC_TIME);
+    size_t n = 0;
+    output[n++] = present | (keyed ? 0x80 : 0);
+    if (keyed) {
+        output[n++] = key;
+        n += put_varint(output + n, record->t_us);
+    } else {
+        n += put_varint(output + n, record->t_us - codec->t_us);
+    }
+    codec->t_us = record->t_us;
+    codec->synced |= CODEC_SYNC_TIME;
+
+    for (int c = 0; c < CODEC_CHANNELS; c++) {
+        if (!((present >> c) & 1)) continue;
+        if ((key >> c) & 1) {
+            n += put_varint(output + n, zigzag(q[c]));
+            codec->since_key[c] = 0;
+            codec->synced |= 1 << c;
+        } else {
+            n += put_varint(output + n, zigzag(q[c] - codec->last[c]));
+            codec->since_key[c]++;
+        }
+        codec->last[c] = q[c];
+    }
+    return n;
+}
+
+/**
+ * @brief Decodes one record of the stream.
+ *
+ * Channels without a reference value (deltas before their first absolute value) are skipped,
+ * as is the whole record while the time has no reference.
+ *
+ * @param codec  Decoder state of the stream.
+ * @param input  Encoded record.
+ * @param length Bytes available at input.
+ * @param record Decoded record: mask of the decoded channels, NAN for the others.
+ * @return Bytes consumed, 0 if the record is truncated or malformed.
+ */
+size_t codec_decode(sample_codec_t *codec, const uint8_t *input, size_t length, sample_record_t *record)
+{
+    if (length < 1) return 0;
+    uint8_t present = input[0] & 0x7F;
+    bool keyed = input[0] & 0x80;
+    size_t n = 1;
+    uint8_t key = 0;
+    if (keyed) {
+        if (length < 2) return 0;
+        key = input[n++] & present;
+    }
+
+    uint32_t time;
+    size_t used = get_varint(input + n, length - n, &time);
+    if (!used) return 0;
+    n += used;
+    bool time_valid = keyed || (codec->synced & CODEC_SYNC_TIME);
+    if (keyed) {
+        codec->t_us = time;
+        codec->synced |= CODEC_SYNC_TIME;
+    } else {
+        codec->t_us += time;
+    }
+
+    record->t_us = codec->t_us;
+    record->mask = 0;
+    for (int c = 0; c < CODEC_CHANNELS; c++) {
+        record->values[c] = NAN;
+        if (!((present >> c) & 1)) continue;
+        uint32_t value;
+        used = get_varint(input + n, length - n, &value);
+        if (!used) return 0;
+        n += used;
+
+        if ((key >> c) & 1) {
+            codec->last[c] = unzigzag(value);
+            codec->synced |= 1 << c;
+        } else if ((codec->synced >> c) & 1) {
+            codec->last[c] += unzigzag(value);
+        } else {
+            continue;
+        }
+        if (time_valid) {
+            record->values[c] = codec->last[c] * codec_lsb[c];
+            record->mask |= 1 << c;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,57 @@
+#ifndef SAMPLE_CODEC_H
+#define SAMPLE_CODEC_H
+/*
+ * File: SampleCodec.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Streaming codec of sample records (a time stamp and any subset of the sensor channels) for
+ *  the telemetry stream and logs. Each value is quantised to a fixed-point step per channel
+ *  (CODEC_PRESS_LSB, CODEC_TEMP_LSB) and coded as the zigzag varint of its difference to the
+ *  previous value of the same channel, the time as the varint of its difference to the
+ *  previous record. A slow-moving pressure or temperature takes 1-2 bytes instead of a float.
+ *
+ *  Record layout:
+ *    header (1)  bits 0-6: channels present, bit 7: key byte follows
+ *    key (1)     channels coded as absolute values, only if header bit 7
+ *    time        varint: absolute t_us if the record has a key byte, else delta to the previous
+ *    values      one zigzag varint per present channel, in channel order: absolute or delta
+ *
+ *  A channel is coded absolute on its first record, once every CODEC_KEYFRAME records of that
+ *  channel and after codec_reset(), so a decoder that lost records (or joined late) resyncs by
+ *  itself: deltas of the channels it has no reference for are skipped.
+ *
+ *  Encoding runs in bounded time (CODEC_CHANNELS values, at most 5 bytes per varint). The
+ *  channels follow telemetry_channel_t. The functions are shared with the host tools.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "constant.h"
+
+#define CODEC_CHANNELS      7
+#define CODEC_MAX_RECORD    (2 + 5 * (CODEC_CHANNELS + 1))  // header, key, time and values
+#define CODEC_SYNC_TIME     0x80    // sample_codec_t::synced bit of the time reference
+
+typedef struct sample_record_t
+{
+    uint32_t t_us;                          // micros() of the samples
+    uint8_t mask;                           // bit c set: values[c] present
+    float values[CODEC_CHANNELS];           // NAN values are not coded
+}sample_record_t;
+
+// State of one direction of a stream (encoder or decoder), zero-initialised = reset
+typedef struct sample_codec_t
+{
+    uint32_t t_us;                          // time of the previous record [us]
+    int32_t last[CODEC_CHANNELS];           // previous quantised value of each channel
+    uint8_t since_key[CODEC_CHANNELS];      // records of each channel since its absolute value
+    uint8_t synced;                         // channels with a reference value, CODEC_SYNC_TIME
+}sample_codec_t;
+
+void codec_reset(sample_codec_t *codec);
+size_t codec_encode(sample_codec_t *codec, const sample_record_t *record, uint8_t *output);
+size_t codec_decode(sample_codec_t *codec, const uint8_t *input, size_t length, sample_record_t *record);
+
+#endif // SAMPLE_CODEC_H
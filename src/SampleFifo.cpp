@@ -0,0 +1,137 @@
+/*
+ * File: SampleFifo.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the per-channel sample FIFO declared in SampleFifo.h.
+ */
+
+#include <string.h>
+#include "SampleFifo.h"
+
+#define SAMPLE_FIFO_KEPT    (SAMPLE_FIFO_DEPTH - 1)     // the slot at head may be mid-write
+
+static inline void put_u32(uint8_t *output, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) output[i] = (uint8_t)(value >> (8 * i));
+}
+
+static inline uint32_t get_u32(const uint8_t *input)
+{
+    return input[0] | (uint32_t)input[1] << 8 | (uint32_t)input[2] << 16 | (uint32_t)input[3] << 24;
+}
+
+/**
+ * @brief Empties every channel and restarts the sequence numbers at 0.
+ */
+void fifo_reset(sample_fifo_t *fifo)
+{
+    for (int c = 0; c < CODEC_CHANNELS; c++) fifo->head[c] = 0;
+}
+
+/**
+ * @brief Appends the present channels of a record, overwriting the oldest samples of a full
+ * channel. Main loop only.
+ */
+FASTRUN void fifo_push(sample_fifo_t *fifo, const sample_record_t *record)
+{
+    for (int c = 0; c < CODEC_CHANNELS; c++) {
+        if (!((record->mask >> c) & 1)) continue;
+        uint32_t head = fifo->head[c];
+        sample_entry_t &entry = fifo->entries[c][head & (SAMPLE_FIFO_DEPTH - 1)];
+        entry.t_us = record->t_us;
+        entry.value = record->values[c];
+        // the entry must be in memory before the receive handler can see it
+        __asm__ volatile("" ::: "memory");
+        fifo->head[c] = head + 1;
+    }
+}
+
+/**
+ * @brief Builds the response block of a PRB_NET_SAMPLES request.
+ *
+ * A sequence number in the future (the master is ahead after a PRB reset) is handled as an
+ * overflow: the block starts at the oldest sample kept.
+ *
+ * @param fifo    FIFO to read, not modified (safe from the Wire1 receive handler).
+ * @param channel Channel to drain (telemetry_channel_t).
+ * @param since   Sequence number of the first sample wanted, only the low 24 bits are used.
+ * @param block   SAMPLE_FIFO_BLOCK bytes.
+ * @return Bytes used in block (the rest is left untouched).
+ */
+FASTRUN size_t fifo_drain(const sample_fifo_t *fifo, uint8_t channel, uint32_t since, uint8_t *block)
+{
+    block[0] = channel;
+    block[1] = 0;
+    block[2] = 0;
+    if (channel >= CODEC_CHANNELS) {
+        put_u32(block + 3, 0);
+        return SAMPLE_FIFO_HEADER;
+    }
+
+    uint32_t head = fifo->head[channel];
+    uint32_t kept = head < SAMPLE_FIFO_KEPT ? head : SAMPLE_FIFO_KEPT;
+    uint32_t behind = (head - since) & SAMPLE_FIFO_SEQ_MASK;
+    if (behind > kept) {
+        block[1] |= SAMPLE_FIFO_OVERFLOW;
+        behind = kept;
+    }
+    uint32_t seq = head - behind;
+    put_u32(block + 3, seq);
+
+    // each block is coded from a fresh state, a record is kept only if it fits whole
+    sample_codec_t codec = {};
+    sample_record_t record;
+    record.mask = 1 << channel;
+    uint8_t encoded[CODEC_MAX_RECORD];
+    size_t n = SAMPLE_FIFO_HEADER;
+    uint8_t count = 0;
+    while (seq != head && count < SAMPLE_BLOCK_MAX) {
+        const sample_entry_t &entry = fifo->entries[channel][seq & (SAMPLE_FIFO_DEPTH - 1)];
+        record.t_us = entry.t_us;
+        record.values[channel] = entry.value;
+        sample_codec_t next = codec;
+        size_t length = codec_encode(&next, &record, encoded);
+        if (n + length > SAMPLE_FIFO_BLOCK) break;
+        memcpy(block + n, encoded, length);
+        n += length;
+        codec = next;
+        count++;
+        seq++;
+    }
+    block[2] = count;
+    if (seq != head) block[1] |= SAMPLE_FIFO_MORE;
+    return n;
+}
+
+/**
+ * @brief Decodes a PRB_NET_SAMPLES response (master side).
+ *
+ * @param block   Response bytes.
+ * @param length  Bytes available at block.
+ * @param decoded Samples of the block, a NAN value for a sample that had no valid reading.
+ * @return false if the block is truncated or malformed.
+ */
+bool fifo_block_decode(const uint8_t *block, size_t length, sample_block_t *decoded)
+{
+    if (length < SAMPLE_FIFO_HEADER) return false;
+    decoded->channel = block[0];
+    decoded->flags = block[1];
+    decoded->count = block[2];
+    decoded->first_seq = get_u32(block + 3);
+    if (decoded->count > SAMPLE_BLOCK_MAX) return false;
+    if (decoded->count && decoded->channel >= CODEC_CHANNELS) return false;
+
+    sample_codec_t codec = {};
+    sample_record_t record;
+    size_t n = SAMPLE_FIFO_HEADER;
+    for (int i = 0; i < decoded->count; i++) {
+        size_t used = codec_decode(&codec, block + n, length - n, &record);
+        if (!used || (record.mask & ~(1 << decoded->channel))) return false;
+        n += used;
+        decoded->t_us[i] = record.t_us;
+        decoded->values[i] = record.values[decoded->channel];
+    }
+    return true;
+}
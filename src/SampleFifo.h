@@ -0,0 +1,72 @@
+#ifndef SAMPLE_FIFO_H
+#define SAMPLE_FIFO_H
+/*
+ * File: SampleFifo.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Per-channel FIFO of the time-stamped new samples, drained by the master with the
+ *  PRB_NET_SAMPLES command, so it gets every sample acquired between two polls instead of the
+ *  latest value only.
+ *
+ *  Each channel keeps its last SAMPLE_FIFO_DEPTH - 1 samples, numbered by a sequence counter
+ *  (one per channel, so the burn rate of the CCC does not evict the slow channels). The master
+ *  asks for "channel c since sequence N" and gets one SAMPLE_FIFO_BLOCK byte block:
+ *
+ *    channel (1) | flags (1) | count (1) | first sequence (4, LE) | count SampleCodec records
+ *
+ *  - flags: SAMPLE_FIFO_OVERFLOW if samples after N were overwritten (the block starts at the
+ *    oldest one kept), SAMPLE_FIFO_MORE if samples remain after the block
+ *  - the records are coded with a fresh codec state per block (first one absolute), so each
+ *    block decodes on its own; the next request asks for first sequence + count
+ *
+ *  The FIFO is written by the main loop and read by the Wire1 receive handler, which
+ *  interrupts it: the PRB_NET_SAMPLES write stages its block there (net_stage()) and the
+ *  request handler only copies the staged bytes. A sample is published by the head increment
+ *  after it is fully written, and the slot of the sample being written is never read. The
+ *  functions are shared with the host tools.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "constant.h"
+#include "SampleCodec.h"
+
+#define SAMPLE_FIFO_OVERFLOW    0x01
+#define SAMPLE_FIFO_MORE        0x02
+#define SAMPLE_FIFO_HEADER      7
+#define SAMPLE_FIFO_SEQ_MASK    0xFFFFFF    // sequence bits of a request
+#define SAMPLE_BLOCK_MAX        ((SAMPLE_FIFO_BLOCK - SAMPLE_FIFO_HEADER) / 3)  // records are >= 3 bytes
+
+static_assert((SAMPLE_FIFO_DEPTH & (SAMPLE_FIFO_DEPTH - 1)) == 0, "SAMPLE_FIFO_DEPTH must be a power of 2");
+
+typedef struct sample_entry_t
+{
+    uint32_t t_us;                  // micros() of the sample
+    float value;
+}sample_entry_t;
+
+typedef struct sample_fifo_t
+{
+    sample_entry_t entries[CODEC_CHANNELS][SAMPLE_FIFO_DEPTH];
+    volatile uint32_t head[CODEC_CHANNELS]; // sequence number of the next sample of each channel
+}sample_fifo_t;
+
+// one decoded block (master side)
+typedef struct sample_block_t
+{
+    uint8_t channel;
+    uint8_t flags;                  // SAMPLE_FIFO_OVERFLOW, SAMPLE_FIFO_MORE
+    uint8_t count;
+    uint32_t first_seq;             // sequence number of the first sample
+    uint32_t t_us[SAMPLE_BLOCK_MAX];
+    float values[SAMPLE_BLOCK_MAX];
+}sample_block_t;
+
+void fifo_reset(sample_fifo_t *fifo);
+void fifo_push(sample_fifo_t *fifo, const sample_record_t *record);
+size_t fifo_drain(const sample_fifo_t *fifo, uint8_t channel, uint32_t since, uint8_t *block);
+bool fifo_block_decode(const uint8_t *block, size_t length, sample_block_t *decoded);
+
+#endif // SAMPLE_FIFO_H
@@ -0,0 +1,68 @@
+#ifndef SIGNAL_MATH_H
+#define SIGNAL_MATH_H
+/*
+ * File: SignalMath.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Arithmetic of the sensor conversions and of the BURN stage, separated from the I/O so the
+ *  host benchmarks (host/benchmarks) time exactly what PRBComputer runs:
+ *    - Sensata PTE7300 DSP_S / DSP_T counts to bar / °C
+ *    - PT1000 divider and Kulite ADC codes (12-bit, 3.3 V) to °C / bar
+ *    - 5-entry moving average of the CCC pressure (ramp-up check without the estimator)
+ *    - chamber pressure integral step and engine total impulse
+ */
+
+#include <stdint.h>
+#include "constant.h"
+
+inline float sensata_pressure_bar(int dsp_s)
+{
+    return ((dsp_s - (-16000.0)) * (100.0) / (16000.0 - (-16000.0)));
+}
+
+inline float sensata_temperature_c(int dsp_t)
+{
+    return dsp_t * 82.5 / 16000 + 42.5;
+}
+
+inline float pt1000_temperature_c(int adc)
+{
+    float voltage = (adc * 3.3) / 4095.0;                           // 12-bit ADC, 3V3 reference
+    float resistance_pt1000 = (voltage * 1100.0) / (3.3 - voltage); // resistor divider
+    return (resistance_pt1000 - 1000) / 3.85;
+}
+
+inline float kulite_pressure_bar(int adc)
+{
+    int max_kulite_value = 100;
+    float voltage = (adc / 4095.0) * 3.3;                           // 12-bit ADC, 3V3 reference
+    float v_sensor = voltage / 33;
+    return (v_sensor * 1000.0) * (max_kulite_value / 100.0);
+}
+
+// stores press in the circular buffer and returns the mean of its 5 entries [bar]
+inline float mean5_push(float buffer[5], int *index, float press)
+{
+    buffer[*index] = press;
+    *index = (*index + 1) % 5;
+    float sum = 0.0;
+    for (int i = 0; i < 5; i++) {
+        sum += buffer[i];
+    }
+    return sum / 5.0;
+}
+
+// chamber pressure integral after dt_ms more at chamber_pressure_Pa [Pa.s]
+inline float chamber_integral_step(float integral, float chamber_pressure_Pa, uint32_t dt_ms)
+{
+    return integral + chamber_pressure_Pa * dt_ms / 1000.0;
+}
+
+inline float engine_impulse(float integral)
+{
+    return I_SP * G * (AREA_THROAT/C_STAR) * integral;
+}
+
+#endif // SIGNAL_MATH_H
@@ -0,0 +1,149 @@
+/*
+ * File: Telemetry.cpp
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Implementation of the binary telemetry stream declared in Telemetry.h.
+ */
+
+#include "Telemetry.h"
+
+// ========= framing =========
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), nibble table to keep flash small.
+ */
+uint16_t crc16_ccitt(const uint8_t *data, size_t length)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+/**
+ * @brief Consistent Overhead Byte Stuffing: removes every 0x00 from the frame so 0x00 can
+ * delimit frames. The output holds at most length + length / 254 + 1 bytes, no delimiter.
+ */
+size_t cobs_encode(const uint8_t *input, size_t length, uint8_t *output)
+{
+    size_t code_index = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++) {
+        if (input[i] != 0) {
+            output[out++] = input[i];
+            code++;
+        }
+        if (input[i] == 0 || code == 0xFF) {
+            output[code_index] = code;
+            code = 1;
+            code_index = out++;
+        }
+    }
+    output[code_index] = code;
+    return out;
+}
+
+/**
+ * @brief Inverse of cobs_encode() on one frame (delimiter excluded).
+ *
+ * @return The decoded length, or 0 if the frame is malformed.
+ */
+size_t cobs_decode(const uint8_t *input, size_t length, uint8_t *output)
+{
+    size_t out = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        uint8_t code = input[i++];
+        if (code == 0 || i + code - 1 > length) return 0;
+        for (uint8_t j = 1; j < code; j++) output[out++] = input[i++];
+        if (code != 0xFF && i < length) output[out++] = 0;
+    }
+    return out;
+}
+
+// ========= stream =========
+static uint8_t tlm_seq = 0;
+static uint32_t tlm_sent = 0;
+static uint32_t tlm_dropped = 0;
+static sample_codec_t tlm_codec = {};   // encoder of the TLM_SAMPLES records
+static clock_sync_t tlm_clock = {};     // master clock estimate of the frame times, unsynced = micros()
+
+/**
+ * @brief Frames and sends one packet, or drops it if the USB buffer is full.
+ *
+ * @return false if the frame was dropped.
+ */
+bool telemetry_send(uint8_t type, const uint8_t *body, size_t body_length)
+{
+    uint8_t payload[TLM_MAX_PAYLOAD];
+    uint8_t frame[TLM_MAX_FRAME];
+
+    uint32_t t_us = clock_sync_time(&tlm_clock, micros());
+    payload[0] = type;
+    payload[1] = tlm_seq++;
+    memcpy(payload + 2, &t_us, 4);
+    memcpy(payload + TLM_HEADER_SIZE, body, body_length);
+    size_t length = TLM_HEADER_SIZE + body_length;
+    uint16_t crc = crc16_ccitt(payload, length);
+    payload[length++] = crc & 0xFF;
+    payload[length++] = crc >> 8;
+
+    size_t frame_length = cobs_encode(payload, length, frame);
+    frame[frame_length++] = 0x00;
+
+    if (!Serial || Serial.availableForWrite() < (int)frame_length) {
+        tlm_dropped++;
+        return false;
+    }
+    Serial.write(frame, frame_length);
+    tlm_sent++;
+    return true;
+}
+
+/**
+ * @brief Sends the new samples of one control loop as a SampleCodec record.
+ */
+void telemetry_send_samples(const sample_record_t *record)
+{
+    uint8_t body[CODEC_MAX_RECORD];
+    size_t length = codec_encode(&tlm_codec, record, body);
+    // the decoder never sees a dropped record: restart the deltas from absolute values
+    if (!telemetry_send(TLM_SAMPLES, body, length)) codec_reset(&tlm_codec);
+}
+
+void telemetry_send_stats(uint32_t control_cycles_max, uint32_t sweep_cycles_max, int32_t time_ready)
+{
+    uint8_t body[20];
+    memcpy(body, &tlm_sent, 4);
+    memcpy(body + 4, &tlm_dropped, 4);
+    memcpy(body + 8, &control_cycles_max, 4);
+    memcpy(body + 12, &sweep_cycles_max, 4);
+    memcpy(body + 16, &time_ready, 4);
+    telemetry_send(TLM_STATS, body, sizeof(body));
+}
+
+void telemetry_set_clock(const clock_sync_t *clock) { tlm_clock = *clock; }
+
+void telemetry_send_clock(uint32_t local_us)
+{
+    uint8_t body[12];
+    float error = clock_sync_error(&tlm_clock, local_us);
+    float drift_ppm = tlm_clock.drift * 1e6f;
+    memcpy(body, &error, 4);
+    memcpy(body + 4, &drift_ppm, 4);
+    memcpy(body + 8, &tlm_clock.exchanges, 2);
+    memcpy(body + 10, &tlm_clock.rejected, 2);
+    telemetry_send(TLM_CLOCK, body, sizeof(body));
+}
+
+uint32_t telemetry_dropped() { return tlm_dropped; }
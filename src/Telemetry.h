@@ -0,0 +1,162 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+/*
+ * File: Telemetry.h
+ * Author: C - AV Team
+ * Last update: 18/10/2026
+ *
+ * Description:
+ *  Optional high-rate binary telemetry stream over the USB Serial port (telemetry_stream in
+ *  the build profile).
+ *  The new samples of each control loop (stale PTE7300 results are not re-sent, see
+ *  sensor_acquisition_t), every FSM transition and valve edge are sent as one frame:
+ *
+ *    COBS( type | seq | t_us (4) | body | crc16 (2) ) 0x00
+ *
+ *  - type: telemetry_type_t, seq: per-frame counter (8 bits) for loss detection on the host
+ *  - t_us: time of the event on the master clock once synchronised (ClockSync), else micros(),
+ *    little endian
+ *  - crc16: CRC-16/CCITT-FALSE over type..body
+ *
+ *  Frames are never queued: if the USB buffer cannot take a whole frame it is dropped and
+ *  counted, so the control loop never blocks on a slow or absent host. The drop counter and
+ *  the worst loop times are reported in a TLM_STATS frame once per second, followed by the
+ *  achieved sample rate of every channel (sensor schedule, see PRBComputer) in a TLM_RATES frame,
+ *  the state of the clock sync in a TLM_CLOCK frame and, with idle_sleep in the build profile,
+ *  the awake duty cycle and Sensata wake-up latency in a TLM_POWER frame.
+ *
+ *  Samples travel as SampleCodec records (fixed-point deltas, a few bytes per value instead of a
+ *  float). A frame that cannot be sent resets the encoder, so the next record is absolute; the
+ *  decoder also resets on a sequence gap and resyncs on the periodic absolute values.
+ *
+ *  Frames are only sent from the control loop: the USB Serial write is not reentrant, so the
+ *  events of the Wire1 handlers (FSM transitions, valve edges) are picked up by update().
+ *
+ *  When the profile disables the stream, all the telemetry_* calls compile to nothing.
+ *  The framing helpers are shared with the host decoder (host/telemetry_decoder).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "constant.h"
+#include "SampleCodec.h"
+#include "ClockSync.h"
+
+#define TLM_MAX_PAYLOAD     64
+#define TLM_MAX_FRAME       (TLM_MAX_PAYLOAD + TLM_MAX_PAYLOAD / 254 + 2)
+#define TLM_HEADER_SIZE     6       // type, seq, t_us
+#define TLM_CRC_SIZE        2
+
+enum telemetry_type_t
+{
+    TLM_SAMPLE = 1,                 // body: channel (1), value float (4) (previous firmware)
+    TLM_STATE  = 2,                 // body: PRB_FSM, ignition, passivation, abort stage (1 each)
+    TLM_VALVE  = 3,                 // body: pin (1), level (1)
+    TLM_STATS  = 4,                 // body: frames sent (4), frames dropped (4),
+                                    //       worst FSM tick (4), worst sensor sweep (4) [cycles],
+                                    //       every channel sampled (4) [ms after reset, -1 not yet]
+    TLM_RATES  = 5,                 // body: achieved rate of every channel (2 each) [0.1 Hz]
+    TLM_SAMPLES = 6,                // body: one SampleCodec record
+    TLM_CLOCK  = 7,                 // body: sync error [us] (float, NAN unsynced), drift [ppm] (float),
+                                    //       accepted (2), rejected (2) exchanges
+    TLM_POWER  = 8,                 // body: awake duty cycle (2) [0.1 %], Sensatas asleep (1),
+                                    //       last wake-up latency (4) [us, -1 none yet]
+};
+
+// sample channels, same order as the prb_log_channel_t columns of the host logs
+enum telemetry_channel_t
+{
+    TLM_CCC_PRESS,
+    TLM_EIN_PRESS,
+    TLM_CCC_TEMP,
+    TLM_EIN_TEMP_SENSATA,
+    TLM_OIN_TEMP,
+    TLM_EIN_TEMP_PT1000,
+    TLM_OIN_PRESS,
+    TLM_CHANNELS
+};
+
+static_assert((int)TLM_CHANNELS == CODEC_CHANNELS, "sample records carry every telemetry channel");
+static_assert(TLM_HEADER_SIZE + CODEC_MAX_RECORD + TLM_CRC_SIZE <= TLM_MAX_PAYLOAD, "a sample record must fit in a frame");
+
+// ========= framing (firmware and host) =========
+uint16_t crc16_ccitt(const uint8_t *data, size_t length);
+size_t cobs_encode(const uint8_t *input, size_t length, uint8_t *output);
+size_t cobs_decode(const uint8_t *input, size_t length, uint8_t *output);
+
+// ========= stream =========
+bool telemetry_send(uint8_t type, const uint8_t *body, size_t body_length);
+void telemetry_send_samples(const sample_record_t *record);
+void telemetry_send_stats(uint32_t control_cycles_max, uint32_t sweep_cycles_max, int32_t time_ready);
+void telemetry_set_clock(const clock_sync_t *clock);
+void telemetry_send_clock(uint32_t local_us);
+uint32_t telemetry_dropped();
+
+// Only the functions above are out of line, and only referenced when the profile enables
+// the stream, so a build without it carries none of the stream code.
+inline void telemetry_begin()
+{
+    // delimiter to resynchronise the decoder after the start-up text
+    if constexpr (PROFILE.telemetry_stream) {
+        if (Serial) Serial.write((uint8_t)0x00);
+    }
+}
+
+inline void telemetry_samples(const sample_record_t *record)
+{
+    if constexpr (PROFILE.telemetry_stream) telemetry_send_samples(record);
+}
+
+inline void telemetry_state(uint8_t state, uint8_t ignition, uint8_t passivation, uint8_t abort)
+{
+    if constexpr (PROFILE.telemetry_stream) {
+        uint8_t body[4] = {state, ignition, passivation, abort};
+        telemetry_send(TLM_STATE, body, sizeof(body));
+    }
+}
+
+inline void telemetry_valve(uint8_t pin, bool level)
+{
+    if constexpr (PROFILE.telemetry_stream) {
+        uint8_t body[2] = {pin, (uint8_t)(level ? HIGH : LOW)};
+        telemetry_send(TLM_VALVE, body, sizeof(body));
+    }
+}
+
+inline void telemetry_stats(uint32_t control_cycles_max, uint32_t sweep_cycles_max, int32_t time_ready)
+{
+    if constexpr (PROFILE.telemetry_stream) telemetry_send_stats(control_cycles_max, sweep_cycles_max, time_ready);
+}
+
+// frame times follow the clock estimate from here on (a copy is kept)
+inline void telemetry_clock(const clock_sync_t *clock)
+{
+    if constexpr (PROFILE.telemetry_stream) telemetry_set_clock(clock);
+}
+
+inline void telemetry_clock_stats(uint32_t local_us)
+{
+    if constexpr (PROFILE.telemetry_stream) telemetry_send_clock(local_us);
+}
+
+inline void telemetry_rates(const uint16_t *rates)
+{
+    if constexpr (PROFILE.telemetry_stream) {
+        uint8_t body[2 * TLM_CHANNELS];
+        memcpy(body, rates, sizeof(body));
+        telemetry_send(TLM_RATES, body, sizeof(body));
+    }
+}
+
+inline void telemetry_power(uint16_t awake_duty, bool sensata_asleep, int32_t wake_latency_us)
+{
+    if constexpr (PROFILE.telemetry_stream) {
+        uint8_t body[7];
+        memcpy(body, &awake_duty, 2);
+        body[2] = sensata_asleep;
+        memcpy(body + 3, &wake_latency_us, 4);
+        telemetry_send(TLM_POWER, body, sizeof(body));
+    }
+}
+
+#endif // TELEMETRY_H
@@ -16,12 +16,46 @@
 #include <Arduino.h>
 #include "vector"
 
-// ================= ifdef defines =================
-#define DEBUG
-#define TEST_WITHOUT_PRESSURE
-#define INTEGRATE_CHAMBER_PRESSURE
-// #define KULITE
-// #define VSTF_AND_COLD_FLOW
+// ================= build profiles =================
+// Every feature switch of the firmware comes from the build profile, selected at compile time
+// with -DPRB_PROFILE=<profile> (one platformio.ini environment per profile). Disabled features
+// are removed by `if constexpr`, so e.g. a hot-fire build carries no debug Serial dump.
+
+// Sensata PTE7300 acquisition (PRBComputer::sensata_data_ready)
+enum sensor_acquisition_t
+{
+    ACQ_POLL,                           // read DSP_S / DSP_T on every sweep
+    ACQ_DATA_READY,                     // continuous mode, read only when STATUS flags a new result
+    ACQ_SINGLE_SHOT,                    // idle mode, one conversion triggered with START per sweep
+};
+
+typedef struct prb_profile_t
+{
+    const char *name;
+    bool debug;                         // Serial debug dump in the control loop
+    bool test_without_pressure;         // ramp-up pressure check disabled
+    bool integrate_chamber_pressure;    // impulse-based cutoff (else fixed BURN_DURATION)
+    bool kulite;                        // OIN pressure on the Kulite analog input
+    bool vstf_and_cold_flow;            // no ethanol passivation (VSTF and cold flow tests)
+    bool telemetry_stream;              // binary telemetry on USB Serial (see Telemetry.h)
+    bool pressure_estimator;            // ramp-up check and impulse on the estimated CCC pressure
+    sensor_acquisition_t acquisition;   // PTE7300 read strategy, fresh / stale samples
+    bool idle_sleep;                    // IDLE: core in WFI between tasks, Sensatas in sleep mode
+}prb_profile_t;
+
+//                                        name         debug  no_press integ  kulite cold   tlm    estim  acquisition     idle
+constexpr prb_profile_t PROFILE_HOT_FIRE  = {"hot_fire",  false, false,   true,  false, false, true,  true,  ACQ_POLL,       true};
+constexpr prb_profile_t PROFILE_COLD_FLOW = {"cold_flow", false, true,    false, false, true,  true,  false, ACQ_POLL,       true};
+constexpr prb_profile_t PROFILE_BENCH     = {"bench",     true,  true,    true,  false, false, false, true,  ACQ_DATA_READY, false};
+constexpr prb_profile_t PROFILE_SIM       = {"sim",       false, false,   true,  false, false, true,  true,  ACQ_DATA_READY, false};
+
+#ifndef PRB_PROFILE
+#define PRB_PROFILE PROFILE_BENCH
+#endif
+
+constexpr prb_profile_t PROFILE = PRB_PROFILE;
+
+static_assert(!(PROFILE.debug && PROFILE.telemetry_stream), "the debug dump and the telemetry stream share USB Serial");
 
 // ================ pin configuration =================
 #define ME_b        37
@@ -42,12 +76,16 @@
 #define SENS_ADDR   0x6C        //or 0x6C
 #define EIN_CH      0x01        // channel 1
 #define CCC_CH      0x02        // channel 2
+#define SENSOR_WIRE Wire2       // Sensata sensors behind the mux
+#define CCC_WIRE    Wire        // free controller (SDA 18 / SCL 19) for a CCC Sensata off the mux
+constexpr bool CCC_OWN_BUS = false;   // CCC Sensata on CCC_WIRE, else behind the mux on SENSOR_WIRE (current harness)
+#define CCC_SENSOR_WIRE (CCC_OWN_BUS ? CCC_WIRE : SENSOR_WIRE) // bus of the CCC Sensata
 
-#ifdef KULITE
-#define P_OIN       PIN_A6
-#else
-#define P_OIN       0x04        // channel 3
-#endif
+#define P_OIN       (PROFILE.kulite ? PIN_A6 : 0x04)    // Kulite analog input, or channel 3
+
+// PRB commands on Wire1 not (yet) in 2024_C_AV_INTRANET
+#define PRB_NET_SAMPLES     0x40    // data: channel, sequence (3, LE); response: one SampleFifo block
+// AV_NET_PRB_TIMESTAMP data: master time [us] (4, LE), see ClockSync.h
 
 // ================= Ignition sequence timing =================
 #define PRECHILL_DURATION           200             // 200ms -> prechill duration
@@ -67,11 +105,33 @@
 #define ABORT_PASSIVATION_DELAY 5000           // 5s -> max passivation
 
 // ================= Pressure thresholds =================
-#ifdef TEST_WITHOUT_PRESSURE
-#define RAMP_UP_CHECK_PRESSURE -1
-#else
-#define RAMP_UP_CHECK_PRESSURE 27.5          //for 5.38 kN of thrust
-#endif
+#define RAMP_UP_CHECK_PRESSURE (PROFILE.test_without_pressure ? -1 : 27.5)  //for 5.38 kN of thrust
+
+// ================= Chamber pressure estimator =================
+#define ESTIMATOR_ALPHA         0.7f        // pressure gain
+#define ESTIMATOR_BETA          0.377f      // rate gain, alpha^2 / (2 - alpha) (Benedict-Bordner)
+#define ESTIMATOR_STATS_GAIN    0.1f        // smoothing of the noise and lag statistics
+#define ESTIMATOR_MAX_HORIZON_MS 250        // max extrapolation after the last sample
+#define ESTIMATOR_MIN_RATE      1.0f        //[bar/s] below this the lag is not meaningful
+
+// ================= Sample codec =================
+#define CODEC_PRESS_LSB         0.001f      //[bar] pressure quantisation step
+#define CODEC_TEMP_LSB          0.01f       //[°C] temperature quantisation step
+#define CODEC_KEYFRAME          32          // records of a channel between two absolute values (resync)
+
+// ================= Sample FIFO =================
+#define SAMPLE_FIFO_DEPTH       512         // samples kept per channel (power of 2), ~2 s of burn CCC
+#define SAMPLE_FIFO_BLOCK       32          // bytes of a PRB_NET_SAMPLES response (Wire1 buffer)
+
+// ================= Clock sync =================
+#define CLOCK_SYNC_LATENCY_US   135         // master time stamp to receiveEvent(): 6 bytes @ 400 kHz
+#define CLOCK_SYNC_ALPHA        0.25f       // offset gain
+#define CLOCK_SYNC_BETA         0.0357f     // drift gain, alpha^2 / (2 - alpha) (Benedict-Bordner)
+#define CLOCK_SYNC_STATS_GAIN   0.1f        // smoothing of the sync error
+#define CLOCK_SYNC_OUTLIER_US   1000        // residual above which an exchange is rejected
+#define CLOCK_SYNC_MAX_REJECTS  4           // rejected exchanges in a row before restarting
+#define CLOCK_SYNC_MIN_DT_US    10000       // exchanges closer than this do not correct the drift
+#define CLOCK_SYNC_WANDER       2e-6f       //[us/us] drift error added to the sync error while coasting
 
 // ================= Engine parameters =================
 #define G                       9.80665                             //[m/s^2]
@@ -86,9 +146,36 @@
 // #define CUTOFF_IMPULSE          374.292                             //[N.s] cutoff impulse
 #define I_TARGET                (BURN_IMPULSE)   //[N.s] target impulse
 
+// ================= Sensor health =================
+#define SENSOR_FAIL_READS       3           // consecutive failed reads (NAK, short frame, CRC) to flag a sensor
+#define SENSOR_STUCK_READS      20          // reads with the same raw pressure to flag it stuck...
+#define SENSOR_STUCK_MS         2000        // ...over at least this time (reads come faster than conversions in the burn)
+#define SENSOR_STALE_READS      3           // reads without a new PTE7300 conversion (data-ready acquisition)...
+#define SENSOR_STALE_MS         200         // ...over at least this time, within ESTIMATOR_MAX_HORIZON_MS
+#define SENSOR_DSP_LIMIT        17600       // |DSP_S|, |DSP_T| above the calibrated +-16000 span + 10 %
+#define SENSOR_ADC_MARGIN       16          // ADC codes this close to 0 or 4095: open / shorted input
+
+// ================= Sensor schedule =================
+// Sample period of each channel in each phase of the FSM (sensor_table in PRBComputer.cpp),
+// 0 samples on every loop. A Sensata pressure period must not exceed the temperature period of
+// the same sensor (the single-shot trigger is sent by the pressure read).
+#define SAMPLE_STARTUP_MS       50          // IDLE after reset: every channel until each got a new sample...
+#define SAMPLE_STARTUP_MAX_MS   3000        // ...or up to this time after reset (missing sensor)
+#define SAMPLE_IDLE_MS          1000        // IDLE: 1 Hz housekeeping
+#define SAMPLE_ARMED_MS         100         // CLEAR_TO_IGNITE: 10 Hz
+#define SAMPLE_SEQ_PRESS_MS     50          // ignition, passivation and abort sequences: pressures
+#define SAMPLE_SEQ_TEMP_MS      200         // ignition, passivation and abort sequences: temperatures
+#define SAMPLE_BURN_CCC_MS      0           // BURN: CCC pressure on every loop
+#define SAMPLE_BURN_PRESS_MS    50          // BURN: feed pressures
+#define SAMPLE_BURN_TEMP_MS     500         // BURN: temperatures
+
+// ================= Idle power (profile idle_sleep) =================
+// In IDLE, past the start-up schedule, the Sensatas are in sleep mode and the core waits in WFI
+// for the next task of update() or a Wire1 command. They are woken when the FSM leaves IDLE.
+#define SENSATA_WAKE_MAX_MS     (2 * SENSOR_STALE_MS)   // wake-up given up after this, a silent Sensata is flagged stale before
+
 // Status 
 #define LED_TIMEOUT 1000 // 1 second
-#define SENSORS_POLLING_RATE_MS 100 // 10Hz
 // ================= FSM structures =================
 
 enum ignitionStage